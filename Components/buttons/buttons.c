@@ -104,6 +104,22 @@ uint8_t isButtonPressed(button_e button) {
     return ((buttons[button].state == stPressed) || (buttons[button].state == stHeldDown));
 }
 
+/**
+ * @brief Check if any button is pressed or held down
+ * 
+ * @retval 0        All buttons are released
+ * @retval 1        At least one button is pressed
+ */
+uint8_t isAnyButtonPressed(void) {
+    for(uint8_t i = 0; i < (uint8_t)NB_BUTTONS; i++) {
+        if(isButtonPressed(i)) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
 /**
  * @brief Check if a button is held down
  * 
@@ -119,6 +135,22 @@ uint8_t isButtonHeldDown(button_e button) {
     return (buttons[button].state == stHeldDown);
 }
 
+/**
+ * @brief Check if a button has been held down for a minimum duration since it has been pressed
+ * 
+ * @param button        Button to check
+ * @param duration_ms   Minimum duration in milliseconds (counted from the press)
+ * @retval 0        Button is released or not held down for long enough
+ * @retval 1        Button is held down for at least the duration
+ */
+uint8_t isButtonHeldDownFor(button_e button, uint16_t duration_ms) {
+    if(button >= NB_BUTTONS) {
+        return 0;
+    }
+
+    return ((buttons[button].state == stHeldDown) && isTimeElapsed(buttonsTimers[button].holding_ms, duration_ms));
+}
+
 /**
  * @brief Check if a button has recently had a rising edge
  * @details Rising edge occurrs when a button goes from released to pressed
@@ -15,7 +15,9 @@ typedef enum {
 void    buttonsUpdate();
 uint8_t isButtonReleased(button_e button);
 uint8_t isButtonPressed(button_e button);
+uint8_t isAnyButtonPressed(void);
 uint8_t isButtonHeldDown(button_e button);
+uint8_t isButtonHeldDownFor(button_e button, uint16_t duration_ms);
 uint8_t buttonHasRisingEdge(button_e button);
 uint8_t buttonHasFallingEdge(button_e button);
 
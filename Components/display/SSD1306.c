@@ -1,24 +1,32 @@
 /**
  * @file SSD1306.c
- * @brief Implement the functioning of the SSD1306 OLED screen via SPI and DMA
+ * @brief Implement the functioning of the OLED screen via SPI and DMA
  * @author Gilles Henrard
  * @date 26/07/2024
  *
+ * @details
+ *  The screen content is made of widgets (see widgets.h) rendered in a frame buffer.
+ *  Only the rectangles modified since the latest flush are sent, each page row of a rectangle
+ *  being sent with its own window and DMA transfer (full-width rectangles being sent at once).
+ *  The panel itself (SSD1306, SSD1309 or SH1106) is driven by the backend selected by the build (see displayBackend.h).
+ *
  * @note Datasheet : https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf
  */
 #include "SSD1306.h"
 #include <assert.h>
 #include <stdint.h>
 #include "SSD1306_registers.h"
+#include "blit.h"
+#include "displayBackend.h"
+#include "displayBus.h"
 #include "errorstack.h"
 #include "icons.h"
 #include "main.h"
 #include "numbersVerdana16.h"
 #include "stm32f103xb.h"
-#include "stm32f1xx_ll_dma.h"
 #include "stm32f1xx_ll_gpio.h"
-#include "stm32f1xx_ll_spi.h"
 #include "systick.h"
+#include "widgets.h"
 
 //Definitions
 enum {
@@ -30,13 +38,24 @@ enum {
         (SSD_SCREEN_WIDTH - REFERENCETYPE_NB_BYTES - 1),  ///< Column at which the system reference type icon is
     HOLDICON_PAGE    = REFICON_PAGE,                      ///< Page at which the hold icon is
     HOLDICON_COLUMN  = (REFICON_COLUMN - REFERENCETYPE_NB_BYTES),  ///< Column at which the hold icon is
-    ANGLE_NB_CHARS   = 6U,                                         ///< Number of characters in the angle array
-    ANGLE_COLUMN     = 40U,                                        ///< Column number of the first screen line
-    ANGLE_ROLL_PAGE  = 1U,  ///< Number of the page at which display the roll axis angle
-    ANGLE_PITCH_PAGE = 5U,  ///< Number of the page at which display the pitch axis angle
-    NB_INIT_REGISERS = 8U   ///< Number of registers set at initialisation
+    SLOPEICON_PAGE   = REFICON_PAGE,                               ///< Page at which the slope arrow is
+    SLOPEICON_COLUMN = (HOLDICON_COLUMN - REFERENCETYPE_NB_BYTES),  ///< Column at which the slope arrow is
+    SLOPE_MIN_TILT   = 5,     ///< Minimum tilt (in tenths of degrees) under which the surface is considered level
+    SLOPE_SECTOR     = 450,   ///< Angle covered by a slope arrow (in tenths of degrees)
+    FULL_TURN        = 3600,  ///< Full turn (in tenths of degrees)
+    ANGLE_COLUMN         = 40U,       ///< Column number of the first screen line
+    ANGLE_ROLL_PAGE      = 1U,        ///< Number of the page at which display the roll axis angle
+    ANGLE_PITCH_PAGE     = 5U,        ///< Number of the page at which display the pitch axis angle
+    ANGLE_MIN_TENTHS     = -900,      ///< Minimum angle displayed (in tenths of degrees)
+    ANGLE_MAX_TENTHS     = 900,       ///< Maximum angle displayed (in tenths of degrees)
+    NB_REFERENTIAL_ICONS = 2U,        ///< Number of referential type icons (absolute, relative)
+    NB_HOLD_ICONS        = 2U,        ///< Number of hold icon states (erased, drawn)
 };
 
+_Static_assert(((uint32_t)SSD_SCREEN_WIDTH == (uint32_t)WIDGET_SCREEN_WIDTH)
+                   && ((uint32_t)SSD_NB_PAGES == (uint32_t)WIDGET_NB_PAGES),
+               "The widgets frame buffer must match the screen size");
+
 /**
  * @brief Enumeration of the function IDs of the SSD1306
  */
@@ -48,15 +67,23 @@ typedef enum {
     PRT_HOLDICON,     ///< SSD1306_printHoldIcon()
     SENDING_DATA,     ///< stateSendingData()
     WAITING_DMA_RDY,  ///< stateWaitingForTXdone()
+    IDLE,             ///< stateIdle()
+    SET_ORIENTATION,  ///< sendOrientation()
+    PRT_SLOPEICON,    ///< ssd1306PrintSlopeArrow()
+    SET_WINDOW,       ///< setWindow()
 } SSD1306functionCodes_e;
 
 /**
- * @brief SPI Data/command pin status enumeration
+ * @brief Enumeration of the widgets of the measurements screen
  */
 typedef enum {
-    COMMAND = 0,  ///< Command is to be sent
-    DATA,         ///< Data is to be sent
-} DCgpio_e;
+    MEASURE_ROLL = 0,     ///< Roll angle
+    MEASURE_PITCH,        ///< Pitch angle
+    MEASURE_REFERENTIAL,  ///< Referential type icon
+    MEASURE_HOLD,         ///< Hold icon
+    MEASURE_SLOPE,        ///< Slope direction arrow
+    NB_MEASURE_WIDGETS
+} measureWidget_e;
 
 /**
  * @brief Screen state machine state prototype
@@ -66,9 +93,8 @@ typedef enum {
 typedef errorCode_u (*screenState)();
 
 //communication functions with the SSD1306
-static inline void setDataCommandGPIO(DCgpio_e function);
-static errorCode_u sendCommand(SSD1306register_e regNumber, const uint8_t parameters[], uint8_t nbParameters);
-static errorCode_u drawBaseScreen();
+static void        drawBackground();
+static errorCode_u sendOrientation(displayOrientation_e newOrientation);
 
 //state machine
 static errorCode_u stateConfiguring();
@@ -76,19 +102,49 @@ static errorCode_u stateIdle();
 static errorCode_u stateSendingData();
 static errorCode_u stateWaitingForTXdone();
 
-//Constant values
-static const uint8_t SPI_TIMEOUT_MS = 10U;  ///< Maximum number of milliseconds SPI traffic should last before timeout
+//Icons selected by the value of the icon widgets (NULL entries erase the icon)
+static const uint8_t* const REFERENTIAL_ICONS[NB_REFERENTIAL_ICONS] = {absoluteReferentialIcon, relativeReferentialIcon};
+static const uint8_t* const HOLD_ICONS[NB_HOLD_ICONS]               = {(void*)0, holdIcon};
+static const uint8_t* const SLOPE_ICONS[NB_SLOPE_ARROWS]            = {
+    slopeArrowIcons[0], slopeArrowIcons[1], slopeArrowIcons[2], slopeArrowIcons[3],
+    slopeArrowIcons[4], slopeArrowIcons[5], slopeArrowIcons[6], slopeArrowIcons[7],
+};
+
+/**
+ * @brief Layout of the measurements screen
+ */
+static const widget_t MEASURE_WIDGETS[NB_MEASURE_WIDGETS] = {
+    [MEASURE_ROLL]        = {WIDGET_NUMBER, {ANGLE_ROLL_PAGE, VERDANA_NB_PAGES, ANGLE_COLUMN, WIDGET_NUMBER_WIDTH},
+                             ANGLE_MIN_TENTHS, ANGLE_MAX_TENTHS, (void*)0, 0, (void*)0},
+    [MEASURE_PITCH]       = {WIDGET_NUMBER, {ANGLE_PITCH_PAGE, VERDANA_NB_PAGES, ANGLE_COLUMN, WIDGET_NUMBER_WIDTH},
+                             ANGLE_MIN_TENTHS, ANGLE_MAX_TENTHS, (void*)0, 0, (void*)0},
+    [MEASURE_REFERENTIAL] = {WIDGET_ICON, {REFICON_PAGE, 1U, REFICON_COLUMN, REFERENCETYPE_NB_BYTES},
+                             0, 0, REFERENTIAL_ICONS, NB_REFERENTIAL_ICONS, (void*)0},
+    [MEASURE_HOLD]        = {WIDGET_ICON, {HOLDICON_PAGE, 1U, HOLDICON_COLUMN, REFERENCETYPE_NB_BYTES},
+                             0, 0, HOLD_ICONS, NB_HOLD_ICONS, (void*)0},
+    [MEASURE_SLOPE]       = {WIDGET_ICON, {SLOPEICON_PAGE, 1U, SLOPEICON_COLUMN, REFERENCETYPE_NB_BYTES},
+                             0, 0, SLOPE_ICONS, NB_SLOPE_ARROWS, (void*)0},
+};
+
+static widgetState_t        measureStates[NB_MEASURE_WIDGETS];  ///< States of the measurements screen widgets
+static const widgetScreen_t MEASURE_SCREEN = {MEASURE_WIDGETS, measureStates, NB_MEASURE_WIDGETS, baseScreen};
 
-//Variables used in interrupts  ///< Timer used to make sure SPI does not time out (in ms)
-static systick_t TXtick = 0;
+//Variables used in interrupts
+static cyclecount_t TXtick       = 0;  ///< Timer used to make sure SPI does not time out
+static uint32_t     TXtimeout_us = 0;  ///< Time after which the DMA transfer is in timeout (in us)
 
 //State variables
-static SPI_TypeDef* spiHandle         = (void*)0;          ///< SPI handle used with the SSD1306
-static DMA_TypeDef* dmaHandle         = (void*)0;          ///< DMA handle used with the SSD1306
-static uint32_t     dmaChannelUsed    = 0x00000000U;       ///< DMA channel used
-static screenState  state             = stateConfiguring;  ///< State machine current state
-static uint8_t      screenInvalidated = 0;  ///< Flag indicating the screen has been invalidated and should be updated
-static uint8_t      screenBuffer[SSD_NB_PAGES][SSD_SCREEN_WIDTH];  ///< Buffer used to send data to the screen
+static screenState          state             = stateConfiguring;  ///< State machine current state
+static uint8_t screenBuffer[SSD_NB_PAGES][SSD_SCREEN_WIDTH] __attribute__((aligned(4)));  ///< Buffer sent to the screen
+static displayOrientation_e orientation          = ORIENTATION_NORMAL;  ///< Orientation currently applied
+static displayOrientation_e requestedOrientation = ORIENTATION_NORMAL;  ///< Orientation to apply once the screen is idle
+static const widgetScreen_t* currentScreen   = &MEASURE_SCREEN;  ///< Screen currently drawn in the buffer
+static const widgetScreen_t* requestedScreen = &MEASURE_SCREEN;  ///< Screen to draw once the screen is idle
+static widgetDamage_t        damage;                             ///< Rectangles of the buffer to send to the screen
+static uint8_t               damageIndex      = 0;  ///< Index of the rectangle being sent
+static uint8_t               transferPage     = 0;  ///< Page of the rectangle row being sent
+static cyclecount_t          flushStart       = 0;  ///< CPU cycles count at which the current flush started
+static uint32_t              frameDuration_us = 0;  ///< Duration of the latest flush (all the rectangles damaged) in [us]
 
 /********************************************************************************************************************************************/
 /********************************************************************************************************************************************/
@@ -104,111 +160,58 @@ static uint8_t      screenBuffer[SSD_NB_PAGES][SSD_SCREEN_WIDTH];  ///< Buffer u
  * @retval 2	        Error while clearing the screen
  */
 errorCode_u ssd1306Initialise(SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t dmaChannel) {
-    spiHandle      = handle;
-    dmaHandle      = dma;
-    dmaChannelUsed = dmaChannel;
-
-    //make sure to disable SSD1306 SPI communication
-    LL_SPI_Disable(spiHandle);
-    LL_DMA_DisableChannel(dmaHandle, dmaChannelUsed);
-
-    //set the DMA source and destination addresses (will always use the same ones)
-    LL_DMA_ConfigAddresses(dmaHandle, dmaChannelUsed, (uint32_t)&screenBuffer, LL_SPI_DMA_GetRegAddr(spiHandle),
-                           LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
-
+    displayBusInitialise(handle, dma, dmaChannel);
     return (ERR_SUCCESS);
 }
 
 /**
- * brief Set the Data/Command pin
- * 
- * @param function Value of the data/command pin
- */
-static inline void setDataCommandGPIO(DCgpio_e function) {
-    if(function == COMMAND) {
-        LL_GPIO_ResetOutputPin(SSD1306_DC_GPIO_Port, SSD1306_DC_Pin);
-    } else {
-        LL_GPIO_SetOutputPin(SSD1306_DC_GPIO_Port, SSD1306_DC_Pin);
-    }
-}
-
-/**
- * @brief Send a command with parameters
+ * @brief Send the segment remap and COM scan direction commands matching an orientation
+ * @details
+ *  The 180° rotation is entirely done by the SSD1306 : mirroring the columns (segment remap)
+ *  and reversing the COM scan direction flips the whole image without touching the buffer.
  *
- * @param regNumber Register number
- * @param parameters Parameters to write
- * @param nbParameters Number of parameters to write
+ * @param newOrientation Orientation to apply
  * @return Success
- * @retval 1	Number of parameters above maximum
- * @retval 2	Timeout while sending the command
+ * @retval 1 Error while sending the segment remap command
+ * @retval 2 Error while sending the COM scan direction command
  */
-errorCode_u sendCommand(SSD1306register_e regNumber, const uint8_t parameters[], uint8_t nbParameters) {
-    const uint8_t MAX_PARAMETERS = 6U;  ///< Maximum number of parameters a command can have
-    errorCode_u   result         = ERR_SUCCESS;
-
-    //assertions
-    assert(spiHandle);                    //handle is not null
-    assert(parameters || !nbParameters);  //either 0 parameters, or parameters array not null
-
-    //if too many parameters, error
-    if(nbParameters > MAX_PARAMETERS) {
-        return (createErrorCode(SEND_CMD, 1, ERR_WARNING));
-    }
-
-    //set command pin and enable SPI
-    systick_t tickAtStart_ms = getSystick();
-    setDataCommandGPIO(COMMAND);
-    LL_SPI_Enable(spiHandle);
-
-    //send the command byte
-    LL_SPI_TransmitData8(spiHandle, (uint8_t)regNumber);
-
-    //send the parameters
-    uint8_t* iterator = (uint8_t*)parameters;
-    while(nbParameters && !isTimeElapsed(tickAtStart_ms, SPI_TIMEOUT_MS)) {
-        //wait for the previous byte to be done, then send the next one
-        while(!LL_SPI_IsActiveFlag_TXE(spiHandle) && !isTimeElapsed(tickAtStart_ms, SPI_TIMEOUT_MS)) {}
-        if(!isTimeElapsed(tickAtStart_ms, SPI_TIMEOUT_MS)) {
-            LL_SPI_TransmitData8(spiHandle, *iterator);
-        }
+static errorCode_u sendOrientation(displayOrientation_e newOrientation) {
+    const SSD1306register_e remapCommands[NB_ORIENTATIONS][2] = {
+        [ORIENTATION_NORMAL]  = {SEGMENT_REMAP_127, SCAN_DIRECTION_N1_0},
+        [ORIENTATION_FLIPPED] = {  SEGMENT_REMAP_0, SCAN_DIRECTION_0_N1},
+    };
+    errorCode_u result;
 
-        iterator++;
-        nbParameters--;
+    result = displayBusSendCommand(remapCommands[newOrientation][0], (void*)0, 0);
+    if(isError(result)) {
+        return (pushErrorCode(result, SET_ORIENTATION, 1));
     }
 
-    //wait for transaction to be finished and clear Overrun flag
-    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed(tickAtStart_ms, SPI_TIMEOUT_MS)) {}
-    LL_SPI_ClearFlag_OVR(spiHandle);
-
-    //disable SPI and return status
-    LL_SPI_Disable(spiHandle);
-
-    //if timeout, error
-    if(isTimeElapsed(tickAtStart_ms, SPI_TIMEOUT_MS)) {
-        return (createErrorCode(SEND_CMD, 2, ERR_WARNING));
+    result = displayBusSendCommand(remapCommands[newOrientation][1], (void*)0, 0);
+    if(isError(result)) {
+        return (pushErrorCode(result, SET_ORIENTATION, 2));
     }
 
-    return (result);
+    orientation = newOrientation;
+    return (ERR_SUCCESS);
 }
 
 /**
- * @brief Wipe the screen blank and draw the separator and icons
- * @note This function invalidates the screen
- *
- * @return Success
+ * @brief Draw the background of the current screen, and mark the whole buffer as to be sent
+ * @note All the widgets of the screen are rendered again afterwards
  */
-errorCode_u drawBaseScreen() {
-    uint8_t*       iteratorBuffer = (uint8_t*)screenBuffer;
-    const uint8_t* iteratorIcon   = baseScreen;
+static void drawBackground() {
+    const widgetRectangle_t fullScreen = {0, SSD_NB_PAGES, 0, SSD_SCREEN_WIDTH};
 
-    //copy the base screen in the buffer
-    for(uint16_t counter = 0; counter < (uint16_t)MAX_DATA_SIZE; counter++) {
-        *(iteratorBuffer++) = *(iteratorIcon++);
+    //copy the background in the buffer (or wipe it if none) in the background, see stateIdle()
+    if(currentScreen->background) {
+        blitCopyAsync(screenBuffer, currentScreen->background, MAX_DATA_SIZE);
+    } else {
+        blitFillAsync(screenBuffer, 0x00, MAX_DATA_SIZE);
     }
 
-    //invalidate the screen and exit
-    screenInvalidated = 1;
-    return (ERR_SUCCESS);
+    widgetsInvalidate(currentScreen);
+    widgetsAddDamage(&damage, &fullScreen);
 }
 
 /**
@@ -223,139 +226,104 @@ uint8_t isScreenReady() {
 
 /**
  * @brief Print an angle (in degrees, with sign) on the screen
- * @note This function invalidates the screen
+ * @note The angle is drawn once the screen is idle, only the characters which changed being sent
  *
  * @param angleTenths	Angle to print
  * @param rotationAxis  Axis around which the rotation angle is to print
  *
  * @return Success
- * @retval 1 Screen busy
  */
 errorCode_u ssd1306PrintAngleTenths(int16_t angleTenths, rotationAxis_e rotationAxis) {
-    const int16_t MIN_ANGLE_DEG_TENTHS        = -900;  ///< Minimum angle allowed (in tenths of degrees)
-    const int16_t MAX_ANGLE_DEG_TENTHS        = 900;   ///< Maximum angle allowed (in tenths of degrees)
-    const uint8_t INDEX_SIGN                  = 0;     ///< Index of the sign in the angle indexes array
-    const uint8_t INDEX_TENS                  = 1U;    ///< Index of the tens in the angle indexes array
-    const uint8_t INDEX_UNITS                 = 2U;    ///< Index of the units in the angle indexes array
-    const uint8_t INDEX_TENTHS                = 4U;    ///< Index of the tenths in the angle indexes array
-    const uint8_t DIVIDE_10                   = 10U;   ///< 10 Divider (used for magic numbers warnings)
-    const uint8_t DIVIDE_100                  = 100U;  ///< 100 Divider (used for magic numbers warnings)
-    uint8_t       charIndexes[ANGLE_NB_CHARS] = {INDEX_PLUS, 0, 0, INDEX_DOT, 0, INDEX_DEG};
-    uint8_t       anglePage                   = (rotationAxis == ROLL ? ANGLE_ROLL_PAGE : ANGLE_PITCH_PAGE);
-    uint8_t*      bytesToUpdate               = (void*)0;
-
-    //if screen busy, error
-    if(!isScreenReady()) {
-        return (createErrorCode(PRT_ANGLE, 1, ERR_WARNING));
-    }
-
-    //clamp the angle to print to the min value
-    if(angleTenths < MIN_ANGLE_DEG_TENTHS) {
-        angleTenths = MIN_ANGLE_DEG_TENTHS;
-    }
-
-    //clamp the angle to print to the max value
-    if(angleTenths > MAX_ANGLE_DEG_TENTHS) {
-        angleTenths = MAX_ANGLE_DEG_TENTHS;
-    }
-
-    //if angle negative, replace plus sign with minus sign
-    if(angleTenths < 0) {
-        charIndexes[INDEX_SIGN] = INDEX_MINUS;
-        angleTenths             = (int16_t)-angleTenths;
-    }
-
-    //fill the angle characters indexes array with the float values (tens, units, tenths)
-    charIndexes[INDEX_TENS]   = (uint8_t)(angleTenths / DIVIDE_100);
-    charIndexes[INDEX_UNITS]  = (uint8_t)((angleTenths / DIVIDE_10) % DIVIDE_10);
-    charIndexes[INDEX_TENTHS] = (uint8_t)(angleTenths % DIVIDE_10);
-
-    //fill the buffer with the angle pixels
-    for(uint8_t page = 0; page < (uint8_t)VERDANA_NB_PAGES; page++) {
-        //point to the beginning of the section in the current page which will be updated
-        bytesToUpdate = &screenBuffer[anglePage + page][ANGLE_COLUMN];
-
-        //update each required byte in the page
-        for(uint8_t character = 0; character < (uint8_t)ANGLE_NB_CHARS; character++) {
-            //save the current character to print
-            uint8_t characterToPrint = charIndexes[character];
-
-            //copy each byte from the Verdana BMP in the buffer
-            for(uint8_t column = 0; column < (uint8_t)VERDANA_CHAR_WIDTH; column++) {
-                bytesToUpdate[(character * VERDANA_CHAR_WIDTH) + column] =
-                    verdana_16ptNumbers[characterToPrint][page][column];
-            }
-        }
-    }
-
-    //invalidate the screen and exit
-    screenInvalidated = 1;
+    widgetsSetValue(&MEASURE_SCREEN, (uint8_t)(rotationAxis == ROLL ? MEASURE_ROLL : MEASURE_PITCH), angleTenths);
     return (ERR_SUCCESS);
 }
 
 /**
  * @brief Draw the icon representing the type of referential currently used
- * @note This function invalidates the screen
+ * @note The icon is drawn once the screen is idle, only if it changed
  * 
  * @param type Referential type
  * @return Success
- * @retval 1 Screen busy
  */
 errorCode_u ssd1306PrintReferentialIcon(referentialType_e type) {
-    uint8_t*       iterator     = &screenBuffer[REFICON_PAGE][REFICON_COLUMN];
-    const uint8_t* iconIterator = (type == ABSOLUTE ? absoluteReferentialIcon : relativeReferentialIcon);
-
-    //if screen busy, error
-    if(!isScreenReady()) {
-        return (createErrorCode(PRT_REFICON, 1, ERR_WARNING));
-    }
-
-    for(uint8_t i = 0; i < (uint8_t)REFERENCETYPE_NB_BYTES; i++) {
-        *(iterator++) = *(iconIterator++);
-    }
-
-    //invalidate the screen and exit
-    screenInvalidated = 1;
+    widgetsSetValue(&MEASURE_SCREEN, MEASURE_REFERENTIAL, (int16_t)type);
     return (ERR_SUCCESS);
 }
 
 /**
  * @brief Draw/erase the icon representing the hold function
- * @note This function invalidates the screen
+ * @note The icon is drawn once the screen is idle, only if it changed
  * 
  * @param status 1 to print, 0 to erase
  * @return Success
- * @retval 1 Screen busy
  */
 errorCode_u ssd1306PrintHoldIcon(uint8_t status) {
-    uint8_t*       iterator     = &screenBuffer[HOLDICON_PAGE][HOLDICON_COLUMN];
-    const uint8_t* iconIterator = holdIcon;
-
-    //if screen busy, error
-    if(!isScreenReady()) {
-        return (createErrorCode(PRT_HOLDICON, 1, ERR_WARNING));
-    }
+    widgetsSetValue(&MEASURE_SCREEN, MEASURE_HOLD, (status ? 1 : 0));
+    return (ERR_SUCCESS);
+}
 
-    for(uint8_t i = 0; i < (uint8_t)REFERENCETYPE_NB_BYTES; i++) {
-        if(status) {
-            *(iterator++) = *(iconIterator++);
-        } else {
-            *(iterator++) = 0x00;
+/**
+ * @brief Draw/erase the arrow indicating the direction in which the surface slopes down
+ * @note The arrow is drawn once the screen is idle, only if it changed
+ *
+ * @param azimuthDegreesTenths Direction of the slope in tenths of degrees, counter-clockwise from the screen right side
+ * @param tiltDegreesTenths Total tilt of the surface in tenths of degrees (arrow erased if level)
+ * @return Success
+ */
+errorCode_u ssd1306PrintSlopeArrow(int16_t azimuthDegreesTenths, uint16_t tiltDegreesTenths) {
+    uint8_t arrow = NB_SLOPE_ARROWS;
+
+    //if not level, get the arrow of which the sector contains the azimuth (sectors centred on multiples of 45°)
+    if(tiltDegreesTenths >= (uint16_t)SLOPE_MIN_TILT) {
+        int32_t azimuth = (int32_t)azimuthDegreesTenths + (SLOPE_SECTOR >> 1U);
+        if(azimuth < 0) {
+            azimuth += FULL_TURN;
         }
+        arrow = (uint8_t)((azimuth / SLOPE_SECTOR) % NB_SLOPE_ARROWS);
     }
 
-    //invalidate the screen and exit
-    screenInvalidated = 1;
+    widgetsSetValue(&MEASURE_SCREEN, MEASURE_SLOPE, arrow);
     return (ERR_SUCCESS);
 }
 
+/**
+ * @brief Request a screen to be shown
+ * @note The screen background is drawn once the screen is idle, and all its widgets are rendered again
+ *
+ * @param[in] screen Screen to show (NULL for the measurements screen)
+ */
+void ssd1306ShowScreen(const widgetScreen_t* screen) {
+    requestedScreen = (screen ? screen : &MEASURE_SCREEN);
+}
+
 /**
  * @brief Turn the screen OFF
  * 
  * @return Return code of the send command instruction
  */
 errorCode_u ssd1306TurnDisplayOFF() {
-    return (sendCommand(DISPLAY_OFF, (void*)0, 0));
+    return (displayBusSendCommand(DISPLAY_OFF, (void*)0, 0));
+}
+
+/**
+ * @brief Request a display orientation
+ * @note The orientation is applied as soon as the screen is idle, and costs nothing per frame
+ *
+ * @param newOrientation Orientation to apply
+ */
+void ssd1306SetOrientation(displayOrientation_e newOrientation) {
+    if(newOrientation < NB_ORIENTATIONS) {
+        requestedOrientation = newOrientation;
+    }
+}
+
+/**
+ * @brief Get the duration of the latest flush (all the rectangles damaged since the previous one)
+ *
+ * @return Duration in microseconds
+ */
+uint32_t ssd1306GetFrameDuration_us(void) {
+    return (frameDuration_us);
 }
 
 /**
@@ -371,61 +339,34 @@ errorCode_u ssd1306Update() {
 /********************************************************************************************************************************************/
 
 /**
- * @brief State in which the SSD1306 configuration registers are set
+ * @brief State in which the panel configuration registers are set
  * 
  * @return Success
  * @retval 1	Error while setting a configuration register
- * @retval 2	Error while setting the update window width
- * @retval 3	Error while setting the update window height
- * @retval 4	Error while requesting the screen wipe
+ * @retval 5	Error while setting the orientation
  */
 static errorCode_u stateConfiguring() {
-    const uint8_t limitColumns[2]                   = {0, (SSD_SCREEN_WIDTH - 1)};
-    const uint8_t limitPages[2]                     = {0, (SSD_NB_PAGES - 1)};
-    const uint8_t initCommands[NB_INIT_REGISERS][3] = {
-        ///< Array used to initialise the registers
-        {SCAN_DIRECTION_N1_0, 0,                                       0x00},
-        {    HARDWARE_CONFIG, 1, SSD_PIN_CONFIG_ALT | SSD_COM_REMAP_DISABLE},
-        {  SEGMENT_REMAP_127, 0,                                       0x00},
-        {   MEMORY_ADDR_MODE, 1,                        SSD_HORIZONTAL_ADDR},
-        {   CONTRAST_CONTROL, 1,                       SSD_CONTRAST_HIGHEST},
-        { CLOCK_DIVIDE_RATIO, 1,   SSD_CLOCK_FREQ_MID | SSD_CLOCK_DIVIDER_1},
-        { CHG_PUMP_REGULATOR, 1,                        SSD_ENABLE_CHG_PUMP},
-        {         DISPLAY_ON, 0,                                       0x00},
-    };
     errorCode_u result;
 
     //reset the chip
     LL_GPIO_ResetOutputPin(SSD1306_RES_GPIO_Port, SSD1306_RES_Pin);
     LL_GPIO_SetOutputPin(SSD1306_RES_GPIO_Port, SSD1306_RES_Pin);
 
-    //initialisation taken from PDF p. 64 (Application Example)
-    //	values which don't change from reset values aren't modified
-    //TODO test for max oscillator frequency
-    for(uint8_t i = 0; i < (uint8_t)NB_INIT_REGISERS; i++) {
-        result = sendCommand(initCommands[i][0], &initCommands[i][2], initCommands[i][1]);
-        if(isError(result)) {
-            return (pushErrorCode(result, INIT, 1));
-        }
-    }
-
-    //screen updates will be done on the whole screen width
-    result = sendCommand(COLUMN_ADDRESS, limitColumns, 2);
+    //set the panel registers and turn the display on
+    result = panelConfigure();
     if(isError(result)) {
-        return (pushErrorCode(result, INIT, 2));
+        return (pushErrorCode(result, INIT, 1));
     }
 
-    //screen updates will be done on the whole screen height
-    result = sendCommand(PAGE_ADDRESS, limitPages, 2);
+    //set the segment remap and COM scan direction (orientation)
+    result = sendOrientation(requestedOrientation);
     if(isError(result)) {
-        return (pushErrorCode(result, INIT, 3));
+        return (pushErrorCode(result, INIT, 5));
     }
 
-    result = drawBaseScreen();
-    if(isError(result)) {
-        screenInvalidated = 0;
-        return (pushErrorCode(result, INIT, 4));
-    }
+    //draw the whole screen (the window is set before each transfer)
+    currentScreen = requestedScreen;
+    drawBackground();
 
     //get to idle state
     state = stateIdle;
@@ -434,42 +375,74 @@ static errorCode_u stateConfiguring() {
 
 /**
  * @brief State in which the screen awaits for commands
+ * @details
+ *  The widgets which changed are rendered in the buffer only here,
+ *  as the buffer must not be modified while being sent.
  *
  * @return Success
+ * @retval 1	Error while applying a new orientation
  */
 errorCode_u stateIdle() {
-    if(screenInvalidated) {
-        screenInvalidated = 0;
-        state             = stateSendingData;
+    //if the background is still being copied in the buffer, wait
+    if(blitIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //if a new orientation has been requested, apply it (no need to redraw anything)
+    if(requestedOrientation != orientation) {
+        errorCode_u result = sendOrientation(requestedOrientation);
+        if(isError(result)) {
+            requestedOrientation = orientation;
+            return (pushErrorCode(result, IDLE, 1));
+        }
+    }
+
+    //if a new screen has been requested, draw its background and render the widgets once it is copied
+    if(requestedScreen != currentScreen) {
+        currentScreen = requestedScreen;
+        drawBackground();
+        return (ERR_SUCCESS);
+    }
+
+    //render the widgets which changed, and flush the rectangles damaged
+    widgetsRender(currentScreen, screenBuffer, &damage);
+    if(damage.nbRectangles) {
+        damageIndex  = 0;
+        transferPage = damage.rectangles[0].page;
+        flushStart   = getCycleCount();
+        state        = stateSendingData;
     }
 
     return (ERR_SUCCESS);
 }
 
 /**
- * @brief State in which data is sent to the screen
+ * @brief State in which the remaining rows of a damaged rectangle are sent to the screen
+ * @note The backend sends as many rows as it can chain at once (e.g. all the rows of a full-width rectangle)
  *
  * @return Success
+ * @retval 1	Error while starting the transfer
  */
 errorCode_u stateSendingData() {
-    const uint16_t MAX_DATA = (SSD_SCREEN_WIDTH * SSD_NB_PAGES);  ///< Maximum data to send the screen
+    const widgetRectangle_t* rectangle = &damage.rectangles[damageIndex];
+    const widgetRectangle_t  window    = {transferPage, (uint8_t)(rectangle->page + rectangle->nbPages - transferPage),
+                                          rectangle->column, rectangle->width};
+    uint8_t                  nbPages   = 0;
 
-    //set data GPIO and enable SPI
-    setDataCommandGPIO(DATA);
-    LL_SPI_Enable(spiHandle);
-
-    //configure the DMA transaction
-    LL_DMA_DisableChannel(dmaHandle, dmaChannelUsed);
-    LL_DMA_ClearFlag_GI5(dmaHandle);
-    LL_DMA_SetDataLength(dmaHandle, dmaChannelUsed, MAX_DATA);  //must be reset every time
-    LL_DMA_EnableChannel(dmaHandle, dmaChannelUsed);
+    errorCode_u result = panelStartTransfer(screenBuffer, &window, &nbPages);
+    if(isError(result)) {
+        damage.nbRectangles = 0;
+        state               = stateIdle;
+        return (pushErrorCode(result, SENDING_DATA, 1));
+    }
 
-    //send the data
-    TXtick = getSystick();
-    LL_SPI_EnableDMAReq_TX(spiHandle);
+    //compute the transfer timeout (page commands included)
+    TXtimeout_us = displayBusGetTransferTimeout_us((uint16_t)((window.width + PANEL_PAGE_OVERHEAD_BYTES) * nbPages));
+    TXtick       = getCycleCount();
 
     //get to next
-    state = stateWaitingForTXdone;
+    transferPage = (uint8_t)(window.page + nbPages);
+    state        = stateWaitingForTXdone;
     return (ERR_SUCCESS);
 }
 
@@ -481,28 +454,54 @@ errorCode_u stateSendingData() {
  * @retval 2	Error interrupt occurred during the DMA transfer
  */
 errorCode_u stateWaitingForTXdone() {
-    errorCode_u result = ERR_SUCCESS;
-
-    //if timer elapsed, stop DMA and error
-    if(isTimeElapsed(TXtick, SPI_TIMEOUT_MS)) {
-        result = createErrorCode(WAITING_DMA_RDY, 1, ERR_ERROR);
-        goto finalise;
-    }
+    errorCode_u             result = ERR_SUCCESS;
+    const displayTransfer_e status = panelGetTransferStatus();
 
     //if DMA error, error
-    if(LL_DMA_IsActiveFlag_TE5(dmaHandle)) {
+    if(status == DISPLAY_TRANSFER_FAILED) {
         result = createErrorCode(WAITING_DMA_RDY, 2, ERR_ERROR);
         goto finalise;
     }
 
-    //if transmission not complete yet, exit
-    if(!LL_DMA_IsActiveFlag_TC5(dmaHandle)) {
+    //if transmission not complete yet, check the timeout (after the status, in case the main loop was slow)
+    if(status != DISPLAY_TRANSFER_DONE) {
+        if(isTimeElapsed_us(TXtick, TXtimeout_us)) {
+            result = createErrorCode(WAITING_DMA_RDY, 1, ERR_ERROR);
+            goto finalise;
+        }
+
         return (ERR_SUCCESS);
     }
 
 finalise:
-    LL_DMA_DisableChannel(dmaHandle, dmaChannelUsed);
-    LL_SPI_Disable(spiHandle);
-    state = stateIdle;
-    return result;
+    //stop the transfer once the last byte is shifted out (before the data/command pin changes)
+    panelStopTransfer();
+
+    //if error, drop the flush
+    if(isError(result)) {
+        damage.nbRectangles = 0;
+        state               = stateIdle;
+        return (result);
+    }
+
+    //if rows remaining in the rectangle, send the next one
+    const widgetRectangle_t* rectangle = &damage.rectangles[damageIndex];
+    if(transferPage < (uint8_t)(rectangle->page + rectangle->nbPages)) {
+        state = stateSendingData;
+        return (ERR_SUCCESS);
+    }
+
+    //if rectangles remaining, send the next one
+    damageIndex++;
+    if(damageIndex < damage.nbRectangles) {
+        transferPage = damage.rectangles[damageIndex].page;
+        state        = stateSendingData;
+        return (ERR_SUCCESS);
+    }
+
+    //save the time needed to flush all the rectangles
+    frameDuration_us    = getElapsed_us(flushStart);
+    damage.nbRectangles = 0;
+    state               = stateIdle;
+    return (ERR_SUCCESS);
 }
@@ -3,6 +3,7 @@
 #include <main.h>
 #include <stdint.h>
 #include "errorstack.h"
+#include "widgets.h"
 
 /**
  * @brief Enumeration of the printable rotation axis
@@ -20,12 +21,25 @@ typedef enum {
     RELATIVE
 } referentialType_e;
 
+/**
+ * @brief Enumeration of the display orientations
+ */
+typedef enum {
+    ORIENTATION_NORMAL = 0,  ///< Screen displayed as mounted on the PCB
+    ORIENTATION_FLIPPED,     ///< Screen rotated by 180°
+    NB_ORIENTATIONS
+} displayOrientation_e;
+
 errorCode_u ssd1306Initialise(SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t dmaChannel);
 errorCode_u ssd1306Update();
 uint8_t     isScreenReady();
 errorCode_u ssd1306PrintAngleTenths(int16_t angleTenths, rotationAxis_e rotationAxis);
 errorCode_u ssd1306PrintReferentialIcon(referentialType_e type);
 errorCode_u ssd1306PrintHoldIcon(uint8_t status);
+errorCode_u ssd1306PrintSlopeArrow(int16_t azimuthDegreesTenths, uint16_t tiltDegreesTenths);
 errorCode_u ssd1306TurnDisplayOFF();
+void        ssd1306SetOrientation(displayOrientation_e orientation);
+uint32_t    ssd1306GetFrameDuration_us(void);
+void        ssd1306ShowScreen(const widgetScreen_t* screen);
 
 #endif /* INC_HARDWARE_SCREEN_SSD1306_H_ */
@@ -29,6 +29,9 @@
 #define SSD_COM_REMAP_DISABLE 0x02U  ///< Value to disable the COM left/right remap (reset value)
 #define SSD_COM_REMAP_ENABLE  0x22U  ///< Value to disable the COM left/right remap
 
+#define SH1106_DCDC_ON  0x8BU  ///< Value to turn the SH1106 DC-DC converter on
+#define SH1106_DCDC_OFF 0x8AU  ///< Value to turn the SH1106 DC-DC converter off (reset value)
+
 /**
  * @brief Enumeration of all the SSD1306 registers listed in the datasheet
  */
@@ -57,6 +60,7 @@ typedef enum {
     MUX_RATIO           = 0xA8,  ///< Set Multiplex Ratio
     DISPLAY_OFF         = 0xAE,  ///< Set Display ON/OFF - Display OFF
     DISPLAY_ON          = 0xAF,  ///< Set Display ON/OFF - Display ON
+    DC_DC_CONTROL       = 0xAD,  ///< Set DC-DC converter ON/OFF (SH1106 only)
     ADDR_MODE_PAGESTART = 0xB0,  ///< Set Page Start Address for Page Addressing Mode
     SCAN_DIRECTION_0_N1 = 0xC0,  ///< Set COM Output Scan Direction - Scan from COM0 to COM[N–1]
     SCAN_DIRECTION_N1_0 = 0xC8,  ///< Set COM Output Scan Direction - Scan from COM[N-1] to COM0
@@ -0,0 +1,309 @@
+/**
+ * @file blit.c
+ * @brief Implement the drawing primitives of the SSD1306 frame buffer format
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  A frame buffer is made of pages of 8 pixel rows, each byte holding a column of a page (bit 0 on top).
+ *  Rows of bytes are filled and copied 32 bits at a time once the destination is aligned,
+ *  and sprites can be drawn at any pixel row by shifting them over two pages.
+ *
+ *  Large copies and fills (e.g. a whole screen background) are done by a DMA channel in memory-to-memory mode,
+ *  the CPU only having to check blitIsBusy() before touching the destination again.
+ *  Without DMA channel (or with unaligned buffers), they are done by the CPU before returning.
+ */
+#include "blit.h"
+#include <stdint.h>
+#include "stm32f1xx_ll_dma.h"
+
+enum {
+    WORD_SIZE       = 4U,                ///< Number of bytes in a word
+    WORD_MASK       = (WORD_SIZE - 1U),  ///< Mask of the address bits which must be 0 for a word access
+    BYTE_TO_WORD    = 0x01010101U,       ///< Multiplier repeating a byte in the 4 bytes of a word
+    PAGE_HEIGHT     = 8U,                ///< Number of pixel rows in a page
+    BYTE_MASK       = 0xFFU,             ///< Mask of a byte
+    DMA_MIN_BYTES   = 64U,               ///< Number of bytes under which a DMA transfer is not worth it
+    DMA_FLAGS_SHIFT = 2U,                ///< Shift between the DMA flags of two consecutive channels
+};
+
+/**
+ * @brief Word type allowed to alias the bytes of a buffer
+ */
+typedef uint32_t __attribute__((may_alias)) blitWord_t;
+
+static DMA_TypeDef* dmaHandle  = (void*)0;  ///< DMA handle used for the large transfers (NULL if none)
+static uint32_t     dmaChannel = 0;         ///< DMA channel used for the large transfers
+static uint32_t     dmaPattern = 0;         ///< Word read over and over by the DMA fills
+static void*        dmaDest    = (void*)0;  ///< Destination of the DMA transfer in progress
+static const void*  dmaSource  = (void*)0;  ///< Source of the DMA transfer in progress (NULL for a fill)
+static uint16_t     dmaNbBytes = 0;         ///< Number of bytes of the DMA transfer in progress (0 if none)
+
+static void            fillBytes(uint8_t* destination, uint8_t pattern, uint16_t nbBytes);
+static void            copyBytes(uint8_t* destination, const uint8_t* source, uint16_t nbBytes);
+static void            startTransfer(void* destination, const void* source, uint16_t nbBytes, uint32_t sourceIncrement);
+static inline uint32_t dmaChannelFlag(uint32_t channel1Flag);
+
+/**
+ * @brief Set the DMA channel used for the large transfers
+ * @note The channel must not be used by any peripheral (e.g. DMA1 channel 1)
+ *
+ * @param dma DMA handle used (NULL to do everything with the CPU)
+ * @param channel DMA channel used
+ */
+void blitInitialise(DMA_TypeDef* dma, uint32_t channel) {
+    dmaHandle  = dma;
+    dmaChannel = channel;
+    dmaNbBytes = 0;
+
+    if(dmaHandle) {
+        LL_DMA_DisableChannel(dmaHandle, dmaChannel);
+    }
+}
+
+/**
+ * @brief Fill an area of a frame buffer with a byte
+ *
+ * @param[out] frame Frame buffer
+ * @param[in] area Area to fill
+ * @param pattern Byte to write in each column of each page
+ */
+void blitFill(uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* area, uint8_t pattern) {
+    for(uint8_t page = 0; page < area->nbPages; page++) {
+        fillBytes(&frame[area->page + page][area->column], pattern, area->width);
+    }
+}
+
+/**
+ * @brief Erase an area of a frame buffer
+ *
+ * @param[out] frame Frame buffer
+ * @param[in] area Area to erase
+ */
+void blitClear(uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* area) {
+    blitFill(frame, area, 0x00);
+}
+
+/**
+ * @brief Copy a page-aligned bitmap in an area of a frame buffer
+ *
+ * @param[out] frame Frame buffer
+ * @param[in] area Area to fill
+ * @param[in] bitmap Bitmap to copy, page by page (area width bytes per page)
+ */
+void blitCopy(uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* area, const uint8_t bitmap[]) {
+    for(uint8_t page = 0; page < area->nbPages; page++) {
+        copyBytes(&frame[area->page + page][area->column], &bitmap[page * area->width], area->width);
+    }
+}
+
+/**
+ * @brief Draw a sprite at any pixel row, leaving the pixels out of its mask untouched
+ * @note The parts of the sprite out of the frame buffer are clipped
+ *
+ * @param[out] frame Frame buffer
+ * @param[in] sprite Sprite to draw
+ * @param column Column of the left side of the sprite
+ * @param row Pixel row of the top of the sprite
+ */
+void blitMasked(uint8_t frame[][WIDGET_SCREEN_WIDTH], const blitSprite_t* sprite, uint8_t column, uint8_t row) {
+    const uint8_t shift     = (uint8_t)(row % PAGE_HEIGHT);
+    const uint8_t firstPage = (uint8_t)(row / PAGE_HEIGHT);
+    uint8_t       width     = sprite->width;
+
+    if(column >= (uint8_t)WIDGET_SCREEN_WIDTH) {
+        return;
+    }
+    if(width > (uint8_t)(WIDGET_SCREEN_WIDTH - column)) {
+        width = (uint8_t)(WIDGET_SCREEN_WIDTH - column);
+    }
+
+    for(uint8_t spritePage = 0; spritePage < sprite->nbPages; spritePage++) {
+        const uint8_t  page   = (uint8_t)(firstPage + spritePage);
+        const uint8_t* bitmap = &sprite->bitmap[spritePage * sprite->width];
+        const uint8_t* mask   = (sprite->mask ? &sprite->mask[spritePage * sprite->width] : (void*)0);
+
+        //if below the frame buffer, clip the remaining pages
+        if(page >= (uint8_t)WIDGET_NB_PAGES) {
+            return;
+        }
+
+        //shift each column over the two pages it overlaps, and merge it within its mask
+        uint8_t* top    = &frame[page][column];
+        uint8_t* bottom = ((shift && ((page + 1U) < (uint8_t)WIDGET_NB_PAGES)) ? &frame[page + 1U][column] : (void*)0);
+        for(uint8_t index = 0; index < width; index++) {
+            const uint16_t visible = (uint16_t)((mask ? mask[index] : BYTE_MASK) << shift);
+            const uint16_t pixels  = (uint16_t)((bitmap[index] << shift) & visible);
+
+            top[index] = (uint8_t)((top[index] & ~visible) | pixels);
+            if(bottom) {
+                bottom[index] = (uint8_t)((bottom[index] & ~(visible >> PAGE_HEIGHT)) | (pixels >> PAGE_HEIGHT));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copy a buffer, in the background by DMA if large enough
+ * @warning Neither buffer may be modified before blitIsBusy() returns 0
+ *
+ * @param[out] destination Destination buffer
+ * @param[in] source Source buffer (may be in flash)
+ * @param nbBytes Number of bytes to copy
+ */
+void blitCopyAsync(void* destination, const void* source, uint16_t nbBytes) {
+    startTransfer(destination, source, nbBytes, LL_DMA_PERIPH_INCREMENT);
+}
+
+/**
+ * @brief Fill a buffer with a byte, in the background by DMA if large enough
+ * @warning The buffer may not be modified before blitIsBusy() returns 0
+ *
+ * @param[out] destination Destination buffer
+ * @param pattern Byte to write
+ * @param nbBytes Number of bytes to fill
+ */
+void blitFillAsync(void* destination, uint8_t pattern, uint16_t nbBytes) {
+    dmaPattern = pattern * BYTE_TO_WORD;
+    startTransfer(destination, (void*)0, nbBytes, LL_DMA_PERIPH_NOINCREMENT);
+}
+
+/**
+ * @brief Check if a background transfer is still in progress
+ * @note If the DMA reports an error, the transfer is done again by the CPU
+ *
+ * @retval 0 No transfer in progress, the buffers can be used
+ * @retval 1 Transfer in progress
+ */
+uint8_t blitIsBusy(void) {
+    if(!dmaHandle || !dmaNbBytes) {
+        return (0);
+    }
+
+    //if transfer neither complete nor failed, still busy (flags checked first, as an error also disables the channel)
+    const uint32_t flags = READ_REG(dmaHandle->ISR);
+    if(!(flags & (dmaChannelFlag(DMA_ISR_TCIF1) | dmaChannelFlag(DMA_ISR_TEIF1)))
+       && LL_DMA_IsEnabledChannel(dmaHandle, dmaChannel)) {
+        return (1);
+    }
+
+    LL_DMA_DisableChannel(dmaHandle, dmaChannel);
+    WRITE_REG(dmaHandle->IFCR, dmaChannelFlag(DMA_IFCR_CGIF1));
+
+    //if transfer error, do it with the CPU
+    if(flags & dmaChannelFlag(DMA_ISR_TEIF1)) {
+        if(dmaSource) {
+            copyBytes(dmaDest, dmaSource, dmaNbBytes);
+        } else {
+            fillBytes(dmaDest, (uint8_t)dmaPattern, dmaNbBytes);
+        }
+    }
+
+    dmaNbBytes = 0;
+
+    return (0);
+}
+
+/**
+ * @brief Start a memory-to-memory DMA transfer, or do it with the CPU if not possible
+ *
+ * @param[out] destination Destination buffer
+ * @param[in] source Source buffer (NULL to fill with the DMA pattern)
+ * @param nbBytes Number of bytes to transfer
+ * @param sourceIncrement Source address increment (LL_DMA_PERIPH_INCREMENT or LL_DMA_PERIPH_NOINCREMENT)
+ */
+static void startTransfer(void* destination, const void* source, uint16_t nbBytes, uint32_t sourceIncrement) {
+    const uint32_t misaligned = ((uint32_t)destination | (uint32_t)source | nbBytes) & WORD_MASK;
+
+    //wait for the previous transfer to be done
+    while(blitIsBusy()) {}
+
+    //if no DMA, too small or not word-aligned, do it with the CPU
+    if(!dmaHandle || (nbBytes < (uint16_t)DMA_MIN_BYTES) || misaligned) {
+        if(source) {
+            copyBytes(destination, source, nbBytes);
+        } else {
+            fillBytes(destination, (uint8_t)dmaPattern, nbBytes);
+        }
+        return;
+    }
+
+    dmaDest    = destination;
+    dmaSource  = source;
+    dmaNbBytes = nbBytes;
+
+    //in memory-to-memory mode, the DMA reads the peripheral address and writes the memory one
+    WRITE_REG(dmaHandle->IFCR, dmaChannelFlag(DMA_IFCR_CGIF1));
+    LL_DMA_ConfigTransfer(dmaHandle, dmaChannel,
+                          LL_DMA_DIRECTION_MEMORY_TO_MEMORY | LL_DMA_PRIORITY_LOW | LL_DMA_MODE_NORMAL | sourceIncrement
+                              | LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_WORD | LL_DMA_MDATAALIGN_WORD);
+    LL_DMA_ConfigAddresses(dmaHandle, dmaChannel, (uint32_t)(source ? source : &dmaPattern), (uint32_t)destination,
+                           LL_DMA_DIRECTION_MEMORY_TO_MEMORY);
+    LL_DMA_SetDataLength(dmaHandle, dmaChannel, (uint32_t)nbBytes / WORD_SIZE);
+    LL_DMA_EnableChannel(dmaHandle, dmaChannel);
+}
+
+/**
+ * @brief Fill bytes, 32 bits at a time once the destination is aligned
+ *
+ * @param[out] destination Bytes to fill
+ * @param pattern Byte to write
+ * @param nbBytes Number of bytes to fill
+ */
+static void fillBytes(uint8_t* destination, uint8_t pattern, uint16_t nbBytes) {
+    const uint32_t word = pattern * BYTE_TO_WORD;
+
+    while(nbBytes && ((uint32_t)destination & WORD_MASK)) {
+        *(destination++) = pattern;
+        nbBytes--;
+    }
+
+    blitWord_t* words = (blitWord_t*)(void*)destination;
+    for(; nbBytes >= (uint16_t)WORD_SIZE; nbBytes -= (uint16_t)WORD_SIZE) {
+        *(words++) = word;
+    }
+
+    destination = (uint8_t*)(void*)words;
+    while(nbBytes--) {
+        *(destination++) = pattern;
+    }
+}
+
+/**
+ * @brief Copy bytes, 32 bits at a time if both buffers can be aligned together
+ *
+ * @param[out] destination Destination bytes
+ * @param[in] source Source bytes
+ * @param nbBytes Number of bytes to copy
+ */
+static void copyBytes(uint8_t* destination, const uint8_t* source, uint16_t nbBytes) {
+    if(!(((uint32_t)destination ^ (uint32_t)source) & WORD_MASK)) {
+        while(nbBytes && ((uint32_t)destination & WORD_MASK)) {
+            *(destination++) = *(source++);
+            nbBytes--;
+        }
+
+        blitWord_t*       wordsOut = (blitWord_t*)(void*)destination;
+        const blitWord_t* wordsIn  = (const blitWord_t*)(const void*)source;
+        for(; nbBytes >= (uint16_t)WORD_SIZE; nbBytes -= (uint16_t)WORD_SIZE) {
+            *(wordsOut++) = *(wordsIn++);
+        }
+
+        destination = (uint8_t*)(void*)wordsOut;
+        source      = (const uint8_t*)(const void*)wordsIn;
+    }
+
+    while(nbBytes--) {
+        *(destination++) = *(source++);
+    }
+}
+
+/**
+ * @brief Get the flag of the DMA channel used from its channel 1 equivalent
+ *
+ * @param channel1Flag Flag value for the channel 1 (e.g. DMA_ISR_TCIF1)
+ * @return Flag value for the channel used
+ */
+static inline uint32_t dmaChannelFlag(uint32_t channel1Flag) {
+    return (channel1Flag << ((dmaChannel - LL_DMA_CHANNEL_1) << DMA_FLAGS_SHIFT));
+}
@@ -0,0 +1,26 @@
+#ifndef BLIT_H_INCLUDED
+#define BLIT_H_INCLUDED
+#include <stdint.h>
+#include "stm32f103xb.h"
+#include "widgets.h"
+
+/**
+ * @brief Structure representing a sprite, drawn at any pixel row
+ */
+typedef struct {
+    const uint8_t* bitmap;   ///< Bitmap, page by page (bit 0 of each byte on top)
+    const uint8_t* mask;     ///< Pixels of the bitmap to draw, same layout (NULL to draw all of them)
+    uint8_t        width;    ///< Number of columns
+    uint8_t        nbPages;  ///< Number of pages of the bitmap
+} blitSprite_t;
+
+void    blitInitialise(DMA_TypeDef* dma, uint32_t channel);
+void    blitFill(uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* area, uint8_t pattern);
+void    blitClear(uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* area);
+void    blitCopy(uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* area, const uint8_t bitmap[]);
+void    blitMasked(uint8_t frame[][WIDGET_SCREEN_WIDTH], const blitSprite_t* sprite, uint8_t column, uint8_t row);
+void    blitCopyAsync(void* destination, const void* source, uint16_t nbBytes);
+void    blitFillAsync(void* destination, uint8_t pattern, uint16_t nbBytes);
+uint8_t blitIsBusy(void);
+
+#endif
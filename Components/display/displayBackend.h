@@ -0,0 +1,30 @@
+#ifndef DISPLAYBACKEND_H_INCLUDED
+#define DISPLAYBACKEND_H_INCLUDED
+#include <stdint.h>
+#include "displayBus.h"
+#include "errorstack.h"
+#include "widgets.h"
+
+#if !defined(DISPLAY_PANEL_SSD1306) && !defined(DISPLAY_PANEL_SSD1309) && !defined(DISPLAY_PANEL_SH1106)
+#define DISPLAY_PANEL_SSD1306  ///< Panel driven when none is selected by the build
+#endif
+
+#if defined(DISPLAY_PANEL_SH1106)
+enum {
+    PANEL_PAGE_OVERHEAD_BYTES = 3U,  ///< Command bytes sent by DMA before each page (page, column low and high)
+};
+#else
+enum {
+    PANEL_PAGE_OVERHEAD_BYTES = 0,  ///< Command bytes sent by DMA before each page (window set beforehand)
+};
+#endif
+
+//panel backend, implemented by the panel file selected by the build (see Components/CMakeLists.txt)
+errorCode_u       panelConfigure(void);
+errorCode_u       panelStartTransfer(const uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* window,
+                                     uint8_t* nbPagesStarted);
+displayTransfer_e panelGetTransferStatus(void);
+void              panelStopTransfer(void);
+void              panelDMAIRQhandler(void);  //only implemented by the interrupt-driven backends (SH1106)
+
+#endif
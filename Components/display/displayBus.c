@@ -0,0 +1,231 @@
+/**
+ * @file displayBus.c
+ * @brief Implement the SPI and DMA communication shared by the display panels
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The panels (see displayBackend.h) are all driven through a transmit-only SPI and a data/command pin.
+ *  Commands are sent by polling, as they are only a few bytes long, and the frame buffer is sent via DMA.
+ *  The DMA flags used are the channel 5 ones (SPI2 TX).
+ */
+#include "displayBus.h"
+#include <assert.h>
+#include <stdint.h>
+#include "errorstack.h"
+#include "main.h"
+#include "stm32f103xb.h"
+#include "stm32f1xx_ll_dma.h"
+#include "stm32f1xx_ll_gpio.h"
+#include "stm32f1xx_ll_spi.h"
+#include "systick.h"
+
+enum {
+    MAX_PARAMETERS       = 6U,        ///< Maximum number of parameters a command can have
+    SPI_TIMEOUT_EXTRA_US = 20U,       ///< Microseconds added to twice the SPI transfer time as a timeout
+    BITS_PER_BYTE        = 8U,        ///< Number of bits in a byte
+    US_PER_SECOND        = 1000000U,  ///< Number of microseconds in a second
+};
+
+/**
+ * @brief Enumeration of the function IDs of the display bus
+ */
+typedef enum {
+    SEND_CMD = 1,  ///< displayBusSendCommand()
+} displayBusFunctionCodes_e;
+
+static inline void setDataCommandGPIO(DCgpio_e function);
+
+static SPI_TypeDef* spiHandle      = (void*)0;     ///< SPI handle used with the display
+static DMA_TypeDef* dmaHandle      = (void*)0;     ///< DMA handle used with the display
+static uint32_t     dmaChannelUsed = 0x00000000U;  ///< DMA channel used
+
+/**
+ * @brief Initialise the display bus
+ *
+ * @param handle        SPI handle used
+ * @param dma           DMA handle used
+ * @param dmaChannel    DMA channel used to send data to the display
+ */
+void displayBusInitialise(SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t dmaChannel) {
+    spiHandle      = handle;
+    dmaHandle      = dma;
+    dmaChannelUsed = dmaChannel;
+
+    //make sure to disable the display SPI communication
+    LL_SPI_Disable(spiHandle);
+    LL_DMA_DisableChannel(dmaHandle, dmaChannelUsed);
+
+    //set the DMA destination address (will always be the same one)
+    LL_DMA_SetPeriphAddress(dmaHandle, dmaChannelUsed, LL_SPI_DMA_GetRegAddr(spiHandle));
+}
+
+/**
+ * brief Set the Data/Command pin
+ *
+ * @param function Value of the data/command pin
+ */
+static inline void setDataCommandGPIO(DCgpio_e function) {
+    if(function == COMMAND) {
+        LL_GPIO_ResetOutputPin(SSD1306_DC_GPIO_Port, SSD1306_DC_Pin);
+    } else {
+        LL_GPIO_SetOutputPin(SSD1306_DC_GPIO_Port, SSD1306_DC_Pin);
+    }
+}
+
+/**
+ * @brief Send a command with parameters
+ *
+ * @param command Command byte
+ * @param parameters Parameters to write
+ * @param nbParameters Number of parameters to write
+ * @return Success
+ * @retval 1	Number of parameters above maximum
+ * @retval 2	Timeout while sending the command
+ */
+errorCode_u displayBusSendCommand(uint8_t command, const uint8_t parameters[], uint8_t nbParameters) {
+    //assertions
+    assert(spiHandle);                    //handle is not null
+    assert(parameters || !nbParameters);  //either 0 parameters, or parameters array not null
+
+    //if too many parameters, error
+    if(nbParameters > (uint8_t)MAX_PARAMETERS) {
+        return (createErrorCode(SEND_CMD, 1, ERR_WARNING));
+    }
+
+    //set command pin and enable SPI
+    const uint32_t     timeout_us  = displayBusGetTransferTimeout_us((uint16_t)nbParameters + 1U);
+    const cyclecount_t tickAtStart = getCycleCount();
+    setDataCommandGPIO(COMMAND);
+    LL_SPI_Enable(spiHandle);
+
+    //send the command byte
+    LL_SPI_TransmitData8(spiHandle, command);
+
+    //send the parameters
+    const uint8_t* iterator = parameters;
+    while(nbParameters) {
+        //wait for the previous byte to be done, then send the next one (stop if it never is)
+        while(!LL_SPI_IsActiveFlag_TXE(spiHandle) && !isTimeElapsed_us(tickAtStart, timeout_us)) {}
+        if(!LL_SPI_IsActiveFlag_TXE(spiHandle)) {
+            break;
+        }
+        LL_SPI_TransmitData8(spiHandle, *iterator);
+
+        iterator++;
+        nbParameters--;
+    }
+
+    //wait for transaction to be finished and clear Overrun flag
+    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed_us(tickAtStart, timeout_us)) {}
+    const uint8_t busy = (uint8_t)LL_SPI_IsActiveFlag_BSY(spiHandle);
+    LL_SPI_ClearFlag_OVR(spiHandle);
+
+    //disable SPI and return status
+    LL_SPI_Disable(spiHandle);
+
+    //if the bytes have not all been shifted out in time, error (time elapsed after the transfer does not count)
+    if(nbParameters || busy) {
+        return (createErrorCode(SEND_CMD, 2, ERR_WARNING));
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Start sending bytes via DMA
+ * @warning The previous bytes must be shifted out (see displayBusWaitLastByte()) before the data/command pin changes
+ *
+ * @param[in] bytes Bytes to send (must stay untouched until the transfer is done)
+ * @param nbBytes Number of bytes to send
+ * @param function Value of the data/command pin while sending the bytes
+ */
+void displayBusStartDMA(const uint8_t bytes[], uint16_t nbBytes, DCgpio_e function) {
+    //set data/command GPIO and enable SPI
+    setDataCommandGPIO(function);
+    LL_SPI_Enable(spiHandle);
+
+    //configure the DMA transaction
+    LL_DMA_DisableChannel(dmaHandle, dmaChannelUsed);
+    LL_DMA_ClearFlag_GI5(dmaHandle);
+    LL_DMA_SetMemoryAddress(dmaHandle, dmaChannelUsed, (uint32_t)bytes);
+    LL_DMA_SetDataLength(dmaHandle, dmaChannelUsed, nbBytes);  //must be reset every time
+    LL_DMA_EnableChannel(dmaHandle, dmaChannelUsed);
+
+    //send the bytes (request already enabled if chaining transfers)
+    LL_SPI_EnableDMAReq_TX(spiHandle);
+}
+
+/**
+ * @brief Get the state of the current DMA transfer
+ *
+ * @return State of the transfer
+ */
+displayTransfer_e displayBusGetDMAStatus(void) {
+    if(LL_DMA_IsActiveFlag_TE5(dmaHandle)) {
+        return (DISPLAY_TRANSFER_FAILED);
+    }
+
+    return (LL_DMA_IsActiveFlag_TC5(dmaHandle) ? DISPLAY_TRANSFER_DONE : DISPLAY_TRANSFER_BUSY);
+}
+
+/**
+ * @brief Enable or disable the DMA transfer complete and transfer error interrupts
+ *
+ * @param enable 1 to enable, 0 to disable
+ */
+void displayBusEnableDMAInterrupts(uint8_t enable) {
+    if(enable) {
+        LL_DMA_ClearFlag_GI5(dmaHandle);
+        LL_DMA_EnableIT_TC(dmaHandle, dmaChannelUsed);
+        LL_DMA_EnableIT_TE(dmaHandle, dmaChannelUsed);
+    } else {
+        LL_DMA_DisableIT_TC(dmaHandle, dmaChannelUsed);
+        LL_DMA_DisableIT_TE(dmaHandle, dmaChannelUsed);
+    }
+}
+
+/**
+ * @brief Clear all the DMA flags of the channel used
+ */
+void displayBusClearDMAFlags(void) {
+    LL_DMA_ClearFlag_GI5(dmaHandle);
+}
+
+/**
+ * @brief Wait for the last byte to be shifted out, so that the data/command pin can change
+ * @note This takes at most a byte transfer time after the DMA transfer completed
+ */
+void displayBusWaitLastByte(void) {
+    const cyclecount_t lastByteTick = getCycleCount();
+    const uint32_t     timeout_us   = displayBusGetTransferTimeout_us(1U);
+
+    while((!LL_SPI_IsActiveFlag_TXE(spiHandle) || LL_SPI_IsActiveFlag_BSY(spiHandle))
+          && !isTimeElapsed_us(lastByteTick, timeout_us)) {}
+}
+
+/**
+ * @brief Stop the DMA transfer and disable the SPI, once the last byte is shifted out
+ */
+void displayBusStopDMA(void) {
+    displayBusWaitLastByte();
+    LL_SPI_DisableDMAReq_TX(spiHandle);
+    LL_DMA_DisableChannel(dmaHandle, dmaChannelUsed);
+    LL_SPI_Disable(spiHandle);
+}
+
+/**
+ * @brief Get the time after which an SPI transfer is in timeout, from its duration at the current speed
+ *
+ * @param nbBytes Number of bytes transferred
+ * @return Timeout in [us]
+ */
+uint32_t displayBusGetTransferTimeout_us(uint16_t nbBytes) {
+    const uint32_t apbClock_MHz = (SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos])
+                                / US_PER_SECOND;
+    const uint32_t prescaler    = LL_SPI_GetBaudRatePrescaler(spiHandle) >> SPI_CR1_BR_Pos;
+    const uint32_t apbCycles    = ((uint32_t)nbBytes * BITS_PER_BYTE) << (prescaler + 1U);
+    const uint32_t transfer_us  = (apbCycles + apbClock_MHz - 1U) / apbClock_MHz;
+
+    return ((transfer_us << 1U) + SPI_TIMEOUT_EXTRA_US);
+}
@@ -0,0 +1,34 @@
+#ifndef DISPLAYBUS_H_INCLUDED
+#define DISPLAYBUS_H_INCLUDED
+#include <stdint.h>
+#include "errorstack.h"
+#include "stm32f103xb.h"
+
+/**
+ * @brief SPI Data/command pin status enumeration
+ */
+typedef enum {
+    COMMAND = 0,  ///< Command is to be sent
+    DATA,         ///< Data is to be sent
+} DCgpio_e;
+
+/**
+ * @brief Enumeration of the states of a DMA transfer to the display
+ */
+typedef enum {
+    DISPLAY_TRANSFER_BUSY = 0,  ///< Bytes still being sent
+    DISPLAY_TRANSFER_DONE,      ///< All the bytes sent
+    DISPLAY_TRANSFER_FAILED,    ///< DMA transfer error
+} displayTransfer_e;
+
+void              displayBusInitialise(SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t dmaChannel);
+errorCode_u       displayBusSendCommand(uint8_t command, const uint8_t parameters[], uint8_t nbParameters);
+void              displayBusStartDMA(const uint8_t bytes[], uint16_t nbBytes, DCgpio_e function);
+displayTransfer_e displayBusGetDMAStatus(void);
+void              displayBusEnableDMAInterrupts(uint8_t enable);
+void              displayBusClearDMAFlags(void);
+void              displayBusWaitLastByte(void);
+void              displayBusStopDMA(void);
+uint32_t          displayBusGetTransferTimeout_us(uint16_t nbBytes);
+
+#endif
@@ -2,7 +2,7 @@
 #include "icons.h"
 #include <stdint.h>
 
-const uint8_t baseScreen[MAX_DATA_SIZE] = {
+const uint8_t baseScreen[MAX_DATA_SIZE] __attribute__((aligned(4))) = {
     //                               ##                                                                                                 //Page 0
     //                               ##                                                                                                
     //                               ##                                                                                                
@@ -113,3 +113,103 @@ const uint8_t holdIcon[REFERENCETYPE_NB_BYTES] = {
     // #######
     0xFF, 0x81, 0xF7, 0xF7, 0xF7, 0x81, 0xFF,
 };
+
+//arrows pointing downhill, counter-clockwise from the screen right side (device +X axis)
+const uint8_t slopeArrowIcons[NB_SLOPE_ARROWS][REFERENCETYPE_NB_BYTES] = {
+    {
+        // east
+        // #######
+        // ### ###
+        // #### ##
+        // #     #
+        // #### ##
+        // ### ###
+        // #######
+        // #######
+        0xFF, 0xF7, 0xF7, 0xD5, 0xE3, 0xF7, 0xFF,
+    },
+    {
+        // north-east
+        // #######
+        // ##    #
+        // ####  #
+        // ### # #
+        // ## ## #
+        // # #####
+        // #######
+        // #######
+        0xFF, 0xDF, 0xED, 0xF5, 0xF9, 0xE1, 0xFF,
+    },
+    {
+        // north
+        // #######
+        // ### ###
+        // ##   ##
+        // # # # #
+        // ### ###
+        // ### ###
+        // ### ###
+        // #######
+        0xFF, 0xF7, 0xFB, 0x81, 0xFB, 0xF7, 0xFF,
+    },
+    {
+        // north-west
+        // #######
+        // #    ##
+        // #  ####
+        // # # ###
+        // # ## ##
+        // ##### #
+        // #######
+        // #######
+        0xFF, 0xE1, 0xF9, 0xF5, 0xED, 0xDF, 0xFF,
+    },
+    {
+        // west
+        // #######
+        // ### ###
+        // ## ####
+        // #     #
+        // ## ####
+        // ### ###
+        // #######
+        // #######
+        0xFF, 0xF7, 0xE3, 0xD5, 0xF7, 0xF7, 0xFF,
+    },
+    {
+        // south-west
+        // #######
+        // ##### #
+        // # ## ##
+        // # # ###
+        // #  ####
+        // #    ##
+        // #######
+        // #######
+        0xFF, 0xC3, 0xCF, 0xD7, 0xDB, 0xFD, 0xFF,
+    },
+    {
+        // south
+        // #######
+        // ### ###
+        // ### ###
+        // ### ###
+        // # # # #
+        // ##   ##
+        // ### ###
+        // #######
+        0xFF, 0xEF, 0xDF, 0x81, 0xDF, 0xEF, 0xFF,
+    },
+    {
+        // south-east
+        // #######
+        // # #####
+        // ## ## #
+        // ### # #
+        // ####  #
+        // ##    #
+        // #######
+        // #######
+        0xFF, 0xFD, 0xDB, 0xD7, 0xCF, 0xC3, 0xFF,
+    },
+};
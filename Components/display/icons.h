@@ -7,11 +7,13 @@ enum {
     ARROWSICON_NB_BYTES    = (UINT8_MAX + 1),  ///< Total number of bytes occupied by the arrows icon
     ARROWSICON_WIDTH       = 32U,              ///< Pixel width of the icon
     REFERENCETYPE_NB_BYTES = 7U,
+    NB_SLOPE_ARROWS        = 8U,  ///< Number of slope direction arrows (one every 45°)
 };
 
 extern const uint8_t baseScreen[MAX_DATA_SIZE];
 extern const uint8_t relativeReferentialIcon[REFERENCETYPE_NB_BYTES];
 extern const uint8_t absoluteReferentialIcon[REFERENCETYPE_NB_BYTES];
 extern const uint8_t holdIcon[REFERENCETYPE_NB_BYTES];
+extern const uint8_t slopeArrowIcons[NB_SLOPE_ARROWS][REFERENCETYPE_NB_BYTES];
 
 #endif
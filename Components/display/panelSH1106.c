@@ -0,0 +1,165 @@
+/**
+ * @file panelSH1106.c
+ * @brief Implement the display backend of the SH1106 panels
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The SH1106 only supports the page addressing mode : the RAM pointer does not wrap to the next page,
+ *  so each page of a rectangle is preceded by its own page and column commands.
+ *  Those are chained by the DMA transfer complete interrupt : the 3 command bytes of a page are sent via DMA,
+ *  then its data, then the command bytes of the next page, and so on, the main loop never waiting for a page switch.
+ *  The SH1106 RAM is 132 columns wide, the 128 columns of the glass being centred in it.
+ *
+ * @note Datasheet : SH1106, 132 X 64 Dot Matrix OLED/PLED Segment/Common Driver with Controller (Sino Wealth)
+ */
+#include <stdint.h>
+#include "SSD1306_registers.h"
+#include "displayBackend.h"
+#include "displayBus.h"
+#include "errorstack.h"
+#include "widgets.h"
+
+enum {
+    PANEL_COLUMN_OFFSET = 2U,     ///< First RAM column shown on the glass ((132 - 128) / 2)
+    NB_INIT_REGISTERS   = 5U,     ///< Number of registers set at initialisation
+    COLUMN_NIBBLE_MASK  = 0x0FU,  ///< Mask of the column address nibble sent in each column command
+    COLUMN_HIGH_SHIFT   = 4U,     ///< Shift of the column address high nibble
+    NB_PAGE_COMMANDS    = 3U,     ///< Number of command bytes sent before each page (page, column low and high)
+};
+
+/**
+ * @brief Enumeration of the function IDs of the SH1106 backend
+ */
+typedef enum {
+    CONFIGURE = 1,  ///< panelConfigure()
+} panelFunctionCodes_e;
+
+static void sendPageCommands(void);
+
+static const uint8_t (*transferFrame)[WIDGET_SCREEN_WIDTH] = (void*)0;  ///< Frame buffer being sent
+static widgetRectangle_t          transferWindow;                          ///< Rectangle being sent
+static uint8_t                    transferPage   = 0;                      ///< Page being sent
+static DCgpio_e                   transferPhase  = COMMAND;                ///< Bytes being sent (commands or data)
+static volatile displayTransfer_e transferStatus = DISPLAY_TRANSFER_DONE;  ///< State of the whole rectangle transfer
+static uint8_t                    pageCommands[NB_PAGE_COMMANDS];           ///< Commands sent before each page
+
+/**
+ * @brief Initialise the SH1106 registers and turn the display on
+ * @note The page addressing mode is the only one available (reset value)
+ *
+ * @return Success
+ * @retval 1	Error while setting a configuration register
+ */
+errorCode_u panelConfigure(void) {
+    const uint8_t initCommands[NB_INIT_REGISTERS][3] = {
+        ///< Array used to initialise the registers
+        {   HARDWARE_CONFIG, 1, SSD_PIN_CONFIG_ALT | SSD_COM_REMAP_DISABLE},
+        {  CONTRAST_CONTROL, 1,                       SSD_CONTRAST_HIGHEST},
+        {CLOCK_DIVIDE_RATIO, 1,   SSD_CLOCK_FREQ_MID | SSD_CLOCK_DIVIDER_1},
+        {     DC_DC_CONTROL, 1,                             SH1106_DCDC_ON},
+        {        DISPLAY_ON, 0,                                       0x00},
+    };
+
+    for(uint8_t i = 0; i < (uint8_t)NB_INIT_REGISTERS; i++) {
+        errorCode_u result = displayBusSendCommand(initCommands[i][0], &initCommands[i][2], initCommands[i][1]);
+        if(isError(result)) {
+            return (pushErrorCode(result, CONFIGURE, 1));
+        }
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Start sending a rectangle, all its pages being chained by the DMA interrupt
+ *
+ * @param[in] frame Frame buffer
+ * @param[in] window Rectangle of the frame buffer to send
+ * @param[out] nbPagesStarted Number of pages of the rectangle being sent (all of them)
+ * @return Success
+ */
+errorCode_u panelStartTransfer(const uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* window,
+                               uint8_t* nbPagesStarted) {
+    transferFrame  = frame;
+    transferWindow = *window;
+    transferPage   = window->page;
+    transferStatus = DISPLAY_TRANSFER_BUSY;
+
+    displayBusEnableDMAInterrupts(1);
+    sendPageCommands();
+
+    *nbPagesStarted = window->nbPages;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Get the state of the transfer started
+ *
+ * @return State of the whole rectangle transfer
+ */
+displayTransfer_e panelGetTransferStatus(void) {
+    return (transferStatus);
+}
+
+/**
+ * @brief Stop the transfer (done, failed or in timeout)
+ */
+void panelStopTransfer(void) {
+    displayBusEnableDMAInterrupts(0);
+    displayBusStopDMA();
+}
+
+/**
+ * @brief Chain the next transfer of the rectangle once the previous one is complete
+ * @note The ISR only waits for the last byte to be shifted out (at most a byte transfer time)
+ */
+void panelDMAIRQhandler(void) {
+    const displayTransfer_e status = displayBusGetDMAStatus();
+    displayBusClearDMAFlags();
+
+    //if DMA error, stop chaining (the flush is dropped by the main loop)
+    if(status == DISPLAY_TRANSFER_FAILED) {
+        displayBusEnableDMAInterrupts(0);
+        transferStatus = DISPLAY_TRANSFER_FAILED;
+        return;
+    }
+
+    if((status != DISPLAY_TRANSFER_DONE) || (transferStatus != DISPLAY_TRANSFER_BUSY)) {
+        return;
+    }
+
+    //wait for the last byte to be shifted out before the data/command pin changes
+    displayBusWaitLastByte();
+
+    //if page commands sent, send the page data
+    if(transferPhase == COMMAND) {
+        transferPhase = DATA;
+        displayBusStartDMA(&transferFrame[transferPage][transferWindow.column], transferWindow.width, DATA);
+        return;
+    }
+
+    //if pages remaining, send the next page commands
+    transferPage++;
+    if(transferPage < (uint8_t)(transferWindow.page + transferWindow.nbPages)) {
+        sendPageCommands();
+        return;
+    }
+
+    displayBusEnableDMAInterrupts(0);
+    transferStatus = DISPLAY_TRANSFER_DONE;
+}
+
+/**
+ * @brief Send the page and column commands of the current page via DMA
+ */
+static void sendPageCommands(void) {
+    const uint8_t column = (uint8_t)(transferWindow.column + PANEL_COLUMN_OFFSET);
+
+    pageCommands[0] = (uint8_t)(ADDR_MODE_PAGESTART | transferPage);
+    pageCommands[1] = (uint8_t)(LOW_COL_START_ADDR | (column & COLUMN_NIBBLE_MASK));
+    pageCommands[2] = (uint8_t)(HIGH_COL_START_ADDR | (column >> COLUMN_HIGH_SHIFT));
+
+    transferPhase = COMMAND;
+    displayBusStartDMA(pageCommands, NB_PAGE_COMMANDS, COMMAND);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file panelSSD1306.c
+ * @brief Implement the display backend of the SSD1306 and SSD1309 panels
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Both controllers support the horizontal addressing mode : once the column and page window is set,
+ *  the RAM pointer wraps to the next page by itself, and a full-width rectangle is sent in a single DMA transfer.
+ *  Narrower rectangles are not contiguous in the frame buffer, and are sent one page at a time.
+ *  The SSD1309 only differs by its external VCC (no charge pump).
+ *
+ * @note Datasheet : https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf
+ */
+#include <stdint.h>
+#include "SSD1306_registers.h"
+#include "displayBackend.h"
+#include "displayBus.h"
+#include "errorstack.h"
+#include "widgets.h"
+
+enum {
+    PANEL_WIDTH       = 128U,  ///< Number of columns of the panel RAM (same as the frame buffer)
+#if defined(DISPLAY_PANEL_SSD1309)
+    NB_INIT_REGISTERS = 5U,  ///< Number of registers set at initialisation
+#else
+    NB_INIT_REGISTERS = 6U,  ///< Number of registers set at initialisation
+#endif
+};
+
+_Static_assert((uint32_t)PANEL_WIDTH == (uint32_t)WIDGET_SCREEN_WIDTH, "The panel RAM must match the frame buffer");
+
+/**
+ * @brief Enumeration of the function IDs of the SSD1306 backend
+ */
+typedef enum {
+    CONFIGURE = 1,   ///< panelConfigure()
+    START_TRANSFER,  ///< panelStartTransfer()
+} panelFunctionCodes_e;
+
+/**
+ * @brief Initialise the SSD1306 registers and turn the display on
+ * @note Initialisation taken from PDF p. 64 (Application Example), the values which don't change from reset
+ *       values aren't modified
+ *
+ * @return Success
+ * @retval 1	Error while setting a configuration register
+ */
+errorCode_u panelConfigure(void) {
+    const uint8_t initCommands[NB_INIT_REGISTERS][3] = {
+        ///< Array used to initialise the registers
+        {   HARDWARE_CONFIG, 1, SSD_PIN_CONFIG_ALT | SSD_COM_REMAP_DISABLE},
+        {  MEMORY_ADDR_MODE, 1,                        SSD_HORIZONTAL_ADDR},
+        {  CONTRAST_CONTROL, 1,                       SSD_CONTRAST_HIGHEST},
+        {CLOCK_DIVIDE_RATIO, 1,   SSD_CLOCK_FREQ_MID | SSD_CLOCK_DIVIDER_1},
+#if !defined(DISPLAY_PANEL_SSD1309)
+        {CHG_PUMP_REGULATOR, 1,                        SSD_ENABLE_CHG_PUMP},
+#endif
+        {        DISPLAY_ON, 0,                                       0x00},
+    };
+
+    //TODO test for max oscillator frequency
+    for(uint8_t i = 0; i < (uint8_t)NB_INIT_REGISTERS; i++) {
+        errorCode_u result = displayBusSendCommand(initCommands[i][0], &initCommands[i][2], initCommands[i][1]);
+        if(isError(result)) {
+            return (pushErrorCode(result, CONFIGURE, 1));
+        }
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Set the window of the rectangle to send, and start sending it via DMA
+ * @note Only full-width rectangles are sent at once, narrower ones being sent one page at a time
+ *
+ * @param[in] frame Frame buffer
+ * @param[in] window Rectangle of the frame buffer to send
+ * @param[out] nbPagesStarted Number of pages of the rectangle being sent
+ * @return Success
+ * @retval 1 Error while setting the columns
+ * @retval 2 Error while setting the pages
+ */
+errorCode_u panelStartTransfer(const uint8_t frame[][WIDGET_SCREEN_WIDTH], const widgetRectangle_t* window,
+                               uint8_t* nbPagesStarted) {
+    const uint8_t nbPages         = (window->width == (uint8_t)PANEL_WIDTH ? window->nbPages : 1U);
+    const uint8_t limitColumns[2] = {window->column, (uint8_t)(window->column + window->width - 1U)};
+    const uint8_t limitPages[2]   = {window->page, (uint8_t)(window->page + nbPages - 1U)};
+    errorCode_u   result;
+
+    result = displayBusSendCommand(COLUMN_ADDRESS, limitColumns, 2);
+    if(isError(result)) {
+        return (pushErrorCode(result, START_TRANSFER, 1));
+    }
+
+    result = displayBusSendCommand(PAGE_ADDRESS, limitPages, 2);
+    if(isError(result)) {
+        return (pushErrorCode(result, START_TRANSFER, 2));
+    }
+
+    displayBusStartDMA(&frame[window->page][window->column], (uint16_t)(window->width * nbPages), DATA);
+    *nbPagesStarted = nbPages;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Get the state of the transfer started
+ *
+ * @return State of the DMA transfer
+ */
+displayTransfer_e panelGetTransferStatus(void) {
+    return (displayBusGetDMAStatus());
+}
+
+/**
+ * @brief Stop the transfer (done, failed or in timeout)
+ */
+void panelStopTransfer(void) {
+    displayBusStopDMA();
+}
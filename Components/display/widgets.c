@@ -0,0 +1,463 @@
+/**
+ * @file widgets.c
+ * @brief Implement retained-mode widgets drawn in a frame buffer, with damage tracking
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Screens are described by constant layout tables stored in flash, each widget keeping its state in RAM.
+ *  Setting a value only stores it : widgets are rendered in the frame buffer when the screen is idle,
+ *  and only if their value changed since the latest render.
+ *  Each render adds the exact rectangle it modified to a damage list, so only those bytes are sent to the screen.
+ */
+#include "widgets.h"
+#include <stdint.h>
+#include "blit.h"
+#include "numbersVerdana16.h"
+
+enum {
+    PAGE_HEIGHT        = 8U,     ///< Number of pixel rows in a page
+    NUMBER_SIGN        = 0,      ///< Index of the sign in the number characters
+    NUMBER_TENS        = 1U,     ///< Index of the tens in the number characters
+    NUMBER_UNITS       = 2U,     ///< Index of the units in the number characters
+    NUMBER_DOT         = 3U,     ///< Index of the decimal dot in the number characters
+    NUMBER_TENTHS      = 4U,     ///< Index of the tenths in the number characters
+    NUMBER_DEGREES     = 5U,     ///< Index of the degrees sign in the number characters
+    DIVIDE_10          = 10U,    ///< 10 Divider (used for magic numbers warnings)
+    DIVIDE_100         = 100U,   ///< 100 Divider (used for magic numbers warnings)
+    BAR_FILLED         = 0xFFU,  ///< Byte drawn in the filled part of a bar
+    BAR_OUTLINE_TOP    = 0x01U,  ///< Byte drawn on the top page of the empty part of a bar
+    BAR_OUTLINE_BOTTOM = 0x80U,  ///< Byte drawn on the bottom page of the empty part of a bar
+};
+
+/**
+ * @brief Widget renderer prototype
+ *
+ * @param[in] widget Layout of the widget
+ * @param[in] state State of the widget
+ * @param[out] frame Frame buffer in which render the widget
+ * @param[in,out] damage Damage list to which add the rectangle modified
+ */
+typedef void (*widgetRenderer)(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                               widgetDamage_t* damage);
+
+static void    renderNumber(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                            widgetDamage_t* damage);
+static void    renderIcon(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                          widgetDamage_t* damage);
+static void    renderBar(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                         widgetDamage_t* damage);
+static void    renderLabel(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                           widgetDamage_t* damage);
+static void    renderChart(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                           widgetDamage_t* damage);
+static void    drawBitmap(const widgetRectangle_t* area, const uint8_t* bitmap, uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void    formatNumber(int16_t valueTenths, uint8_t characters[]);
+static int16_t clampValue(const widget_t* widget, int16_t value);
+static uint8_t scaleValue(const widget_t* widget, int16_t value, uint8_t range);
+static uint8_t areOverlapping(const widgetRectangle_t* first, const widgetRectangle_t* second);
+static void    uniteRectangles(widgetRectangle_t* rectangle, const widgetRectangle_t* other);
+
+/**
+ * @brief Renderers of each widget type
+ */
+static const widgetRenderer RENDERERS[NB_WIDGET_TYPES] = {
+    [WIDGET_NUMBER] = renderNumber,
+    [WIDGET_ICON]   = renderIcon,
+    [WIDGET_BAR]    = renderBar,
+    [WIDGET_LABEL]  = renderLabel,
+    [WIDGET_CHART]  = renderChart,
+};
+
+/**
+ * @brief Set the value of a widget
+ * @note The widget is rendered at the next widgetsRender() call, only if the value changed (or if a chart)
+ *
+ * @param[in] screen Screen containing the widget
+ * @param index Index of the widget in the screen layout
+ * @param value Value to display
+ */
+void widgetsSetValue(const widgetScreen_t* screen, uint8_t index, int16_t value) {
+    if(index >= screen->nbWidgets) {
+        return;
+    }
+
+    const widget_t* widget = &screen->widgets[index];
+    widgetState_t*  state  = &screen->states[index];
+    state->value           = value;
+    state->hasValue        = 1;
+
+    //if chart, scroll it by adding the sample (row of the pixel, 0 being the top one)
+    if((widget->type == WIDGET_CHART) && widget->history && widget->area.width) {
+        const uint8_t lowestRow      = (uint8_t)((widget->area.nbPages * PAGE_HEIGHT) - 1U);
+        widget->history[state->head] = (uint8_t)(lowestRow - scaleValue(widget, value, lowestRow));
+        state->head                  = (uint8_t)((state->head + 1U) % widget->area.width);
+        state->pending               = 1;
+        if(state->nbSamples < widget->area.width) {
+            state->nbSamples++;
+        }
+    }
+}
+
+/**
+ * @brief Mark all the widgets of a screen as to be rendered again (e.g. after its background has been drawn)
+ *
+ * @param[in] screen Screen to invalidate
+ */
+void widgetsInvalidate(const widgetScreen_t* screen) {
+    for(uint8_t index = 0; index < screen->nbWidgets; index++) {
+        screen->states[index].drawn = 0;
+    }
+}
+
+/**
+ * @brief Render all the widgets of a screen which changed since their latest render
+ *
+ * @param[in] screen Screen to render
+ * @param[out] frame Frame buffer in which render the widgets
+ * @param[in,out] damage Damage list to which add the rectangles modified
+ */
+void widgetsRender(const widgetScreen_t* screen, uint8_t frame[][WIDGET_SCREEN_WIDTH], widgetDamage_t* damage) {
+    for(uint8_t index = 0; index < screen->nbWidgets; index++) {
+        const widget_t* widget = &screen->widgets[index];
+        widgetState_t*  state  = &screen->states[index];
+
+        //labels need no value, other widgets are only shown once they have one
+        if((widget->type >= NB_WIDGET_TYPES) || (!state->hasValue && (widget->type != WIDGET_LABEL))) {
+            continue;
+        }
+
+        //if already drawn and nothing changed, skip
+        if(state->drawn && (state->value == state->rendered) && !state->pending) {
+            continue;
+        }
+
+        (*RENDERERS[widget->type])(widget, state, frame, damage);
+        state->rendered = state->value;
+        state->drawn    = 1;
+        state->pending  = 0;
+    }
+}
+
+/**
+ * @brief Add a modified rectangle to a damage list
+ * @details
+ *  Rectangles overlapping the new one are merged with it, so no byte is ever sent twice.
+ *  If the list is full, the new rectangle is merged with the latest one.
+ *
+ * @param[in,out] damage Damage list
+ * @param[in] rectangle Rectangle modified
+ */
+void widgetsAddDamage(widgetDamage_t* damage, const widgetRectangle_t* rectangle) {
+    widgetRectangle_t merged = *rectangle;
+    uint8_t           index  = 0;
+
+    if(!merged.nbPages || !merged.width) {
+        return;
+    }
+
+    //absorb all the rectangles overlapping the new one (starting over each time it grows)
+    while(index < damage->nbRectangles) {
+        if(!areOverlapping(&damage->rectangles[index], &merged)) {
+            index++;
+            continue;
+        }
+
+        uniteRectangles(&merged, &damage->rectangles[index]);
+        damage->nbRectangles--;
+        damage->rectangles[index] = damage->rectangles[damage->nbRectangles];
+        index                     = 0;
+    }
+
+    //if list full, merge with the latest rectangle and add the union again (it may overlap others)
+    if(damage->nbRectangles >= (uint8_t)WIDGET_MAX_DAMAGE) {
+        damage->nbRectangles--;
+        uniteRectangles(&merged, &damage->rectangles[damage->nbRectangles]);
+        widgetsAddDamage(damage, &merged);
+        return;
+    }
+
+    damage->rectangles[damage->nbRectangles] = merged;
+    damage->nbRectangles++;
+}
+
+/********************************************************************************************************************************************/
+/********************************************************************************************************************************************/
+
+/**
+ * @brief Render a number widget, redrawing only the characters which changed
+ *
+ * @param[in] widget Layout of the widget
+ * @param[in] state State of the widget
+ * @param[out] frame Frame buffer in which render the widget
+ * @param[in,out] damage Damage list to which add the rectangle modified
+ */
+static void renderNumber(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                         widgetDamage_t* damage) {
+    uint8_t characters[WIDGET_NUMBER_NB_CHARS];
+    uint8_t previous[WIDGET_NUMBER_NB_CHARS];
+    uint8_t first = WIDGET_NUMBER_NB_CHARS;
+    uint8_t last  = 0;
+
+    formatNumber(clampValue(widget, state->value), characters);
+    formatNumber(clampValue(widget, state->rendered), previous);
+
+    //copy the Verdana bitmap of each character which changed (all of them if not drawn yet)
+    for(uint8_t character = 0; character < (uint8_t)WIDGET_NUMBER_NB_CHARS; character++) {
+        if(state->drawn && (characters[character] == previous[character])) {
+            continue;
+        }
+
+        const widgetRectangle_t glyph = {
+            widget->area.page,
+            VERDANA_NB_PAGES,
+            (uint8_t)(widget->area.column + (character * VERDANA_CHAR_WIDTH)),
+            VERDANA_CHAR_WIDTH,
+        };
+        blitCopy(frame, &glyph, &verdana_16ptNumbers[characters[character]][0][0]);
+
+        if(character < first) {
+            first = character;
+        }
+        last = character;
+    }
+
+    //if same characters (e.g. both values clamped), nothing modified
+    if(first >= (uint8_t)WIDGET_NUMBER_NB_CHARS) {
+        return;
+    }
+
+    const widgetRectangle_t modified = {
+        widget->area.page,
+        VERDANA_NB_PAGES,
+        (uint8_t)(widget->area.column + (first * VERDANA_CHAR_WIDTH)),
+        (uint8_t)((last - first + 1U) * VERDANA_CHAR_WIDTH),
+    };
+    widgetsAddDamage(damage, &modified);
+}
+
+/**
+ * @brief Render an icon widget (erased if the value does not select a bitmap)
+ *
+ * @param[in] widget Layout of the widget
+ * @param[in] state State of the widget
+ * @param[out] frame Frame buffer in which render the widget
+ * @param[in,out] damage Damage list to which add the rectangle modified
+ */
+static void renderIcon(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                       widgetDamage_t* damage) {
+    const uint8_t* bitmap = (void*)0;
+
+    if(widget->bitmaps && (state->value >= 0) && (state->value < (int16_t)widget->nbBitmaps)) {
+        bitmap = widget->bitmaps[state->value];
+    }
+
+    drawBitmap(&widget->area, bitmap, frame);
+    widgetsAddDamage(damage, &widget->area);
+}
+
+/**
+ * @brief Render a bar widget, redrawing only the columns between the previous and the new bar length
+ *
+ * @param[in] widget Layout of the widget
+ * @param[in] state State of the widget
+ * @param[out] frame Frame buffer in which render the widget
+ * @param[in,out] damage Damage list to which add the rectangle modified
+ */
+static void renderBar(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                      widgetDamage_t* damage) {
+    const uint8_t length   = scaleValue(widget, state->value, widget->area.width);
+    const uint8_t previous = scaleValue(widget, state->rendered, widget->area.width);
+    const uint8_t lastPage = (uint8_t)(widget->area.nbPages - 1U);
+    uint8_t       from     = 0;
+    uint8_t       to       = widget->area.width;
+
+    //if already drawn, only the columns between both lengths change
+    if(state->drawn) {
+        from = (length < previous ? length : previous);
+        to   = (length < previous ? previous : length);
+    }
+
+    //fill the columns up to the bar length
+    if(from < length) {
+        const widgetRectangle_t filled = {
+            widget->area.page,
+            widget->area.nbPages,
+            (uint8_t)(widget->area.column + from),
+            (uint8_t)((to < length ? to : length) - from),
+        };
+        blitFill(frame, &filled, BAR_FILLED);
+    }
+
+    //erase the columns beyond, keeping the outline on the top and bottom pages
+    if(to > length) {
+        const uint8_t     start = (from > length ? from : length);
+        widgetRectangle_t empty = {widget->area.page, widget->area.nbPages, (uint8_t)(widget->area.column + start),
+                                   (uint8_t)(to - start)};
+        blitClear(frame, &empty);
+
+        empty.nbPages = 1U;
+        blitFill(frame, &empty, (uint8_t)(BAR_OUTLINE_TOP | (lastPage ? 0 : BAR_OUTLINE_BOTTOM)));
+        if(lastPage) {
+            empty.page = (uint8_t)(empty.page + lastPage);
+            blitFill(frame, &empty, BAR_OUTLINE_BOTTOM);
+        }
+    }
+
+    const widgetRectangle_t modified = {
+        widget->area.page,
+        widget->area.nbPages,
+        (uint8_t)(widget->area.column + from),
+        (uint8_t)(to - from),
+    };
+    widgetsAddDamage(damage, &modified);
+}
+
+/**
+ * @brief Render a label widget
+ *
+ * @param[in] widget Layout of the widget
+ * @param[in] state State of the widget (unused)
+ * @param[out] frame Frame buffer in which render the widget
+ * @param[in,out] damage Damage list to which add the rectangle modified
+ */
+static void renderLabel(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                        widgetDamage_t* damage) {
+    (void)state;
+
+    drawBitmap(&widget->area, (widget->bitmaps && widget->nbBitmaps ? widget->bitmaps[0] : (void*)0), frame);
+    widgetsAddDamage(damage, &widget->area);
+}
+
+/**
+ * @brief Render a chart widget, the oldest sample on the left
+ *
+ * @param[in] widget Layout of the widget
+ * @param[in] state State of the widget
+ * @param[out] frame Frame buffer in which render the widget
+ * @param[in,out] damage Damage list to which add the rectangle modified
+ */
+static void renderChart(const widget_t* widget, const widgetState_t* state, uint8_t frame[][WIDGET_SCREEN_WIDTH],
+                        widgetDamage_t* damage) {
+    const uint8_t oldest = (state->nbSamples < widget->area.width ? 0 : state->head);
+
+    if(!widget->history) {
+        return;
+    }
+
+    //erase the chart, then plot one pixel per sample
+    blitClear(frame, &widget->area);
+    for(uint8_t column = 0; column < state->nbSamples; column++) {
+        const uint8_t row  = widget->history[(oldest + column) % widget->area.width];
+        const uint8_t page = (uint8_t)(row / PAGE_HEIGHT);
+
+        if(page < widget->area.nbPages) {
+            frame[widget->area.page + page][widget->area.column + column] = (uint8_t)(1U << (row % PAGE_HEIGHT));
+        }
+    }
+
+    widgetsAddDamage(damage, &widget->area);
+}
+
+/**
+ * @brief Copy a bitmap in an area of the frame buffer
+ *
+ * @param[in] area Area to fill
+ * @param[in] bitmap Bitmap to copy, page by page (NULL to erase the area)
+ * @param[out] frame Frame buffer
+ */
+static void drawBitmap(const widgetRectangle_t* area, const uint8_t* bitmap, uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    if(bitmap) {
+        blitCopy(frame, area, bitmap);
+    } else {
+        blitClear(frame, area);
+    }
+}
+
+/**
+ * @brief Get the Verdana characters of a value in tenths (±XX.X°)
+ *
+ * @param valueTenths Value to format (between -999 and 999)
+ * @param[out] characters Indexes of the Verdana characters
+ */
+static void formatNumber(int16_t valueTenths, uint8_t characters[]) {
+    characters[NUMBER_SIGN] = INDEX_PLUS;
+    if(valueTenths < 0) {
+        characters[NUMBER_SIGN] = INDEX_MINUS;
+        valueTenths             = (int16_t)-valueTenths;
+    }
+
+    characters[NUMBER_TENS]    = (uint8_t)((valueTenths / DIVIDE_100) % DIVIDE_10);
+    characters[NUMBER_UNITS]   = (uint8_t)((valueTenths / DIVIDE_10) % DIVIDE_10);
+    characters[NUMBER_DOT]     = INDEX_DOT;
+    characters[NUMBER_TENTHS]  = (uint8_t)(valueTenths % DIVIDE_10);
+    characters[NUMBER_DEGREES] = INDEX_DEG;
+}
+
+/**
+ * @brief Clamp a value between the minimum and maximum of a widget
+ *
+ * @param[in] widget Layout of the widget
+ * @param value Value to clamp
+ * @return Clamped value
+ */
+static int16_t clampValue(const widget_t* widget, int16_t value) {
+    if(value < widget->minimum) {
+        return (widget->minimum);
+    }
+
+    if(value > widget->maximum) {
+        return (widget->maximum);
+    }
+
+    return (value);
+}
+
+/**
+ * @brief Scale a value from the widget minimum and maximum to a number of pixels
+ *
+ * @param[in] widget Layout of the widget
+ * @param value Value to scale
+ * @param range Number of pixels matching the maximum
+ * @return Number of pixels (between 0 and range)
+ */
+static uint8_t scaleValue(const widget_t* widget, int16_t value, uint8_t range) {
+    const int32_t span = (int32_t)widget->maximum - (int32_t)widget->minimum;
+
+    if(span <= 0) {
+        return (0);
+    }
+
+    return ((uint8_t)((((int32_t)clampValue(widget, value) - (int32_t)widget->minimum) * range) / span));
+}
+
+/**
+ * @brief Check if two rectangles share at least one byte
+ *
+ * @param[in] first First rectangle
+ * @param[in] second Second rectangle
+ * @retval 0 Rectangles apart
+ * @retval 1 Rectangles overlapping
+ */
+static uint8_t areOverlapping(const widgetRectangle_t* first, const widgetRectangle_t* second) {
+    return ((first->page < (second->page + second->nbPages)) && (second->page < (first->page + first->nbPages))
+            && (first->column < (second->column + second->width)) && (second->column < (first->column + first->width)));
+}
+
+/**
+ * @brief Grow a rectangle so that it also contains another one
+ *
+ * @param[in,out] rectangle Rectangle to grow
+ * @param[in] other Rectangle to include
+ */
+static void uniteRectangles(widgetRectangle_t* rectangle, const widgetRectangle_t* other) {
+    const uint8_t lastPage    = (uint8_t)(rectangle->page + rectangle->nbPages);
+    const uint8_t lastColumn  = (uint8_t)(rectangle->column + rectangle->width);
+    const uint8_t otherPage   = (uint8_t)(other->page + other->nbPages);
+    const uint8_t otherColumn = (uint8_t)(other->column + other->width);
+
+    rectangle->page    = (other->page < rectangle->page ? other->page : rectangle->page);
+    rectangle->column  = (other->column < rectangle->column ? other->column : rectangle->column);
+    rectangle->nbPages = (uint8_t)((otherPage > lastPage ? otherPage : lastPage) - rectangle->page);
+    rectangle->width   = (uint8_t)((otherColumn > lastColumn ? otherColumn : lastColumn) - rectangle->column);
+}
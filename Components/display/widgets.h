@@ -0,0 +1,85 @@
+#ifndef WIDGETS_H_INCLUDED
+#define WIDGETS_H_INCLUDED
+#include <stdint.h>
+#include "numbersVerdana16.h"
+
+enum {
+    WIDGET_SCREEN_WIDTH    = 128U,  ///< Number of columns in a frame buffer
+    WIDGET_NB_PAGES        = 8U,    ///< Number of pages (8 pixel rows each) in a frame buffer
+    WIDGET_MAX_DAMAGE      = 8U,    ///< Maximum number of damage rectangles tracked between two flushes
+    WIDGET_NUMBER_NB_CHARS = 6U,    ///< Number of characters printed by a number widget (sign, tens, units, dot, tenths, °)
+    WIDGET_NUMBER_WIDTH    = (WIDGET_NUMBER_NB_CHARS * VERDANA_CHAR_WIDTH),  ///< Number of columns of a number widget
+};
+
+/**
+ * @brief Enumeration of the widget types
+ */
+typedef enum {
+    WIDGET_NUMBER = 0,  ///< Signed value in tenths, printed as ±XX.X° in Verdana 16
+    WIDGET_ICON,        ///< Bitmap selected by the value (erased if out of the bitmaps)
+    WIDGET_BAR,         ///< Horizontal bar filled proportionally to the value
+    WIDGET_LABEL,       ///< Static bitmap, drawn once when the screen is shown
+    WIDGET_CHART,       ///< Strip chart scrolling one column per value set
+    NB_WIDGET_TYPES
+} widgetType_e;
+
+/**
+ * @brief Structure representing a rectangle in the frame buffer, in pages and columns
+ */
+typedef struct {
+    uint8_t page;     ///< First page
+    uint8_t nbPages;  ///< Number of pages
+    uint8_t column;   ///< First column
+    uint8_t width;    ///< Number of columns
+} widgetRectangle_t;
+
+/**
+ * @brief Structure representing the layout of a widget (stored in flash)
+ */
+typedef struct {
+    widgetType_e          type;       ///< Type of widget
+    widgetRectangle_t     area;       ///< Area occupied in the frame buffer
+    int16_t               minimum;    ///< Minimum value displayed (number, bar and chart)
+    int16_t               maximum;    ///< Maximum value displayed (number, bar and chart)
+    const uint8_t* const* bitmaps;    ///< Bitmaps of an icon (NULL entries erase), or of a label (first entry)
+    uint8_t               nbBitmaps;  ///< Number of bitmaps
+    uint8_t*              history;    ///< Chart samples buffer in RAM (one byte per column)
+} widget_t;
+
+/**
+ * @brief Structure holding the state of a widget (stored in RAM)
+ */
+typedef struct {
+    int16_t value;      ///< Latest value set
+    int16_t rendered;   ///< Value currently drawn in the frame buffer
+    uint8_t hasValue;   ///< Flag indicating a value has been set at least once
+    uint8_t drawn;      ///< Flag indicating the widget is currently drawn in the frame buffer
+    uint8_t pending;    ///< Flag indicating a chart sample has been added since the latest render
+    uint8_t head;       ///< Index of the next chart sample to write
+    uint8_t nbSamples;  ///< Number of chart samples stored
+} widgetState_t;
+
+/**
+ * @brief Structure representing a screen, as a list of widgets drawn on a background
+ */
+typedef struct {
+    const widget_t* widgets;     ///< Layout table of the widgets
+    widgetState_t*  states;      ///< States of the widgets (one per layout entry)
+    uint8_t         nbWidgets;   ///< Number of widgets
+    const uint8_t*  background;  ///< Full frame drawn under the widgets (NULL if blank)
+} widgetScreen_t;
+
+/**
+ * @brief Structure holding the rectangles modified in the frame buffer since the latest flush
+ */
+typedef struct {
+    widgetRectangle_t rectangles[WIDGET_MAX_DAMAGE];  ///< Rectangles modified (never overlapping)
+    uint8_t           nbRectangles;                   ///< Number of rectangles modified
+} widgetDamage_t;
+
+void widgetsSetValue(const widgetScreen_t* screen, uint8_t index, int16_t value);
+void widgetsInvalidate(const widgetScreen_t* screen);
+void widgetsRender(const widgetScreen_t* screen, uint8_t frame[][WIDGET_SCREEN_WIDTH], widgetDamage_t* damage);
+void widgetsAddDamage(widgetDamage_t* damage, const widgetRectangle_t* rectangle);
+
+#endif
@@ -4,6 +4,11 @@
  * @author Gilles Henrard
  * @date 05/08/2024
  *
+ * @details
+ *  Each LSM6DSO is handled through its own context (chip select, interrupt pin, state machine and filter),
+ *  all of them sharing the same SPI bus (see LSM6DSO_bus.c). Measurement bursts are read via DMA, one device at a time,
+ *  and the angles of all the devices are then fused together.
+ *
  * @note Additional information can be found in :
  *   - Datasheet : https://www.st.com/resource/en/datasheet/lsm6dso.pdf
  *   - AN5192 (always-on 3-axis accelerometer and 3-axis gyroscope) : https://www.st.com/resource/en/application_note/an5192-lsm6dso-alwayson-3axis-accelerometer-and-3axis-gyroscope-stmicroelectronics.pdf
@@ -11,38 +16,125 @@
  *   - DT0058 (Design tip) : https://www.st.com/resource/en/design_tip/dt0058-computing-tilt-measurement-and-tiltcompensated-ecompass-stmicroelectronics.pdf
  */
 #include "LSM6DSO.h"
-#include <math.h>
 #include <stdint.h>
+#include "LSM6DSO_bus.h"
+#include "LSM6DSO_clocksync.h"
+#include "LSM6DSO_fifo.h"
+#include "LSM6DSO_filter.h"
+#if defined(LSM6DSO_FILTER_MONITOR)
+#include "LSM6DSO_monitor.h"
+#endif
 #include "LSM6DSO_registers.h"
+#include "LSM6DSO_selftest.h"
 #include "errorstack.h"
+#include "fastmath.h"
+#include "fusion.h"
 #include "main.h"
+#include "mounting.h"
 #include "stm32f103xb.h"
+#include "stm32f1xx_ll_exti.h"
 #include "stm32f1xx_ll_gpio.h"
-#include "stm32f1xx_ll_spi.h"
 #include "systick.h"
+#if defined(LSM6DSO_TILT_ALARM)
+#include "tiltalarm.h"
+#endif
+
+#if defined(LSM6DSO_FIFO_CONTINUOUS) || defined(LSM6DSO_FIFO_COMPRESSED)
+#define LSM6DSO_USE_FIFO  ///< Measurements batched in the FIFO instead of read at each data-ready event
+#endif
+
+#if defined(LSM6DSO_FIFO_COMPRESSED)
+#define FIFO_EMB_COMPRESSION   EMB_FIFO_COMPRESSION_ENABLE                            ///< FIFO compression feature
+#define FIFO_CTRL2_COMPRESSION (FIFO_COMPRESSION_RUNTIME | FIFO_UNCOMPRESSED_32_BDR)  ///< FIFO compression setting
+#else
+#define FIFO_EMB_COMPRESSION   EMB_FIFO_COMPRESSION_DISABLE  ///< FIFO compression feature
+#define FIFO_CTRL2_COMPRESSION FIFO_UNCOMPRESSED_DISABLED    ///< FIFO compression setting
+#endif
 
 #define ANGLE_DELTA_MINIMUM       0.05F        ///< Minimum value for angle differences to be noticed
 #define RADIANS_TO_DEGREES_TENTHS 572.957795F  ///< Ratio between radians and tenths of degrees (= 10 * (180°/PI))
 #define BASE_TEMPERATURE          25.0F        ///< Temperature at which the LSM6DSO temperature reading will give 0
+#define UPSIDE_DOWN_THRESHOLD_MG  500.0F       ///< Screen vertical acceleration beyond which the screen is upside down
+#define MAX_DISAGREEMENT_RAD      0.0349066F   ///< Maximum angle difference between two devices (2°)
+#define GRAVITY_FILTER_ALPHA      0.02F        ///< Proportion of a new sample in the low-passed gravity vector
+#define GRAVITY_DELTA_MINIMUM_MG  5.0F         ///< Minimum gravity difference (in mG) for the slope to be noticed
+#define PREDICTION_MIN_RATE_RADPS 0.00872665F  ///< Euler rate under which the angles are not predicted (0.5°/s)
+#define MICROSECONDS_TO_SECONDS   1.0e-6F      ///< Ratio between microseconds and seconds
+#define SAMPLE_PERIOD_S           0.00240385F  ///< Nominal time period between two samples (LSM6DSO config. at 416Hz)
+#define RADIANS_TO_MICRORADIANS   1.0e6F       ///< Ratio between radians and micro-radians
+#define MOTION_MIN_RATE_RADPS     0.0174533F   ///< Euler rate beyond which the device is moving (1°/s)
+#define MOTION_MIN_ANGLE_RAD      0.00872665F  ///< Angle drift beyond which the device has moved (0.5°)
+
+#if defined(LSM6DSO_PIPELINE_PROFILING)
+//accumulate the CPU cycles spent in a pipeline stage
+#define PIPELINE_PROFILE(device, stage, startCycles) \
+    ((device)->telemetry.stageCycles[stage] += getCycleCount() - (startCycles))
+#define PIPELINE_CYCLES() (getCycleCount())  ///< Current CPU cycle count, read before each pipeline stage
+#else
+#define PIPELINE_PROFILE(device, stage, startCycles) ((void)(startCycles))  ///< Pipeline stages not profiled
+#define PIPELINE_CYCLES()                            (0U)                   ///< Pipeline stages not profiled
+#endif
+
 enum {
+#if defined(LSM6DSO_TAP_CONTROL)
+    NB_TAP_REG           = 7U,                          ///< Number of registers configuring the tap engine
+    NB_SCRUB_TAP_REG     = MD2_CFG - TAP_CFG0 + 1,      ///< Number of tap engine registers read back by the scrub
+#else
+    NB_TAP_REG           = 0,                           ///< Number of registers configuring the tap engine
+#endif
     BOOT_TIME_MS         = 10U,                         ///< Number of milliseconds to wait for the MEMS to boot
-    SPI_TIMEOUT_MS       = 10U,                         ///< Number of milliseconds beyond which SPI is in timeout
     TIMEOUT_MS           = 1000U,                       ///< Max number of milliseconds to wait for the device ID
+    SOFTWARE_RESET_MS    = 2U,                          ///< Number of milliseconds to wait for a software reset
+    NB_SELFTEST_REG      = 4U,                          ///< Number of registers written at each self-test step
     REGISTER_VALUE_ALIGN = 8,                           ///< Alignment of the registerValue_t struct
-    NB_REGISTERS_TO_READ = LSM6_NB_OUT_REGISTERS + 2U,  ///< Numbers of data registers to read
-    NB_INIT_REG          = 9U,                          ///< Number of initialisation registers
+    DEVICE_STRUCT_ALIGN  = 8,                           ///< Alignment of the lsm6dso_t struct
+    NB_REGISTERS_TO_READ = LSM6_NB_OUT_REGISTERS + 4U,  ///< Numbers of registers to read (status to accelerometer)
+#if defined(LSM6DSO_USE_FIFO)
+    NB_INIT_REG          = 16U + NB_TAP_REG,            ///< Number of initialisation registers
+    FIFO_WATERMARK_WORDS = 8U,                          ///< Number of FIFO words triggering the INT1 interrupt
+    FIFO_MAX_WORDS       = 32U,                         ///< Maximum number of FIFO words read in a single burst
+    FIFO_QUEUE_SIZE      = 6U,                          ///< Number of decoded samples waiting for their counterpart
+    NB_FIFO_STATUS_REG   = 2U,                          ///< Number of FIFO status registers
+#else
+    NB_INIT_REG          = 10U + NB_TAP_REG,            ///< Number of initialisation registers
+#endif
+    NB_HOLD_REG          = 2U,                          ///< Number of registers written to hold the values
+    SPIKE_HISTORY_SIZE   = 3U,                          ///< Number of accelerometer samples used by the median filter
+    AXL_GATE_MIN_LSB     = 13934,                       ///< Minimum acceleration magnitude accepted (850mG at 0.061mG/LSB)
+    AXL_GATE_MAX_LSB     = 18852,                       ///< Maximum acceleration magnitude accepted (1150mG at 0.061mG/LSB)
+    NB_ANGLES            = NB_AXIS - 1,                 ///< Number of angles computed (roll and pitch)
+    FILTERS_DELAY_US     = 3000U,                       ///< Group delay of the LSM6DSO digital filters (LPF1/LPF2)
+    MAX_PREDICTION_US    = 50000U,                      ///< Maximum latency compensated by the prediction
+    SCRUB_PERIOD_MS      = 250U,                        ///< Period at which the control registers are checked
+    NB_SCRUB_REG         = CTRL10_C - FIFO_CTRL1 + 1,   ///< Number of registers read back by the scrub
+    NB_BUS_CHECK_REG     = WHO_AM_I - FIFO_CTRL1 + 1,   ///< Number of registers read to check the bus (up to WHO_AM_I)
+    BUS_CHECK_PATTERN1   = 0xA5U,                       ///< Pattern written in FIFO_CTRL1 to check the bus
+    BUS_CHECK_PATTERN2   = 0x5AU,                       ///< Pattern written in COUNTER_BDR_REG2 to check the bus
+    BUS_CHECK_READS      = 16U,                         ///< Number of consecutive reads to succeed at a bus speed
+    DOUBLE_TAP_WINDOW_MS = 550U,                        ///< Time after which a single tap is not part of a double tap
+    CLOCK_SYNC_PERIOD_MS = 1000U,                       ///< Period at which a timestamp pair is captured
+    NB_TIMESTAMP_REG     = 4U,                          ///< Number of timestamp registers
 };
 
 /**
  * @brief Enumeration of all the function ID used in errors
  */
 typedef enum {
-    READ_REGISTERS = 1,  ///< readRegisters() function
-    WRITE_REGISTER,      ///< writeRegister() function
-    CHECK_DEVICE_ID,     ///< stateWaitingDeviceID() state
-    CONFIGURING,         ///< stateConfiguring() state
-    DROPPING,            ///< stateIgnoringSamples() state
-    MEASURING,           ///< stMeasuring() state
+    CHECK_DEVICE_ID = 1,   ///< stateWaitingDeviceID() state
+    CONFIGURING,           ///< stateConfiguring() state
+    DROPPING,              ///< stateIgnoringSamples() state
+    MEASURING,             ///< stMeasuring() state
+    READING_BURST,         ///< stateReadingBurst() state
+    ENTERING_HOLD,         ///< stateEnteringHold() state
+    UPDATING,              ///< lsm6dsoUpdate() function
+    SELF_TESTING,          ///< self-test states
+    CALIBRATING_MOUNTING,  ///< lsm6dsoCalibrateMounting() function
+    SCRUBBING,             ///< stateScrubbingRegisters() state
+    CALIBRATING_BUS,       ///< stateCalibratingBus() state
+    READING_TAP,           ///< readTapSource() function
+    SYNCHRONISING_CLOCK,   ///< synchroniseClock() function
+    MONITORING_FILTER,     ///< checkFilterMonitor() function
+    REPAIRING_REGISTERS,   ///< repairRegisters() function
 } LSM6DSOfunction_e;
 
 /**
@@ -53,184 +145,372 @@ typedef struct {
     uint8_t           value;       ///< Value to write
 } __attribute__((aligned(REGISTER_VALUE_ALIGN))) registerValue_t;
 
+/**
+ * @brief Indexes of the values in the 16-bits burst array (starting at STATUS_REG)
+ */
+enum {
+    STATUS_INDEX = 0,         ///< Status register (LSB) and reserved register (MSB)
+    TEMPERATURE_INDEX,        ///< Temperature value
+    GYROSCOPE_INDEX,          ///< First gyroscope value (X axis)
+    ACCELEROMETER_INDEX = 5,  ///< First accelerometer value (X axis)
+};
+
 /**
  * @brief Union regrouping 8-bits and 16-bits arrays
  * @details
- *  This allows reading all the accelerometer and gyroscope values at once, and convert them to 16 bit instantly
+ *  This allows reading the status register and all the accelerometer and gyroscope values at once,
+ *  and convert them to 16 bit instantly
  */
 typedef union {
     uint8_t registers8bits[NB_REGISTERS_TO_READ];                   ///< 8-bits registers array
     int16_t values16bits[((uint8_t)(NB_REGISTERS_TO_READ) >> 1U)];  ///< 16-bits values array
 } rawValues_u;
 
+typedef struct lsm6dso lsm6dso_t;
+
 /**
  * @brief State machine state prototype
  *
+ * @param device Device for which run the state
  * @return Error code of the state
  */
-typedef errorCode_u (*lsm6dsoState)();
+typedef errorCode_u (*lsm6dsoState)(lsm6dso_t* device);
 
-//machine state
-static errorCode_u stateWaitingBoot();
-static errorCode_u stateWaitingDeviceID();
-static errorCode_u stateConfiguring();
-static errorCode_u stateIgnoringSamples();
-static errorCode_u stateMeasuring();
-static errorCode_u stateHoldingValues();
-static errorCode_u stateError();
+/**
+ * @brief Structure holding the context of a single LSM6DSO
+ */
+struct lsm6dso {
+    lsm6dsoChipSelect_t chipSelect;              ///< Chip select of the device on the SPI bus
+    GPIO_TypeDef*       intPort;                 ///< INT1 GPIO port
+    uint32_t            intPin;                  ///< INT1 GPIO pin
+    uint8_t             rotated180;              ///< Flag indicating the device is mounted rotated by 180° around Z
+    lsm6dsoState        state;                   ///< State machine current state
+    systick_t           timer_ms;                ///< Timer used in various states of the LSM6DSO (in ms)
+    systick_t           scrubTimer_ms;           ///< Timer used to schedule the control registers scrub (in ms)
+    systick_t           syncTimer_ms;            ///< Timer used to schedule the timestamp pairs capture (in ms)
+    uint8_t             samplesToIgnore;         ///< Number of samples to ignore after change of ODR or power mode
+    uint8_t             prescalerTested;         ///< SPI prescaler index checked by the bus calibration
+    uint8_t             newAngles;               ///< Flag indicating the filtered angles have been updated
+    uint8_t             upsideDown;              ///< Flag indicating the screen is held upside down
+    uint8_t             historyIndex;            ///< Index of the oldest sample in the accelerometer history
+    uint8_t             historyFilled;           ///< Flag indicating the accelerometer history holds valid samples
+    rawValues_u         burst;                   ///< Buffer in which the DMA burst is received
+    float               temperature_degC;        ///< Temperature of the LSM6DSO in [°C]
+    float               angles_rad[NB_ANGLES];   ///< Latest angles measured and filtered in [rad]
+    float               rates_radps[NB_ANGLES];  ///< Latest Euler angle rates in [rad/s]
+    cyclecount_t        sampleTick;              ///< CPU cycles count at which the latest angles have been computed
+    float               gravity_mG[NB_AXIS];     ///< Low-passed gravity vector in [mG]
+    float               samplePeriod_s;          ///< Sample period corrected with the sensor clock rate in [s]
+    clockSync_t         clockSync;               ///< Regression between the sensor timestamps and the MCU time
+    int16_t             history_LSB[NB_AXIS][SPIKE_HISTORY_SIZE];  ///< Latest raw accelerometer samples
+    lsm6dsoTelemetry_t  telemetry;               ///< Counters regarding the measurements stream
+    selfTest_t          selfTest;                ///< Context of the self-test procedure
+    uint8_t             selfTestResult;          ///< Result of the self-test (lsm6dsoSelfTest_e flags)
+#if defined(LSM6DSO_FILTER_MONITOR)
+    filterMonitor_t monitor;  ///< Filter steps checked against the libm reference in idle time
+#endif
+#if defined(LSM6DSO_TILT_ALARM)
+    tiltAlarm_t           tiltAlarm;      ///< Tilt alarm state of each axis
+    volatile cyclecount_t dataReadyTick;  ///< CPU cycles count at the latest INT1 data-ready edge (EXTI interrupt)
+#endif
+#if defined(LSM6DSO_USE_FIFO)
+    uint8_t       fifoWords[FIFO_MAX_WORDS][FIFO_WORD_NB_BYTES];  ///< Buffer in which the FIFO words are received
+    uint16_t      nbFifoWords;                                     ///< Number of FIFO words being read
+    fifoDecoder_t decoder;                                         ///< Decompression context of the FIFO stream
+    int16_t       queue_LSB[FIFO_TEMPERATURE][FIFO_QUEUE_SIZE][NB_AXIS];  ///< Samples waiting for their counterpart
+    uint8_t       queueHead[FIFO_TEMPERATURE];                     ///< Index of the oldest sample in each queue
+    uint8_t       queueCount[FIFO_TEMPERATURE];                    ///< Number of samples in each queue
+#endif
+} __attribute__((aligned(DEVICE_STRUCT_ALIGN)));
 
-//registers read/write functions
-static errorCode_u writeRegister(LSM6DSOregister_e registerNumber, uint8_t value);
-static errorCode_u readRegisters(LSM6DSOregister_e firstRegister, uint8_t value[], uint8_t size);
+/**
+ * @brief Structure holding a sample flowing through the measurement pipeline stages
+ */
+typedef struct {
+    lsm6dso_t* device;                     ///< Device which measured the sample
+    int16_t*   values;                     ///< Raw values, laid out as in the registers from STATUS_REG
+    float      accelerometer_mG[NB_AXIS];  ///< Accelerometer values in [mG]
+    float      gyroscope_radps[NB_AXIS];   ///< Gyroscope values in [rad/s]
+    uint8_t    status;                     ///< Status register value (channels updated)
+    uint8_t    accelerometerValid;         ///< Flag indicating new and valid accelerometer values
+} pipelineSample_t;
 
-static inline uint8_t dataReady(void);
-static void           complementaryFilter(const float accelerometer_mG[], const float gyroscope_radps[],
-                                          float filteredAngles_rad[]);
+//machine state
+static errorCode_u stateWaitingBoot(lsm6dso_t* device);
+static errorCode_u stateWaitingDeviceID(lsm6dso_t* device);
+static errorCode_u stateCalibratingBus(lsm6dso_t* device);
+static errorCode_u stateStartingSelfTest(lsm6dso_t* device);
+static errorCode_u stateApplyingSelfTestStep(lsm6dso_t* device);
+static errorCode_u stateSamplingSelfTest(lsm6dso_t* device);
+static errorCode_u stateConfiguring(lsm6dso_t* device);
+#if !defined(LSM6DSO_USE_FIFO)
+static errorCode_u stateIgnoringSamples(lsm6dso_t* device);
+#endif
+static errorCode_u stateMeasuring(lsm6dso_t* device);
+static errorCode_u stateReadingBurst(lsm6dso_t* device);
+static errorCode_u stateScrubbingRegisters(lsm6dso_t* device);
+static errorCode_u stateEnteringHold(lsm6dso_t* device);
+static errorCode_u stateHoldingValues(lsm6dso_t* device);
+static errorCode_u stateError(lsm6dso_t* device);
+
+static errorCode_u repairRegisters(const lsm6dso_t* device, LSM6DSOregister_e firstRegister, const uint8_t values[],
+                                   uint8_t nbValues, uint8_t* nbMismatches);
+
+static inline uint8_t  dataReady(const lsm6dso_t* device);
+#if defined(LSM6DSO_TAP_CONTROL)
+static errorCode_u readTapSource(lsm6dso_t* device);
+#endif
+static errorCode_u     synchroniseClock(lsm6dso_t* device);
+#if defined(LSM6DSO_FILTER_MONITOR)
+static errorCode_u checkFilterMonitor(lsm6dso_t* device);
+#endif
+static void            complementaryFilter(const float accelerometer_mG[], const float gyroscope_radps[],
+                                           float filteredAngles_rad[], float eulerRates_radps[],
+                                           uint8_t accelerometerValid, float dtPeriod_sec);
+#if defined(LSM6DSO_PREDICTION)
+static float predictionOffset(axis_e axis);
+#endif
+static void            processSample(lsm6dso_t* device, uint8_t status, int16_t values[]);
+#if defined(LSM6DSO_USE_FIFO)
+static void processFifo(lsm6dso_t* device);
+static void queueFifoSample(lsm6dso_t* device, const fifoSample_t* sample);
+static void dequeueFifoSample(lsm6dso_t* device, fifoSensor_e sensor, int16_t values[]);
+#else
+static void processBurst(lsm6dso_t* device);
+#endif
+static void            updateUpsideDown(lsm6dso_t* device, float accelerometerY_mG);
+static void            updateGravity(lsm6dso_t* device, const float accelerometer_mG[]);
+static void            getGravity(float gravity_mG[]);
+static inline int16_t  medianOf3(int16_t first, int16_t second, int16_t third);
+static inline int16_t  negateSaturated(int16_t value);
+static uint8_t         rejectSpikes(lsm6dso_t* device, int16_t accelerometer_LSB[]);
+static void            convertTemperature(lsm6dso_t* device, int16_t temperature_LSB);
+static void            convertGyroscope(const int16_t gyroscope_LSB[], float gyroscope_radps[]);
+static void            convertAccelerometer(const int16_t accelerometer_LSB[], float accelerometer_mG[]);
+
+//measurement pipeline stages (see LSM6DSO_pipeline.h)
+static inline void    runPipeline(pipelineSample_t* sample);
+static inline uint8_t stageAlignDevice(pipelineSample_t* sample);
+static inline uint8_t stageRotateMounting(pipelineSample_t* sample);
+static inline uint8_t stageConvertTemperature(pipelineSample_t* sample);
+static inline uint8_t stageRejectSpikes(pipelineSample_t* sample);
+static inline uint8_t stageConvertAccelerometer(pipelineSample_t* sample);
+static inline uint8_t stageDetectUpsideDown(pipelineSample_t* sample);
+static inline uint8_t stageFilterGravity(pipelineSample_t* sample);
+static inline uint8_t stageConvertGyroscope(pipelineSample_t* sample);
+static inline uint8_t stageComplementaryFilter(pipelineSample_t* sample);
+static inline uint8_t stageTiltAlarm(pipelineSample_t* sample);
+#if defined(LSM6DSO_TILT_ALARM)
+static inline void setTiltAlarm(lsm6dso_t* device, uint8_t raised);
+#endif
+
+//bus variables
+static uint8_t busPrescaler  = 0;  ///< SPI prescaler index used (PCLK / 2^(index + 1))
+static uint8_t busCalibrated = 0;  ///< Flag indicating a device already calibrated the bus speed
 
-//global variables
-static systick_t lsm6dsoTimer_ms = 0;  ///< Timer used in various states of the LSM6DSO (in ms)
+/**
+ * @brief Registers values written at configuration, also used as the shadow configuration checked by the scrub
+ */
+static const registerValue_t initialisationArray[NB_INIT_REG] = {
+    {   CTRL3_C, LSM6_SOFTWARE_RESET | LSM6_INT_ACTIVE_LOW}, //reboot MEMS memory and reset software
+#if defined(LSM6DSO_USE_FIFO)
+    {                 FUNC_CFG_ACCESS,                       LSM6_ENABLE_EMB_FUNCT}, //access the embedded functions registers
+    {(LSM6DSOregister_e)EMB_FUNC_EN_B,                        FIFO_EMB_COMPRESSION}, //enable/disable the FIFO compression
+    {                 FUNC_CFG_ACCESS,                      LSM6_DISABLE_FUNCTIONS}, //get back to the main registers
+    {                      FIFO_CTRL1,                        FIFO_WATERMARK_WORDS}, //set the FIFO threshold
+    {                      FIFO_CTRL2,                      FIFO_CTRL2_COMPRESSION}, //enable/disable the runtime compression
+    {                      FIFO_CTRL3,       FIFO_BDR_GY_416HZ | FIFO_BDR_XL_416HZ}, //batch the gyro. and accel. at 416Hz
+    {                      FIFO_CTRL4, FIFO_TEMP_BATCH_52HZ | FIFO_MODE_CONTINUOUS}, //temperature at 52Hz, continuous mode
+    {                       INT1_CTRL,                         INT1_FIFO_THRESHOLD}, //enable the FIFO threshold interrupt on INT1
+#else
+    {FIFO_CTRL4,                          FIFO_MODE_BYPASS}, //disable the FIFO (bypass mode)
+    { INT1_CTRL,                         INT1_AXL_DATA_RDY}, //enable the accelerometer DATA READY interrupt on INT1
+#endif
+#if defined(LSM6DSO_TAP_CONTROL)
+    {   TAP_CFG0,           TAP_LATCHED_CLEAR_ON_READ | TAP_XYZ_ENABLE}, //detect taps on all axis, latched until read
+    {   TAP_CFG1,                                  TAP_THRESHOLD_750MG}, //set the X axis tap threshold
+    {   TAP_CFG2,          TAP_INTERRUPTS_ENABLE | TAP_THRESHOLD_750MG}, //enable the tap interrupts, Y axis threshold
+    { TAP_THS_6D,                                  TAP_THRESHOLD_750MG}, //set the Z axis tap threshold
+    {   INT_DUR2, TAP_DURATION_538MS | TAP_QUIET_29MS | TAP_SHOCK_58MS}, //set the tap timings
+    {WAKE_UP_THS,                                TAP_SINGLE_AND_DOUBLE}, //detect both single and double taps
+    {    MD2_CFG,                    INT2_SINGLE_TAP | INT2_DOUBLE_TAP}, //route the tap events on INT2
+#endif
+    {  CTRL8_XL,         AXL_NO_HP_FILTER | AXL_LPF2_ODR_4}, //disable accererometer HP filter and set LP2 cutoff to ODR/4
+    {  CTRL1_XL,     LSM6_ODR_416HZ | LSM6_AXL_LPF2_ENABLE}, //set accelerometer in high-perf. mode + enable LPF 2
+    {   CTRL7_G,     GYR_HPF_ENABLE | GYR_HPF_CUTOFF_65MHZ}, //enable the gyroscope HP filter with 16mHz cutoff freq.
+    {   CTRL4_C,                           GYR_LPF1_ENABLE}, //enable the gyroscope LP1 filter
+    {   CTRL6_C,                   GYR_LPF1_CUTOFF_120_3HZ}, //set the gyroscope LPF1 cutoff frequency to 136.6Hz
+    {   CTRL2_G,           LSM6_ODR_416HZ | GYR_FS_125_DPS}, //set the gyroscope in high-performance mode and sens. to 125dps
+    {  CTRL10_C,                     LSM6_TIMESTAMP_ENABLE}, //enable the timestamp counter (sensor clock sync.)
+};
 
 //state variables
-static SPI_TypeDef* spiHandle                   = (void*)0;          ///< SPI handle used by the LSM6DSO device
-static lsm6dsoState state                       = stateWaitingBoot;  ///< State machine current state
-static uint8_t     accelerometerSamplesToIgnore = 0;  ///< Number of samples to ignore after change of ODR or power mode
-static errorCode_u result;                            ///< Variables used to store error codes
-static float       anglesAtZeroing_rad[NB_AXIS];      ///< Accelerometer values at time of zeroing in [m/s²]
-static float       latestAngles_rad[NB_AXIS - 1] = {0.0F, 0.0F};      ///< Latest angles measured and filtered in [rad]
-float              temperature_degC              = BASE_TEMPERATURE;  ///< Temperature of the LSM6DSO in [°C]
-
-/********************************************************************************************************************************************/
-/********************************************************************************************************************************************/
+static errorCode_u result;                              ///< Variables used to store error codes
+static uint8_t     holdRequested = 0;                   ///< Flag indicating the devices are to be held
+static float       anglesAtZeroing_rad[NB_AXIS];        ///< Accelerometer values at time of zeroing in [m/s²]
+static float       latestAngles_rad[NB_ANGLES] = {0.0F, 0.0F};  ///< Latest fused angles in [rad]
+static uint8_t     devicesDisagree             = 0;  ///< Flag indicating the devices measure different angles
+static float       slopeGravity_mG[NB_AXIS];         ///< Gravity vector at the last slope change in [mG]
+static float       latestRates_radps[NB_ANGLES] = {0.0F, 0.0F};  ///< Latest fused Euler angle rates in [rad/s]
+static cyclecount_t latestSampleTick = 0;  ///< CPU cycles count at which the latest fused angles have been computed
+static uint32_t     renderLatency_us = 0;  ///< Time needed to get the angles on the screen once printed in [us]
+#if defined(LSM6DSO_TAP_CONTROL)
+static volatile uint8_t tapPending        = 0;         ///< Flag indicating INT2 signalled a tap event
+static uint8_t          singleTapWaiting  = 0;         ///< Flag indicating a single tap may still become a double tap
+static systick_t        singleTapTimer_ms = 0;         ///< Tick at which the latest single tap has been read
+static lsm6dsoTap_e     latestTap         = TAP_NONE;  ///< Latest tap gesture not yet consumed
+#endif
+#if defined(LSM6DSO_TILT_ALARM)
+static uint8_t tiltAlarmDevices = 0;  ///< Devices for which the tilt alarm is raised (one bit per device)
 
 /**
- * @brief Initialise the LSM6DSO
- *
- * @param handle	SPI handle used
- * @returns 		Success
+ * @brief EXTI lines on which the INT1 data-ready edges of each device are timestamped
  */
-errorCode_u lsm6dsoInitialise(const SPI_TypeDef* handle) {
-    spiHandle = (SPI_TypeDef*)handle;
-    LL_SPI_Disable(spiHandle);
-
-    return (ERR_SUCCESS);
-}
+static const uint32_t dataReadyExtiLines[NB_LSM6DSO] = {
+    [LSM6DSO_PRIMARY] = LSM6DSO_INT1_EXTI_Line,
+#if defined(LSM6DSO_DUAL_SENSOR)
+    [LSM6DSO_SECONDARY] = LSM6DSO2_INT1_EXTI_Line,
+#endif
+};
+#endif
 
 /**
- * @brief Run the LSM6DSO state machine
- * @returns Current state return code
+ * @brief Contexts of all the LSM6DSO devices on the SPI bus
+ * @note When a single device is used, its chip select is driven by the SPI NSS pin
  */
-errorCode_u lsm6dsoUpdate() {
-    return ((*state)());
-}
+static lsm6dso_t devices[NB_LSM6DSO] = {
+#if defined(LSM6DSO_DUAL_SENSOR)
+    [LSM6DSO_PRIMARY] = {.chipSelect       = {LSM6DSO_CS_GPIO_Port, LSM6DSO_CS_Pin},
+                         .intPort          = LSM6DSO_INT1_GPIO_Port,
+                         .intPin           = LSM6DSO_INT1_Pin,
+                         .rotated180       = 0,
+                         .state            = stateWaitingBoot,
+                         .temperature_degC = BASE_TEMPERATURE,
+                         .samplePeriod_s   = SAMPLE_PERIOD_S},
+    [LSM6DSO_SECONDARY] = {.chipSelect       = {LSM6DSO2_CS_GPIO_Port, LSM6DSO2_CS_Pin},
+                           .intPort          = LSM6DSO2_INT1_GPIO_Port,
+                           .intPin           = LSM6DSO2_INT1_Pin,
+                           .rotated180       = 1,
+                           .state            = stateWaitingBoot,
+                           .temperature_degC = BASE_TEMPERATURE,
+                           .samplePeriod_s   = SAMPLE_PERIOD_S},
+#else
+    [LSM6DSO_PRIMARY] = {.chipSelect       = {(void*)0, LSM6DSO_CS_Pin},
+                         .intPort          = LSM6DSO_INT1_GPIO_Port,
+                         .intPin           = LSM6DSO_INT1_Pin,
+                         .rotated180       = 0,
+                         .state            = stateWaitingBoot,
+                         .temperature_degC = BASE_TEMPERATURE,
+                         .samplePeriod_s   = SAMPLE_PERIOD_S},
+#endif
+};
+
+/********************************************************************************************************************************************/
+/********************************************************************************************************************************************/
 
 /**
- * @brief Read several registers on the LSM6DSO
+ * @brief Initialise the LSM6DSO devices
  *
- * @param firstRegister Number of the first register to read
- * @param[out] value Registers value array
- * @param size Number of registers to read
- * @return   Success
- * @retval 1 SPI handle or value buffer NULL
- * @retval 2 Timeout
+ * @param handle	    SPI handle used
+ * @param dma           DMA handle used
+ * @param rxChannel     DMA channel used to receive data from the SPI
+ * @param txChannel     DMA channel used to send data to the SPI
+ * @returns 		    Success
  */
-static errorCode_u readRegisters(LSM6DSOregister_e firstRegister, uint8_t value[], uint8_t size) {
-    static const uint8_t SPI_RX_FILLER = 0xFFU;  ///< Value to send as a filler while receiving multiple bytes
-
-    //if no bytes to read, success
-    if(!size) {
-        return ERR_SUCCESS;
-    }
-
-    //make sure neither the handle nor the buffer are NULL
-    if(!spiHandle || !value) {
-        return (createErrorCode(READ_REGISTERS, 1, ERR_CRITICAL));
+errorCode_u lsm6dsoInitialise(const SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t rxChannel, uint32_t txChannel) {
+    //make sure to disable LSM6DSO SPI communication, and keep the default bus speed until calibrated
+    lsm6dsoBusInitialise((SPI_TypeDef*)handle, dma, rxChannel, txChannel);
+    busPrescaler = lsm6dsoBusGetPrescaler();
+
+    //release all chip selects
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        lsm6dsoBusReleaseDevice(&devices[device].chipSelect);
     }
 
-    //set timeout timer and enable SPI
-    systick_t lsm6dsoSPITimer_ms = getSystick();
-    LL_SPI_Enable(spiHandle);
-    uint8_t* iterator = value;
-
-    //send the read request and ignore the first byte received (reply to the write request)
-    LL_SPI_TransmitData8(spiHandle, LSM6_READ | (uint8_t)firstRegister);
-    while((!LL_SPI_IsActiveFlag_RXNE(spiHandle)) && !isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {};
-    *iterator = LL_SPI_ReceiveData8(spiHandle);
-
-    //receive the bytes to read
-    do {
-        //send a filler byte to keep the SPI clock running, to receive the next byte
-        LL_SPI_TransmitData8(spiHandle, SPI_RX_FILLER);
-
-        //wait for data to be available, and read it
-        while((!LL_SPI_IsActiveFlag_RXNE(spiHandle)) && lsm6dsoSPITimer_ms) {};
-        *iterator = LL_SPI_ReceiveData8(spiHandle);
-
-        iterator++;
-        size--;
-    } while(size && !isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS));
+    //load the mounting orientation calibrated
+    mountingInitialise();
 
-    //wait for transaction to be finished and clear Overrun flag
-    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {};
-    LL_SPI_ClearFlag_OVR(spiHandle);
-
-    //disable SPI
-    LL_SPI_Disable(spiHandle);
-
-    //if timeout, error
-    if(isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {
-        return (createErrorCode(READ_REGISTERS, 2, ERR_WARNING));
+#if defined(LSM6DSO_SELFTEST_WARM_SKIP)
+    //after a warm reset, reuse the self-test results cached (the MEMS stayed powered)
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        devices[device].selfTestResult = selfTestLoadCache(device);
     }
+#endif
 
     return (ERR_SUCCESS);
 }
 
 /**
- * @brief Write a single register on the LSM6DSO
- *
- * @param registerNumber Register number
- * @param value Register value
- * @return	 Success
- * @retval 1 No SPI handle specified
- * @retval 2 Register number out of range
- * @retval 3 Timeout
+ * @brief Run the state machines of all the LSM6DSO devices and fuse their angles
+ * @returns Success
+ * @retval 1 Error in the primary device state machine
+ * @retval 2 Error in the secondary device state machine
+ * @retval 3 Devices started disagreeing on the measured angles
+ * @retval 4 Error while reading the tap source
+ * @retval 5 Filter deviating from the reference model
  */
-static errorCode_u writeRegister(LSM6DSOregister_e registerNumber, uint8_t value) {
-    //if handle not specified, error
-    if(!spiHandle) {
-        return (createErrorCode(WRITE_REGISTER, 1, ERR_WARNING));
-    }
+errorCode_u lsm6dsoUpdate() {
+    errorCode_u updateResult = ERR_SUCCESS;
+    uint8_t     newAngles    = 0;
+
+    //run each device state machine, and keep the first error (layer code = device number)
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        result = (*devices[device].state)(&devices[device]);
+        if(isError(result) && !isError(updateResult)) {
+            updateResult = pushErrorCode(result, UPDATING, device + 1U);
+        }
 
-    //if register number above known or within the reserved range, error
-    if(registerNumber > MAX_REGISTER) {
-        return (createErrorCode(WRITE_REGISTER, 2, ERR_WARNING));
+        newAngles |= devices[device].newAngles;
+        devices[device].newAngles = 0;
     }
 
-    //set timeout timer and enable SPI
-    systick_t lsm6dsoSPITimer_ms = getSystick();
-    LL_SPI_Enable(spiHandle);
-
-    //send the write instruction
-    LL_SPI_TransmitData8(spiHandle, LSM6_WRITE | (uint8_t)registerNumber);
-
-    //wait for TX buffer to be ready and send value to write
-    while(!LL_SPI_IsActiveFlag_TXE(spiHandle) && !isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {};
-    if(!isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {
-        LL_SPI_TransmitData8(spiHandle, value);
+#if defined(LSM6DSO_TAP_CONTROL)
+    //if INT2 signalled a tap, read which one it was
+    result = readTapSource(&devices[LSM6DSO_PRIMARY]);
+    if(isError(result) && !isError(updateResult)) {
+        updateResult = pushErrorCode(result, UPDATING, 4);
     }
+#endif
+
+#if defined(LSM6DSO_FILTER_MONITOR)
+    //check the filter steps captured against the reference model, while the devices are idle
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        result = checkFilterMonitor(&devices[device]);
+        if(isError(result) && !isError(updateResult)) {
+            updateResult = pushErrorCode(result, UPDATING, 5);
+        }
+    }
+#endif
 
-    //wait for transaction to be finished and clear Overrun flag
-    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {};
-    LL_SPI_ClearFlag_OVR(spiHandle);
+    //if no new angles, nothing to fuse
+    if(!newAngles) {
+        return (updateResult);
+    }
 
-    //disable SPI
-    LL_SPI_Disable(spiHandle);
+#if defined(LSM6DSO_DUAL_SENSOR)
+    //average the angles of both devices and flag when they disagree
+    const uint8_t previouslyDisagreeing = devicesDisagree;
+    devicesDisagree = fuseAngles(devices[LSM6DSO_PRIMARY].angles_rad, devices[LSM6DSO_SECONDARY].angles_rad,
+                                 latestAngles_rad, NB_ANGLES, MAX_DISAGREEMENT_RAD);
+    if(devicesDisagree && !previouslyDisagreeing && !isError(updateResult)) {
+        updateResult = createErrorCode(UPDATING, 3, ERR_WARNING);
+    }
+#else
+    for(uint8_t angle = 0; angle < (uint8_t)NB_ANGLES; angle++) {
+        latestAngles_rad[angle] = devices[LSM6DSO_PRIMARY].angles_rad[angle];
+    }
+#endif
 
-    //if timeout, error
-    if(isTimeElapsed(lsm6dsoSPITimer_ms, SPI_TIMEOUT_MS)) {
-        return (createErrorCode(WRITE_REGISTER, 3, ERR_WARNING));
+    //average the Euler angle rates, used to predict the angles at display time
+    for(uint8_t angle = 0; angle < (uint8_t)NB_ANGLES; angle++) {
+        latestRates_radps[angle] = 0.0F;
+        for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+            latestRates_radps[angle] += devices[device].rates_radps[angle] / (float)NB_LSM6DSO;
+        }
     }
+    latestSampleTick = devices[LSM6DSO_PRIMARY].sampleTick;
 
-    return (ERR_SUCCESS);
+    return (updateResult);
 }
 
 /**
@@ -241,10 +521,10 @@ static errorCode_u writeRegister(LSM6DSOregister_e registerNumber, uint8_t value
  * @retval 1 New values are available
  */
 uint8_t lsm6dsoHasChanged(axis_e axis) {
-    static float previousAngles_rad[NB_AXIS - 1] = {0.0F, 0.0F};
-    uint8_t      comparison                      = 0;
+    static float previousAngles_rad[NB_ANGLES] = {0.0F, 0.0F};
+    uint8_t      comparison                    = 0;
 
-    if(fabsf(latestAngles_rad[axis] - previousAngles_rad[axis]) > ANGLE_DELTA_MINIMUM) {
+    if(MATH_ABS(latestAngles_rad[axis] - previousAngles_rad[axis]) > ANGLE_DELTA_MINIMUM) {
         previousAngles_rad[axis] = latestAngles_rad[axis];
         comparison               = 1;
     }
@@ -254,336 +534,1700 @@ uint8_t lsm6dsoHasChanged(axis_e axis) {
 
 /**
  * @brief Transpose a measurement to an angle in tenths of degrees with the Z axis
+ * @note If the prediction is enabled, the angle is extrapolated to the time at which it will be displayed
  *
  * @param axis Axis for which get the angle with the Z axis
  * @return Angle with the Z axis
  */
 int16_t getAngleDegreesTenths(axis_e axis) {
-    return ((int16_t)((latestAngles_rad[axis] + anglesAtZeroing_rad[axis]) * RADIANS_TO_DEGREES_TENTHS));
+    float angle_rad = latestAngles_rad[axis] + anglesAtZeroing_rad[axis];
+
+#if defined(LSM6DSO_PREDICTION)
+    angle_rad += predictionOffset(axis);
+#endif
+
+    return ((int16_t)(angle_rad * RADIANS_TO_DEGREES_TENTHS));
 }
 
 /**
- * @brief Set the measurements in relative mode and zero down the values
+ * @brief Get the latest tap gesture detected by the LSM6DSO tap engine, and consume it
+ * @details
+ *  A single tap is only reported once the double tap window elapsed without a second tap,
+ *  as the engine also signals the first tap of a double tap. This also gives the device time to settle.
+ *
+ * @return Latest tap gesture (TAP_NONE if none, or if the tap control is disabled)
  */
-void lsm6dsoZeroDown(void) {
-    anglesAtZeroing_rad[X_AXIS] = -latestAngles_rad[X_AXIS];
-    anglesAtZeroing_rad[Y_AXIS] = -latestAngles_rad[Y_AXIS];
+lsm6dsoTap_e lsm6dsoGetTap(void) {
+#if defined(LSM6DSO_TAP_CONTROL)
+    if(singleTapWaiting && isTimeElapsed(singleTapTimer_ms, DOUBLE_TAP_WINDOW_MS)) {
+        singleTapWaiting = 0;
+        return (TAP_SINGLE);
+    }
+
+    const lsm6dsoTap_e tap = latestTap;
+    latestTap              = TAP_NONE;
+    return (tap);
+#else
+    return (TAP_NONE);
+#endif
 }
 
+#if defined(LSM6DSO_TAP_CONTROL)
 /**
- * @brief Set the measurements in absolute mode (no zeroing compensation)
+ * @brief Flag a tap event signalled on INT2 (the source is read by the state machine once the bus is free)
+ * @warning This function must only be used in the INT2 EXTI interrupt handler and nowhere else
  */
-void lsm6dsoCancelZeroing(void) {
-    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
-        anglesAtZeroing_rad[axis] = 0;
-    }
+void lsm6dsoTapIRQhandler(void) {
+    LL_EXTI_ClearFlag_0_31(LSM6DSO_INT2_EXTI_Line);
+    tapPending = 1;
 }
+#endif
 
+#if defined(LSM6DSO_TILT_ALARM)
 /**
- * @brief Hold/release the MEMS by either turning the accelerometer/gyroscope off or by reconfiguring them
- * 
- * @param toHold Either 1 to hold the latest values or 0 to start taking measurements again
- * @return Success
- * @retval 1 Error while sending shut down instructions
+ * @brief Timestamp a data-ready edge on INT1, from which the tilt alarm latency is measured
+ * @note The samples are still polled by the state machine, the interrupt only captures the edge time
+ * @warning This function must only be used in the INT1 EXTI interrupt handlers and nowhere else
+ *
+ * @param device Device which signalled the edge
  */
-errorCode_u lsm6dsoHold(uint8_t toHold) {
-    const registerValue_t configurationArray[2] = {
-        {CTRL1_XL, LSM6_POWER_DOWN}, //set accelerometer in power down mode
-        { CTRL2_G, LSM6_POWER_DOWN}, //set gyroscope in power down mode
-    };
+void lsm6dsoDataReadyIRQhandler(lsm6dsoDevice_e device) {
+    LL_EXTI_ClearFlag_0_31(dataReadyExtiLines[device]);
+    devices[device].dataReadyTick = getCycleCount();
+}
+#endif
 
-    //if holding but already held, or releasing but not yet held : nothing to do
-    if(!(toHold ^ (uint8_t)(state == stateHoldingValues))) {
-        return (ERR_SUCCESS);
+/**
+ * @brief Check if the device is being moved
+ * @details
+ *  The device is moving if any Euler angle rate exceeds 1°/s, or if the angles slowly drifted by more than 0.5°
+ *  from the ones at the latest movement detected (too slow to be seen by the gyroscope).
+ *
+ * @retval 0 Device lying still
+ * @retval 1 Device moving
+ */
+uint8_t lsm6dsoIsMoving(void) {
+    static float restingAngles_rad[NB_ANGLES] = {0.0F, 0.0F};
+    uint8_t      moving                       = 0;
+
+    for(uint8_t angle = 0; angle < (uint8_t)NB_ANGLES; angle++) {
+        if((MATH_ABS(latestRates_radps[angle]) > MOTION_MIN_RATE_RADPS)
+           || (MATH_ABS(latestAngles_rad[angle] - restingAngles_rad[angle]) > MOTION_MIN_ANGLE_RAD)) {
+            moving = 1;
+        }
     }
 
-    if(toHold) {
-        //write all registers values from the configurationArray array
-        for(uint8_t i = 0; i < 2; i++) {
-            result = writeRegister(configurationArray[i].registerID, configurationArray[i].value);
-            if(isError(result)) {
-                state = stateError;
-                return (pushErrorCode(result, CONFIGURING, 1));
-            }
+    //if moving, use the current angles as the new resting position
+    if(moving) {
+        for(uint8_t angle = 0; angle < (uint8_t)NB_ANGLES; angle++) {
+            restingAngles_rad[angle] = latestAngles_rad[angle];
         }
-
-        state = stateHoldingValues;
-
-    } else {
-        //back to configuring state
-        state = stateConfiguring;
     }
 
-    return (ERR_SUCCESS);
+    return (moving);
 }
 
 /**
- * @brief Compute a complementary filter on accelerometer/gyroscope values
- * 
- * @param[in] accelerometer_mG    Array of acceleration values in [mG] on all axis
- * @param[in] gyroscope_radps       Array of gyroscope values  in [rad/s] on X and Y axis
- * @param[out] filteredAngles_rad     Array of final angle values in [rad] on X and Y axis
+ * @brief Set the time needed to get the angles on the screen once printed (used by the prediction)
+ *
+ * @param latency_us Render latency in microseconds (e.g. duration of a full frame transfer)
  */
-//NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-void complementaryFilter(const float accelerometer_mG[], const float gyroscope_radps[], float filteredAngles_rad[]) {
-    const float alpha                 = 0.02F;  ///< Proportion applied to the gyro. and accel. in the final result
-    const float dtPeriod_sec          = 0.00240385F;  ///< Time period between two updates (LSM6DSO config. at 416Hz)
-    const float GRAVITATION_MG        = 1000.0F;      ///< Grativation value in mG
-    float       AccelEstimatedX_rad   = 0.0F;         ///< Estimated accelerator angle on the X axis in [rad]
-    float       AccelEstimatedY_rad   = 0.0F;         ///< Estimated accelerator angle on the Y axis in [rad]
-    float       eulerAngleRateX_radps = 0.0F;  ///< Euler angle rate (with reference to Earth) around X axis in rad/s
-    float       eulerAngleRateY_radps = 0.0F;  ///< Euler angle rate (with reference to Earth) around Y axis in rad/s
-
-    //calculate the accelerometer angle estimations in °
-    AccelEstimatedX_rad = asinf(accelerometer_mG[X_AXIS] / GRAVITATION_MG);
-    AccelEstimatedY_rad = atanf(accelerometer_mG[Y_AXIS] / accelerometer_mG[Z_AXIS]);
+void lsm6dsoSetRenderLatency(uint32_t latency_us) {
+    renderLatency_us = latency_us;
+}
 
-    //Transform gyroscope rates (reference is the solid body) to Euler rates (reference is Earth)
-    eulerAngleRateX_radps =
-        gyroscope_radps[X_AXIS]
-        + (sinf(filteredAngles_rad[X_AXIS]) * tanf(filteredAngles_rad[Y_AXIS]) * gyroscope_radps[Y_AXIS])
-        + (cosf(filteredAngles_rad[X_AXIS]) * tanf(filteredAngles_rad[Y_AXIS]) * gyroscope_radps[Z_AXIS]);
+#if defined(LSM6DSO_PREDICTION)
+/**
+ * @brief Compute the angle travelled between the latest measurement and the expected display time
+ * @details
+ *  The latency is made of the digital filters delay, the age of the latest angles and the render latency.
+ *  To keep static readings exact, nothing is predicted when the Euler rate is near zero or when holding.
+ *
+ * @param axis Axis for which predict the angle
+ * @return Angle to add to the latest measurement in [rad]
+ */
+static float predictionOffset(axis_e axis) {
+    //if rate near zero or values held, no prediction
+    if(holdRequested || (MATH_ABS(latestRates_radps[axis]) < PREDICTION_MIN_RATE_RADPS)) {
+        return (0.0F);
+    }
 
-    eulerAngleRateY_radps = (cosf(filteredAngles_rad[X_AXIS]) * gyroscope_radps[Y_AXIS])
-                            - (sinf(filteredAngles_rad[X_AXIS]) * gyroscope_radps[Z_AXIS]);
+    //compute the total latency, and clamp it to avoid extrapolating stale angles
+    uint32_t latency_us = FILTERS_DELAY_US + getElapsed_us(latestSampleTick) + renderLatency_us;
+    if(latency_us > (uint32_t)MAX_PREDICTION_US) {
+        latency_us = MAX_PREDICTION_US;
+    }
 
-    //combine accelerometer estimates with Euler angle rates estimates
-    filteredAngles_rad[X_AXIS] =
-        ((1.0F - alpha) * (filteredAngles_rad[X_AXIS] + (eulerAngleRateX_radps * dtPeriod_sec)))
-        + (alpha * AccelEstimatedX_rad);
-    filteredAngles_rad[Y_AXIS] =
-        ((1.0F - alpha) * (filteredAngles_rad[Y_AXIS] + (eulerAngleRateY_radps * dtPeriod_sec)))
-        + (alpha * AccelEstimatedY_rad);
+    return (latestRates_radps[axis] * ((float)latency_us * MICROSECONDS_TO_SECONDS));
 }
+#endif
 
 /**
- * @brief Check if an INT1 event occurred
- * 
- * @retval 0 INT1 did not occur
- * @retval 1 INT1 occurred
+ * @brief Check if the screen is held upside down (gravity pulling towards its top, along the tool +Y axis)
+ * @note A hysteresis is applied to avoid toggling when the tool is laid flat
+ *
+ * @retval 0 Screen upright
+ * @retval 1 Screen upside down
  */
-static inline uint8_t dataReady(void) {
-    return (uint8_t)LL_GPIO_IsInputPinSet(LSM6DSO_INT1_GPIO_Port, LSM6DSO_INT1_Pin);
+uint8_t lsm6dsoIsUpsideDown(void) {
+    return (devices[LSM6DSO_PRIMARY].upsideDown);
 }
 
-/********************************************************************************************************************************************/
-/********************************************************************************************************************************************/
-
 /**
- * @brief State in which the program waits for the LSM6DSO to boot up
- * 
- * @return Success
+ * @brief Check if the low-passed gravity vector has changed enough to update the slope readout
+ *
+ * @retval 0 Slope did not change
+ * @retval 1 Slope changed
  */
-static errorCode_u stateWaitingBoot() {
-    //if timer elapsed, reset it and get to next state
-    if(isTimeElapsed(lsm6dsoTimer_ms, BOOT_TIME_MS)) {
-        lsm6dsoTimer_ms = getSystick();
-        state           = stateWaitingDeviceID;
+uint8_t lsm6dsoSlopeHasChanged(void) {
+    float   gravity_mG[NB_AXIS];
+    uint8_t comparison = 0;
+
+    getGravity(gravity_mG);
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        if(MATH_ABS(gravity_mG[axis] - slopeGravity_mG[axis]) > GRAVITY_DELTA_MINIMUM_MG) {
+            comparison = 1;
+        }
     }
 
-    return (ERR_SUCCESS);
+    //save the gravity vector only when changed, to notice slow drifts
+    if(comparison) {
+        for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+            slopeGravity_mG[axis] = gravity_mG[axis];
+        }
+    }
+
+    return (comparison);
 }
 
 /**
- * @brief State during which the Who Am I ID is checked
- * @attention This takes the 10ms boot time into account
- * @note If no correct manufacturer ID is read within 1 second, a timeout occurs
- * 
- * @retval 0 Success
- * @retval 1 Timeout while reading the manufacturer ID
- * @retval 2 Error while sending the read request
+ * @brief Get the total tilt of the device (angle between its Z axis and the vertical)
+ * @details
+ *  The tilt is computed from the low-passed gravity vector, regardless of zeroing,
+ *  as atan2(sqrt(X² + Y²), Z) with the fast math kernels
+ *
+ * @return Total tilt in tenths of degrees (0 to 1800)
  */
-static errorCode_u stateWaitingDeviceID() {
-    uint8_t deviceID = 0;
+uint16_t lsm6dsoGetTiltDegreesTenths(void) {
+    float gravity_mG[NB_AXIS];
+    float horizontal_mG = 0.0F;
 
-    //if 1s elapsed without reading the correct vendor ID, go error
-    if(isTimeElapsed(lsm6dsoTimer_ms, TIMEOUT_MS)) {
-        state = stateError;
-        return (createErrorCode(CHECK_DEVICE_ID, 1, ERR_CRITICAL));
-    }
-
-    //if unable to read device ID, error
-    result = readRegisters(WHO_AM_I, &deviceID, 1);
-    if(isError(result)) {
-        return (pushErrorCode(result, CHECK_DEVICE_ID, 2));
-    }
+    getGravity(gravity_mG);
 
-    //if invalid device ID, exit
-    if(deviceID != LSM6_WHOAMI) {
-        return (ERR_SUCCESS);
+    //compute the norm of the horizontal component (sqrt(x) = x / sqrt(x))
+    const float horizontalSquared =
+        (gravity_mG[X_AXIS] * gravity_mG[X_AXIS]) + (gravity_mG[Y_AXIS] * gravity_mG[Y_AXIS]);
+    if(horizontalSquared > 0.0F) {
+        horizontal_mG = horizontalSquared * fastInverseSqrt(horizontalSquared);
     }
 
-    //reset timeout timer and get to next state
-    state = stateConfiguring;
-    return (ERR_SUCCESS);
+    return ((uint16_t)(fastAtan2(horizontal_mG, gravity_mG[Z_AXIS]) * RADIANS_TO_DEGREES_TENTHS));
 }
 
 /**
- * @brief State in which the registers are configured in the LSM6DSO
- * 
- * @retval 0 Success
- * @retval 1 Error while writing a register
+ * @brief Get the direction in which the surface slopes down, in the device frame
+ * @note The accelerometer measures the reaction to gravity, so the downhill direction is opposite to its X/Y part
+ *
+ * @return Slope direction in tenths of degrees (-1800 to 1800), counter-clockwise from the device X axis
  */
-static errorCode_u stateConfiguring() {
-    const uint8_t         AXL_SAMPLES_TO_IGNORE = 2U;  ///< Number of samples to drop (see stateIgnoringSamples())
-    const registerValue_t initialisationArray[NB_INIT_REG] = {
-        {   CTRL3_C, LSM6_SOFTWARE_RESET | LSM6_INT_ACTIVE_LOW}, //reboot MEMS memory and reset software
-        {FIFO_CTRL4,                          FIFO_MODE_BYPASS}, //disable the FIFO (bypass mode)
-        { INT1_CTRL,                         INT1_AXL_DATA_RDY}, //enable the accelerometer DATA READY interrupt on INT1
-        {  CTRL8_XL,         AXL_NO_HP_FILTER | AXL_LPF2_ODR_4}, //disable accererometer HP filter and set LP2 cutoff to ODR/4
-        {  CTRL1_XL,     LSM6_ODR_416HZ | LSM6_AXL_LPF2_ENABLE}, //set accelerometer in high-perf. mode + enable LPF 2
-        {   CTRL7_G,     GYR_HPF_ENABLE | GYR_HPF_CUTOFF_65MHZ}, //enable the gyroscope HP filter with 16mHz cutoff freq.
-        {   CTRL4_C,                           GYR_LPF1_ENABLE}, //enable the gyroscope LP1 filter
-        {   CTRL6_C,                   GYR_LPF1_CUTOFF_120_3HZ}, //set the gyroscope LPF1 cutoff frequency to 136.6Hz
-        {   CTRL2_G,           LSM6_ODR_416HZ | GYR_FS_125_DPS}, //set the gyroscope in high-performance mode and sens. to 125dps
-    };
-
-    //write all registers values from the initialisation array
-    for(uint8_t i = 0; i < (uint8_t)NB_INIT_REG; i++) {
-        result = writeRegister(initialisationArray[i].registerID, initialisationArray[i].value);
-        if(isError(result)) {
-            state = stateError;
-            return (pushErrorCode(result, CONFIGURING, 1));
-        }
-    }
+int16_t lsm6dsoGetSlopeAzimuthDegreesTenths(void) {
+    float gravity_mG[NB_AXIS];
 
-    //set the number of samples to ignore after changing ODR and power mode
-    accelerometerSamplesToIgnore = AXL_SAMPLES_TO_IGNORE;
+    getGravity(gravity_mG);
+    return ((int16_t)(fastAtan2(-gravity_mG[Y_AXIS], -gravity_mG[X_AXIS]) * RADIANS_TO_DEGREES_TENTHS));
+}
 
-    lsm6dsoTimer_ms = getSystick();
-    state           = stateIgnoringSamples;
-    return (ERR_SUCCESS);
+/**
+ * @brief Check if the LSM6DSO devices disagree on the measured angles
+ *
+ * @retval 0 Devices agree (or single device)
+ * @retval 1 Angle difference between the devices above the maximum allowed
+ */
+uint8_t lsm6dsoDevicesDisagree(void) {
+    return (devicesDisagree);
 }
 
 /**
- * @brief State in which the first few samples measured are dropped
- * @note This is recommended in the document AN5192, Table 12
- * 
- * @retval 0 Success
- * @retval 1 No measurement received in a timely manner
- * @retval 2 Error while reading a register
+ * @brief Get the estimated drift of the clock of a device against the MCU clock
+ *
+ * @param device Device for which get the drift
+ * @return Drift in [ppm], positive when the sensor clock is slower than nominal (0 until estimated)
  */
-errorCode_u stateIgnoringSamples() {
-    //if 1s elapsed without getting any data ready interrupt, error
-    if(isTimeElapsed(lsm6dsoTimer_ms, TIMEOUT_MS)) {
-        state = stateError;
-        return (createErrorCode(DROPPING, 1, ERR_CRITICAL));
+int32_t lsm6dsoGetClockDrift_ppm(lsm6dsoDevice_e device) {
+    if(device >= NB_LSM6DSO) {
+        device = LSM6DSO_PRIMARY;
     }
 
-    //if no interrupt occurred, exit
-    if(!dataReady()) {
-        return (ERR_SUCCESS);
-    }
+    return (clockSyncGetDrift_ppm(&devices[device].clockSync));
+}
 
-    //read an accelerometer value to reset the latched interrupt
-    uint8_t dummyValue = 0;
-    result             = readRegisters(OUTX_H_A, &dummyValue, 1);
-    if(isError(result)) {
-        state = stateError;
-        return (pushErrorCode(result, DROPPING, 2));
+/**
+ * @brief Get the counters regarding the measurements stream of a device
+ *
+ * @param device Device for which get the counters
+ * @return Pointer to the telemetry counters
+ */
+const lsm6dsoTelemetry_t* lsm6dsoGetTelemetry(lsm6dsoDevice_e device) {
+    if(device >= NB_LSM6DSO) {
+        device = LSM6DSO_PRIMARY;
     }
 
-    //reset the timer
-    lsm6dsoTimer_ms = getSystick();
+    return (&devices[device].telemetry);
+}
 
-    //decrement the remaining amount to ignore and exit if still remaining
-    accelerometerSamplesToIgnore--;
-    if(accelerometerSamplesToIgnore) {
-        return (ERR_SUCCESS);
+/**
+ * @brief Get the result of the boot-time self-test of a device
+ *
+ * @param device Device for which get the result
+ * @return Result of the self-test (lsm6dsoSelfTest_e flags, SELFTEST_PENDING while running)
+ */
+uint8_t lsm6dsoGetSelfTestResult(lsm6dsoDevice_e device) {
+    if(device >= NB_LSM6DSO) {
+        device = LSM6DSO_PRIMARY;
     }
 
-    //get to measuring state
-    state = stateMeasuring;
-    return (ERR_SUCCESS);
+    return (devices[device].selfTestResult);
 }
 
 /**
- * @brief State in which the measurements are pulled from the sensor
- * 
+ * @brief Use the current position as the absolute reference, by calibrating the mounting orientation
+ * @note The tool must lie still on a level surface
+ *
  * @retval 0 Success
- * @retval 1 No measurement received in a timely manner
- * @retval 2 Error while reading the status register value
+ * @retval 1 Error while calibrating or storing the mounting orientation
  */
-static errorCode_u stateMeasuring() {
-    rawValues_u    LSBvalues = {0};              ///< Buffer in which read values will be stored
-    float          accelerometer_mG[NB_AXIS];    ///< Accelerometer values in [mG]
-    float          gyroscope_radps[NB_AXIS];     ///< Gyroscope values in [rad/s]
-    int16_t*       valueIterator    = (void*)0;  ///< Pointer used to browse through read values
-    static int16_t previousTemp_LSB = 0;         ///< Previously read temperature LSB values
+errorCode_u lsm6dsoCalibrateMounting(void) {
+    float gravity_mG[NB_AXIS];
 
-    //if 1s elapsed without getting any data ready interrupt, error
-    if(isTimeElapsed(lsm6dsoTimer_ms, TIMEOUT_MS)) {
-        state = stateError;
-        return (createErrorCode(MEASURING, 1, ERR_CRITICAL));
+    getGravity(gravity_mG);
+    result = mountingCalibrate(gravity_mG);
+    if(isError(result)) {
+        return (pushErrorCode(result, CALIBRATING_MOUNTING, 1));
     }
 
-    //if no interrupt occurred, exit
-    if(!dataReady()) {
-        return (ERR_SUCCESS);
+    //restart the spike rejection history, the previous samples being in the former axis
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        devices[device].historyFilled = 0;
     }
 
-    //reset the timer
-    lsm6dsoTimer_ms = getSystick();
+    return (ERR_SUCCESS);
+}
 
-    //read all temp/accelerometer/gyroscope values
-    result = readRegisters(OUT_TEMP_L, LSBvalues.registers8bits, NB_REGISTERS_TO_READ);
-    if(isError(result)) {
-        state = stateError;
-        return (pushErrorCode(result, MEASURING, 2));
-    }
+/**
+ * @brief Set the measurements in relative mode and zero down the values
+ */
+void lsm6dsoZeroDown(void) {
+    anglesAtZeroing_rad[X_AXIS] = -latestAngles_rad[X_AXIS];
+    anglesAtZeroing_rad[Y_AXIS] = -latestAngles_rad[Y_AXIS];
+}
 
-    //prepare iterator values
-    uint8_t axis  = 0;
-    valueIterator = LSBvalues.values16bits;
+/**
+ * @brief Get the angles compensated in relative mode
+ *
+ * @param[out] zeroing_rad Angles compensated on the X and Y axis in [rad] (0 in absolute mode)
+ */
+void lsm6dsoGetZeroing(float zeroing_rad[]) {
+    zeroing_rad[X_AXIS] = anglesAtZeroing_rad[X_AXIS];
+    zeroing_rad[Y_AXIS] = anglesAtZeroing_rad[Y_AXIS];
+}
 
-    //convert the temperature LSB values to °C
-    // Sparingly calculated since the temperature readings max. freq. is 52Hz
-    // AN5192 p.113 : temperature sensitivity = 256 [LSB/°C] = 0.00390625 [°C/LSB]
-    //                + LSB = 0 @ 25°C
-    if(*valueIterator != previousTemp_LSB) {
-        const float TEMPERATURE_SENSITIVITY = 0.00390625F;
-        temperature_degC                    = BASE_TEMPERATURE + ((float)(*valueIterator) * TEMPERATURE_SENSITIVITY);
-        previousTemp_LSB                    = *valueIterator;
-    }
-    valueIterator++;
+/**
+ * @brief Set the angles compensated in relative mode (e.g. restored after a power failure)
+ *
+ * @param[in] zeroing_rad Angles to compensate on the X and Y axis in [rad]
+ */
+void lsm6dsoRestoreZeroing(const float zeroing_rad[]) {
+    anglesAtZeroing_rad[X_AXIS] = zeroing_rad[X_AXIS];
+    anglesAtZeroing_rad[Y_AXIS] = zeroing_rad[Y_AXIS];
+}
 
-    //convert the gyroscope LSB values to rad/s
-    //datasheet p.9 : gyroscope sensitivity at 125°/s = 4.375[mdps/LSB]
-    //      to rad/s : (sensitivity / 1000[mdps/dps]) * (PI/180°) = 0.000076358155
-    const float GYR_SENSITIVITY_125DPS_RPS = 0.000076358155F;
-    for(axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
-        gyroscope_radps[axis] = (float)(*valueIterator) * GYR_SENSITIVITY_125DPS_RPS;
-        valueIterator++;
+/**
+ * @brief Set the measurements in absolute mode (no zeroing compensation)
+ */
+void lsm6dsoCancelZeroing(void) {
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        anglesAtZeroing_rad[axis] = 0;
     }
+}
 
-    //then convert the accelerometer LSB values to mG
-    //datasheet p.9 : accelerometer sensitivity at 2G = 0.061 [mG/LSB]
-    const float AXL_SENSITIVITY_2G = 0.061F;
-    for(axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
-        accelerometer_mG[axis] = (float)(*valueIterator) * AXL_SENSITIVITY_2G;
-        valueIterator++;
-    }
+/**
+ * @brief Hold/release the MEMS by either turning the accelerometer/gyroscope off or by reconfiguring them
+ * @note The devices are held as soon as they are done with their current measurement
+ *
+ * @param toHold Either 1 to hold the latest values or 0 to start taking measurements again
+ * @return Success
+ */
+errorCode_u lsm6dsoHold(uint8_t toHold) {
+    holdRequested = (toHold != 0);
+    return (ERR_SUCCESS);
+}
 
-    //apply a complementary filter on read values
-    complementaryFilter(accelerometer_mG, gyroscope_radps, latestAngles_rad);
+/**
+ * @brief Compute a complementary filter on accelerometer/gyroscope values, with the hot path math kernels
+ * @note The equations are defined once in LSM6DSO_filter.h, and shared with the filter monitor reference
+ *
+ * @param[in] accelerometer_mG    Array of acceleration values in [mG] on all axis
+ * @param[in] gyroscope_radps       Array of gyroscope values  in [rad/s] on X and Y axis
+ * @param[in,out] filteredAngles_rad  Array of final angle values in [rad] on X and Y axis
+ * @param[out] eulerRates_radps       Array of Euler angle rates in [rad/s] on X and Y axis
+ * @param accelerometerValid        0 if the accelerometer values are to be ignored (gyroscope only)
+ * @param dtPeriod_sec              Time period between two updates in [s]
+ */
+DEFINE_COMPLEMENTARY_FILTER(complementaryFilter, MATH_ASIN, MATH_ATAN, MATH_SIN, MATH_COS, MATH_TAN)
 
-    return (ERR_SUCCESS);
+#if !defined(LSM6DSO_USE_FIFO)
+/**
+ * @brief Process a burst received from a device
+ *
+ * @param device Device which received the burst
+ */
+static void processBurst(lsm6dso_t* device) {
+    processSample(device, device->burst.registers8bits[0], device->burst.values16bits);
 }
+#endif
 
 /**
- * @brief State in which the MEMS is shut down and the module waits for a user release
- * 
- * @return Success
+ * @brief Process a sample of a device
+ * @details
+ *  Only the channels flagged as updated in the status are processed.
+ *  The gyroscope is integrated only on genuinely new samples.
+ *
+ * @param device Device which measured the sample
+ * @param status Status register value (channels updated)
+ * @param[in,out] values Raw values, laid out as in the registers from STATUS_REG
  */
-static errorCode_u stateHoldingValues() {
-    return (ERR_SUCCESS);
+static void processSample(lsm6dso_t* device, uint8_t status, int16_t values[]) {
+    //if no channel has new data, nothing to process
+    if(!(status & (LSM6_AXL_DATA_AVAIL | LSM6_GYR_DATA_AVAIL | LSM6_TMP_DATA_AVAIL))) {
+        device->telemetry.duplicateEvents++;
+        return;
+    }
+
+    pipelineSample_t sample = {
+        .device             = device,
+        .values             = values,
+        .status             = status,
+        .accelerometerValid = ((status & LSM6_AXL_DATA_AVAIL) ? 1U : 0U),
+    };
+    runPipeline(&sample);
 }
 
 /**
- * @brief State in which the LSM6DSO is in error and no further treatment is done
- * 
+ * @brief Run a sample through the measurement pipeline
+ * @details
+ *  The stages listed in LSM6DSO_PIPELINE() are expanded here in order as direct calls to static inline functions,
+ *  so the compiler composes them into a single straight-line function, without any function pointer per sample.
+ *  A disabled stage is a constant false condition, and is removed altogether.
+ *  With LSM6DSO_PIPELINE_PROFILING, the CPU cycles spent in each stage are accumulated in the telemetry.
+ *
+ * @param[in,out] sample Sample to process
+ */
+static inline void runPipeline(pipelineSample_t* sample) {
+#define PIPELINE_RUN_STAGE(stage, function, enabled)         \
+    if(enabled) {                                            \
+        const cyclecount_t stageStart = PIPELINE_CYCLES();   \
+        const uint8_t      carryOn    = function(sample);    \
+        PIPELINE_PROFILE(sample->device, stage, stageStart); \
+        if(!carryOn) {                                       \
+            return;                                          \
+        }                                                    \
+    }
+
+    LSM6DSO_PIPELINE(PIPELINE_RUN_STAGE)
+
+#undef PIPELINE_RUN_STAGE
+}
+
+/**
+ * @brief Pipeline stage inverting the X and Y axis of a device mounted rotated by 180° around Z
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageAlignDevice(pipelineSample_t* sample) {
+    if(sample->device->rotated180) {
+        for(uint8_t axis = X_AXIS; axis <= (uint8_t)Y_AXIS; axis++) {
+            sample->values[GYROSCOPE_INDEX + axis]     = negateSaturated(sample->values[GYROSCOPE_INDEX + axis]);
+            sample->values[ACCELEROMETER_INDEX + axis] = negateSaturated(sample->values[ACCELEROMETER_INDEX + axis]);
+        }
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage rotating the vectors from the PCB axis to the tool axis (same cost whatever the mounting)
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageRotateMounting(pipelineSample_t* sample) {
+    mountingRotate(&sample->values[GYROSCOPE_INDEX]);
+    mountingRotate(&sample->values[ACCELEROMETER_INDEX]);
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage converting the temperature to °C, only when updated (max. freq. is 52Hz)
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageConvertTemperature(pipelineSample_t* sample) {
+    if(sample->status & LSM6_TMP_DATA_AVAIL) {
+        convertTemperature(sample->device, sample->values[TEMPERATURE_INDEX]);
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage rejecting the spikes and shocks of a new accelerometer sample
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on (a shock only invalidates the accelerometer values)
+ */
+static inline uint8_t stageRejectSpikes(pipelineSample_t* sample) {
+    if(sample->status & LSM6_AXL_DATA_AVAIL) {
+        sample->accelerometerValid = rejectSpikes(sample->device, &sample->values[ACCELEROMETER_INDEX]);
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage converting a new accelerometer sample to mG
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageConvertAccelerometer(pipelineSample_t* sample) {
+    if(sample->status & LSM6_AXL_DATA_AVAIL) {
+        convertAccelerometer(&sample->values[ACCELEROMETER_INDEX], sample->accelerometer_mG);
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage updating the upside down flag with a new accelerometer sample
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageDetectUpsideDown(pipelineSample_t* sample) {
+    if(sample->status & LSM6_AXL_DATA_AVAIL) {
+        updateUpsideDown(sample->device, sample->accelerometer_mG[Y_AXIS]);
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage low-passing the gravity vector with a new and valid accelerometer sample
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageFilterGravity(pipelineSample_t* sample) {
+    if(sample->accelerometerValid) {
+        updateGravity(sample->device, sample->accelerometer_mG);
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage converting a new gyroscope sample to rad/s
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 0 No new gyroscope sample, the same angle rate must not be integrated twice
+ * @retval 1 Gyroscope converted
+ */
+static inline uint8_t stageConvertGyroscope(pipelineSample_t* sample) {
+    if(!(sample->status & LSM6_GYR_DATA_AVAIL)) {
+        sample->device->telemetry.staleGyroscope++;
+        return (0);
+    }
+
+    //if gyroscope sample without a new accelerometer one, only integrate the gyroscope
+    if(!(sample->status & LSM6_AXL_DATA_AVAIL)) {
+        sample->device->telemetry.staleAccelerometer++;
+    }
+
+    convertGyroscope(&sample->values[GYROSCOPE_INDEX], sample->gyroscope_radps);
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage applying the complementary filter, and measuring the time spent doing so
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageComplementaryFilter(pipelineSample_t* sample) {
+    lsm6dso_t* device = sample->device;
+
+#if defined(LSM6DSO_FILTER_MONITOR)
+    //if step to check, keep the angles before it
+    float         anglesBefore_rad[NB_ANGLES];
+    const uint8_t monitored = filterMonitorIsDue(&device->monitor);
+    if(monitored) {
+        anglesBefore_rad[X_AXIS] = device->angles_rad[X_AXIS];
+        anglesBefore_rad[Y_AXIS] = device->angles_rad[Y_AXIS];
+    }
+#endif
+
+    const cyclecount_t startCycles = getCycleCount();
+    complementaryFilter(sample->accelerometer_mG, sample->gyroscope_radps, device->angles_rad, device->rates_radps,
+                        sample->accelerometerValid, device->samplePeriod_s);
+    device->telemetry.filterCycles += getCycleCount() - startCycles;
+
+#if defined(LSM6DSO_FILTER_MONITOR)
+    //capture the step, to be checked against the reference model in idle time
+    if(monitored) {
+        filterMonitorCapture(&device->monitor, sample->accelerometer_mG, sample->gyroscope_radps,
+                             sample->accelerometerValid, device->samplePeriod_s, anglesBefore_rad, device->angles_rad);
+    }
+#endif
+    device->telemetry.samplesProcessed++;
+    device->sampleTick = getCycleCount();
+    device->newAngles  = 1;
+    return (1);
+}
+
+/**
+ * @brief Pipeline stage driving the tilt alarm output right after the filter, and measuring its latency
+ * @details
+ *  The angles checked are the displayed ones (relative to the zeroing), at each complementary filter step.
+ *  The output is written at each step whatever its level (a single BSRR write), so the time measured
+ *  from the data-ready edge to the output written is the latency of any toggle.
+ *
+ * @param[in,out] sample Sample to process
+ * @retval 1 Always carry on
+ */
+static inline uint8_t stageTiltAlarm(pipelineSample_t* sample) {
+#if defined(LSM6DSO_TILT_ALARM)
+    lsm6dso_t*  device                = sample->device;
+    const float angles_rad[NB_ANGLES] = {
+        device->angles_rad[X_AXIS] + anglesAtZeroing_rad[X_AXIS],
+        device->angles_rad[Y_AXIS] + anglesAtZeroing_rad[Y_AXIS],
+    };
+
+    setTiltAlarm(device, tiltAlarmEvaluate(&device->tiltAlarm, angles_rad));
+
+    //measure the time elapsed since the data-ready edge (timebase wrapping handled by the unsigned difference)
+    const uint32_t latency_cycles        = getCycleCount() - device->dataReadyTick;
+    device->telemetry.alarmLatencyCycles = latency_cycles;
+    if(latency_cycles > device->telemetry.alarmLatencyMaxCycles) {
+        device->telemetry.alarmLatencyMaxCycles = latency_cycles;
+    }
+#else
+    (void)sample;
+#endif
+    return (1);
+}
+
+#if defined(LSM6DSO_TILT_ALARM)
+/**
+ * @brief Update the tilt alarm state of a device, and write the alarm output (raised if any device raised it)
+ *
+ * @param device Device for which update the alarm state
+ * @param raised 1 if the device raised the alarm, 0 otherwise
+ */
+static inline void setTiltAlarm(lsm6dso_t* device, uint8_t raised) {
+    const uint8_t deviceBit = (uint8_t)(1U << (uint8_t)(device - devices));
+    const uint8_t previous  = tiltAlarmDevices;
+
+    tiltAlarmDevices = (raised ? (uint8_t)(previous | deviceBit) : (uint8_t)(previous & ~deviceBit));
+    if(tiltAlarmDevices) {
+        LL_GPIO_SetOutputPin(TILT_ALARM_GPIO_Port, TILT_ALARM_Pin);
+    } else {
+        LL_GPIO_ResetOutputPin(TILT_ALARM_GPIO_Port, TILT_ALARM_Pin);
+    }
+
+    if(!previous != !tiltAlarmDevices) {
+        device->telemetry.alarmToggles++;
+    }
+}
+#endif
+
+#if defined(LSM6DSO_USE_FIFO)
+/**
+ * @brief Decode the FIFO words received from a device and process the samples
+ * @details
+ *  The accelerometer and gyroscope samples are queued separately, then processed by pairs (in chronological order),
+ *  as compressed words may hold several samples of the same sensor
+ *
+ * @param device Device which received the FIFO words
+ */
+static void processFifo(lsm6dso_t* device) {
+    fifoSample_t samples[FIFO_MAX_SAMPLES_PER_WORD];
+    rawValues_u  values;
+
+    for(uint16_t word = 0; word < device->nbFifoWords; word++) {
+        //decode the word and measure the time spent doing so
+        const cyclecount_t startCycles = getCycleCount();
+        const uint8_t      nbSamples   = fifoDecodeWord(&device->decoder, device->fifoWords[word], samples);
+        device->telemetry.fifoDecodeCycles += getCycleCount() - startCycles;
+        device->telemetry.fifoWordsDecoded++;
+
+        for(uint8_t sample = 0; sample < nbSamples; sample++) {
+            queueFifoSample(device, &samples[sample]);
+        }
+
+        //process all the complete pairs
+        while(device->queueCount[FIFO_GYROSCOPE] && device->queueCount[FIFO_ACCELEROMETER]) {
+            dequeueFifoSample(device, FIFO_GYROSCOPE, &values.values16bits[GYROSCOPE_INDEX]);
+            dequeueFifoSample(device, FIFO_ACCELEROMETER, &values.values16bits[ACCELEROMETER_INDEX]);
+            processSample(device, LSM6_AXL_DATA_AVAIL | LSM6_GYR_DATA_AVAIL, values.values16bits);
+        }
+    }
+
+    device->telemetry.fifoWordsDropped = device->decoder.wordsDropped;
+}
+
+/**
+ * @brief Queue a decoded FIFO sample until its counterpart is decoded
+ * @note If a queue is full, its oldest sample is processed alone
+ *
+ * @param device Device which measured the sample
+ * @param[in] sample Sample decoded
+ */
+static void queueFifoSample(lsm6dso_t* device, const fifoSample_t* sample) {
+    rawValues_u values;
+
+    switch(sample->sensor) {
+        case FIFO_TEMPERATURE:
+            values.values16bits[TEMPERATURE_INDEX] = sample->values[0];
+            processSample(device, LSM6_TMP_DATA_AVAIL, values.values16bits);
+            return;
+
+        case FIFO_ACCELEROMETER:
+            //drop the first accelerometer samples after change of ODR or power mode
+            if(device->samplesToIgnore) {
+                device->samplesToIgnore--;
+                return;
+            }
+
+            //if queue full, process the oldest accelerometer sample alone
+            if(device->queueCount[FIFO_ACCELEROMETER] >= (uint8_t)FIFO_QUEUE_SIZE) {
+                dequeueFifoSample(device, FIFO_ACCELEROMETER, &values.values16bits[ACCELEROMETER_INDEX]);
+                processSample(device, LSM6_AXL_DATA_AVAIL, values.values16bits);
+            }
+            break;
+
+        case FIFO_GYROSCOPE:
+            //if queue full, process the oldest gyroscope sample alone
+            if(device->queueCount[FIFO_GYROSCOPE] >= (uint8_t)FIFO_QUEUE_SIZE) {
+                dequeueFifoSample(device, FIFO_GYROSCOPE, &values.values16bits[GYROSCOPE_INDEX]);
+                processSample(device, LSM6_GYR_DATA_AVAIL, values.values16bits);
+            }
+            break;
+
+        case NB_FIFO_SENSORS:
+        default:
+            return;
+    }
+
+    //append the sample at the end of the queue
+    const uint8_t index =
+        (uint8_t)((device->queueHead[sample->sensor] + device->queueCount[sample->sensor]) % FIFO_QUEUE_SIZE);
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        device->queue_LSB[sample->sensor][index][axis] = sample->values[axis];
+    }
+    device->queueCount[sample->sensor]++;
+}
+
+/**
+ * @brief Remove the oldest sample of a queue
+ *
+ * @param device Device which measured the sample
+ * @param sensor Sensor of which dequeue the sample (accelerometer or gyroscope, queue not empty)
+ * @param[out] values Sample values on all axis
+ */
+static void dequeueFifoSample(lsm6dso_t* device, fifoSensor_e sensor, int16_t values[]) {
+    const uint8_t head = device->queueHead[sensor];
+
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        values[axis] = device->queue_LSB[sensor][head][axis];
+    }
+
+    device->queueHead[sensor] = (uint8_t)((head + 1U) % FIFO_QUEUE_SIZE);
+    device->queueCount[sensor]--;
+}
+#endif
+
+/**
+ * @brief Update the upside down flag with a hysteresis on the acceleration along the screen vertical axis
+ * @details
+ *  The screen lies in the tool XY plane, its columns along X and its top towards +Y.
+ *  The 180° rotation done by the SEG/COM remap shows as a sign change of the gravity along Y :
+ *  the screen is upside down once Y measures less than -0.5G, and upright again beyond +0.5G.
+ *  In-between (e.g. tool laid flat, Y close to 0), the orientation is kept.
+ *
+ * @param device Device for which update the flag
+ * @param accelerometerY_mG Acceleration measured on the Y axis (screen vertical) in [mG]
+ */
+static void updateUpsideDown(lsm6dso_t* device, float accelerometerY_mG) {
+    if(!device->upsideDown && (accelerometerY_mG < -UPSIDE_DOWN_THRESHOLD_MG)) {
+        device->upsideDown = 1;
+    } else if(device->upsideDown && (accelerometerY_mG > UPSIDE_DOWN_THRESHOLD_MG)) {
+        device->upsideDown = 0;
+    }
+}
+
+/**
+ * @brief Low-pass the accelerometer values to get the gravity vector used by the slope readout
+ * @note Only multiplications and additions are done here, the trigonometry is left to the getters
+ *
+ * @param device Device for which update the gravity vector
+ * @param[in] accelerometer_mG Acceleration measured on all axis in [mG]
+ */
+static void updateGravity(lsm6dso_t* device, const float accelerometer_mG[]) {
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        device->gravity_mG[axis] += GRAVITY_FILTER_ALPHA * (accelerometer_mG[axis] - device->gravity_mG[axis]);
+    }
+}
+
+/**
+ * @brief Get the gravity vector averaged over all the devices
+ *
+ * @param[out] gravity_mG Gravity vector on all axis in [mG]
+ */
+static void getGravity(float gravity_mG[]) {
+    const float DEVICES_RATIO = 1.0F / (float)NB_LSM6DSO;
+
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        gravity_mG[axis] = 0.0F;
+        for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+            gravity_mG[axis] += devices[device].gravity_mG[axis];
+        }
+        gravity_mG[axis] *= DEVICES_RATIO;
+    }
+}
+
+/**
+ * @brief Get the median value out of three
+ *
+ * @param first First value
+ * @param second Second value
+ * @param third Third value
+ * @return Median value
+ */
+static inline int16_t medianOf3(int16_t first, int16_t second, int16_t third) {
+    const int16_t lowest  = (first < second ? first : second);
+    const int16_t highest = (first < second ? second : first);
+
+    if(third < lowest) {
+        return (lowest);
+    }
+
+    return (third > highest ? highest : third);
+}
+
+/**
+ * @brief Negate a raw value without overflowing
+ *
+ * @param value Value to negate
+ * @return Negated value, saturated to INT16_MAX
+ */
+static inline int16_t negateSaturated(int16_t value) {
+    return (value == INT16_MIN ? INT16_MAX : (int16_t)-value);
+}
+
+/**
+ * @brief Reject shocks and spikes in raw accelerometer samples
+ * @details
+ *  This is done in two integer steps, in O(1) per sample :
+ *      - A median over the 3 latest samples of each axis removes single-sample spikes (adds 1 sample of latency)
+ *      - A gate on the acceleration magnitude flags samples disturbed by a knock or a tap,
+ *        during which only the gyroscope is to be integrated
+ *
+ * @param device Device from which the samples come
+ * @param[in,out] accelerometer_LSB Raw accelerometer samples on all axis, replaced with their median value
+ * @retval 0 Acceleration magnitude out of the gate, accelerometer values must be ignored
+ * @retval 1 Accelerometer values are valid
+ */
+static uint8_t rejectSpikes(lsm6dso_t* device, int16_t accelerometer_LSB[]) {
+    static const uint32_t GATE_MIN_LSB2  = (uint32_t)AXL_GATE_MIN_LSB * (uint32_t)AXL_GATE_MIN_LSB;
+    static const uint32_t GATE_MAX_LSB2  = (uint32_t)AXL_GATE_MAX_LSB * (uint32_t)AXL_GATE_MAX_LSB;
+    uint32_t              magnitude_LSB2 = 0;
+
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        int16_t* history = device->history_LSB[axis];
+
+        //if first sample since configuration, fill the whole history with it
+        if(!device->historyFilled) {
+            history[1] = accelerometer_LSB[axis];
+            history[2] = accelerometer_LSB[axis];
+        }
+
+        //replace the oldest sample and compute the median
+        history[device->historyIndex] = accelerometer_LSB[axis];
+        accelerometer_LSB[axis]       = medianOf3(history[0], history[1], history[2]);
+
+        //accumulate the squared magnitude (max. 3 * 32768² fits in 32 bits)
+        const int32_t value = accelerometer_LSB[axis];
+        magnitude_LSB2 += (uint32_t)(value * value);
+    }
+
+    device->historyFilled = 1;
+    device->historyIndex++;
+    if(device->historyIndex >= (uint8_t)SPIKE_HISTORY_SIZE) {
+        device->historyIndex = 0;
+    }
+
+    //if magnitude too far from 1G, acceleration is not only gravity
+    if((magnitude_LSB2 < GATE_MIN_LSB2) || (magnitude_LSB2 > GATE_MAX_LSB2)) {
+        device->telemetry.accelerometerGated++;
+        return (0);
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Convert the temperature LSB value to °C
+ * @note AN5192 p.113 : temperature sensitivity = 256 [LSB/°C] = 0.00390625 [°C/LSB] + LSB = 0 @ 25°C
+ *
+ * @param device Device from which the temperature comes
+ * @param temperature_LSB Raw temperature value
+ */
+static void convertTemperature(lsm6dso_t* device, int16_t temperature_LSB) {
+    const float TEMPERATURE_SENSITIVITY = 0.00390625F;
+    device->temperature_degC            = BASE_TEMPERATURE + ((float)temperature_LSB * TEMPERATURE_SENSITIVITY);
+}
+
+/**
+ * @brief Convert the gyroscope LSB values to rad/s
+ * @note datasheet p.9 : gyroscope sensitivity at 125°/s = 4.375[mdps/LSB]
+ *      to rad/s : (sensitivity / 1000[mdps/dps]) * (PI/180°) = 0.000076358155
+ *
+ * @param[in] gyroscope_LSB Raw gyroscope values on all axis
+ * @param[out] gyroscope_radps Gyroscope values on all axis in [rad/s]
+ */
+static void convertGyroscope(const int16_t gyroscope_LSB[], float gyroscope_radps[]) {
+    const float GYR_SENSITIVITY_125DPS_RPS = 0.000076358155F;
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        gyroscope_radps[axis] = (float)gyroscope_LSB[axis] * GYR_SENSITIVITY_125DPS_RPS;
+    }
+}
+
+/**
+ * @brief Convert the accelerometer LSB values to mG
+ * @note datasheet p.9 : accelerometer sensitivity at 2G = 0.061 [mG/LSB]
+ *
+ * @param[in] accelerometer_LSB Raw accelerometer values on all axis
+ * @param[out] accelerometer_mG Accelerometer values on all axis in [mG]
+ */
+static void convertAccelerometer(const int16_t accelerometer_LSB[], float accelerometer_mG[]) {
+    const float AXL_SENSITIVITY_2G = 0.061F;
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        accelerometer_mG[axis] = (float)accelerometer_LSB[axis] * AXL_SENSITIVITY_2G;
+    }
+}
+
+/**
+ * @brief Check if an INT1 event occurred
+ *
+ * @param device Device for which check the interrupt
+ * @retval 0 INT1 did not occur
+ * @retval 1 INT1 occurred
+ */
+static inline uint8_t dataReady(const lsm6dso_t* device) {
+    return (uint8_t)LL_GPIO_IsInputPinSet(device->intPort, device->intPin);
+}
+
+#if defined(LSM6DSO_TAP_CONTROL)
+/**
+ * @brief Read the tap source register once INT2 signalled a tap, which releases the latched interrupt
+ * @note The register is only read between two measurement bursts, while the device is configured
+ *
+ * @param device Device of which INT2 is wired
+ * @retval 0 Success
+ * @retval 1 Error while reading the tap source register
+ */
+static errorCode_u readTapSource(lsm6dso_t* device) {
+    uint8_t source = 0;
+
+    //if no tap signalled, bus used or device not measuring, exit (the tap stays pending)
+    if(!tapPending || lsm6dsoBusIsBusy() || ((device->state != stateMeasuring) && (device->state != stateHoldingValues))) {
+        return (ERR_SUCCESS);
+    }
+
+    tapPending = 0;
+    result     = lsm6dsoBusReadRegisters(&device->chipSelect, TAP_SRC, &source, 1);
+    if(isError(result)) {
+        return (pushErrorCode(result, READING_TAP, 1));
+    }
+    device->telemetry.bytesRead += 2U;
+
+    //a double tap cancels the single tap signalled at its first tap
+    if(source & TAP_SRC_DOUBLE_TAP) {
+        singleTapWaiting = 0;
+        latestTap        = TAP_DOUBLE;
+    } else if(source & TAP_SRC_SINGLE_TAP) {
+        singleTapWaiting  = 1;
+        singleTapTimer_ms = getSystick();
+    }
+
+    return (ERR_SUCCESS);
+}
+#endif
+
+#if defined(LSM6DSO_FILTER_MONITOR)
+/**
+ * @brief Check the filter step captured against the reference model, only while the device is idle
+ * @details
+ *  The check only runs once the burst has been processed, with no new sample waiting and the bus free,
+ *  so the reference computation never delays a measurement.
+ *
+ * @param device Device of which check the filter
+ * @retval 0 Success
+ * @retval 1 Filter deviating from the reference model beyond the threshold
+ */
+static errorCode_u checkFilterMonitor(lsm6dso_t* device) {
+    //if no step captured, a measurement pending or the bus used, wait
+    if(!device->monitor.pending || (device->state != stateMeasuring) || lsm6dsoBusIsBusy() || dataReady(device)) {
+        return (ERR_SUCCESS);
+    }
+
+    const uint8_t exceeded = filterMonitorCheck(&device->monitor);
+    device->telemetry.monitorMaxDeviation_urad =
+        (uint32_t)(device->monitor.maxDeviation_rad * RADIANS_TO_MICRORADIANS);
+    if(exceeded) {
+        return (createErrorCode(MONITORING_FILTER, 1, ERR_WARNING));
+    }
+
+    return (ERR_SUCCESS);
+}
+#endif
+
+/**
+ * @brief Capture a sensor timestamp and MCU time pair, and correct the sample period with the sensor clock rate
+ * @details
+ *  The timestamp counter and the output data rate both run on the sensor oscillator,
+ *  so the sample period integrated by the filter is scaled by the sensor clock rate measured against the MCU.
+ *  The CPU cycles count is captured right before the read request, the constant read latency
+ *  having no effect on the rate estimated.
+ *
+ * @param device Device of which read the timestamp
+ * @retval 0 Success
+ * @retval 1 Error while reading the timestamp registers
+ */
+static errorCode_u synchroniseClock(lsm6dso_t* device) {
+    uint8_t timestamp[NB_TIMESTAMP_REG];
+
+    const cyclecount_t tick = getCycleCount();
+    result                 = lsm6dsoBusReadRegisters(&device->chipSelect, TIMESTAMP0, timestamp, NB_TIMESTAMP_REG);
+    if(isError(result)) {
+        return (pushErrorCode(result, SYNCHRONISING_CLOCK, 1));
+    }
+    device->telemetry.bytesRead += NB_TIMESTAMP_REG + 1U;
+    device->syncTimer_ms = device->timer_ms;
+
+    //add the pair to the regression, and correct the sample period if the estimate changed
+    const uint32_t timestamp_LSB = (uint32_t)timestamp[0] | ((uint32_t)timestamp[1] << 8U)
+                                 | ((uint32_t)timestamp[2] << 16U) | ((uint32_t)timestamp[3] << 24U);
+    if(clockSyncAddPair(&device->clockSync, timestamp_LSB, tick)) {
+        device->samplePeriod_s = SAMPLE_PERIOD_S * clockSyncGetRate(&device->clockSync);
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/********************************************************************************************************************************************/
+/********************************************************************************************************************************************/
+
+/**
+ * @brief State in which the program waits for the LSM6DSO to boot up
+ *
+ * @param device Device for which run the state
+ * @return Success
+ */
+static errorCode_u stateWaitingBoot(lsm6dso_t* device) {
+    //if timer elapsed, reset it and get to next state
+    if(isTimeElapsed(device->timer_ms, BOOT_TIME_MS)) {
+        device->timer_ms = getSystick();
+        device->state    = stateWaitingDeviceID;
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State during which the Who Am I ID is checked
+ * @attention This takes the 10ms boot time into account
+ * @note If no correct manufacturer ID is read within 1 second, a timeout occurs
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Timeout while reading the manufacturer ID
+ * @retval 2 Error while sending the read request
+ */
+static errorCode_u stateWaitingDeviceID(lsm6dso_t* device) {
+    uint8_t deviceID = 0;
+
+    //if 1s elapsed without reading the correct vendor ID, go error
+    if(isTimeElapsed(device->timer_ms, TIMEOUT_MS)) {
+        device->state = stateError;
+        return (createErrorCode(CHECK_DEVICE_ID, 1, ERR_CRITICAL));
+    }
+
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //if unable to read device ID, error
+    result = lsm6dsoBusReadRegisters(&device->chipSelect, WHO_AM_I, &deviceID, 1);
+    if(isError(result)) {
+        return (pushErrorCode(result, CHECK_DEVICE_ID, 2));
+    }
+
+    //if invalid device ID, exit
+    if(deviceID != LSM6_WHOAMI) {
+        return (ERR_SUCCESS);
+    }
+
+    //calibrate the bus speed, starting with the reference values
+    device->prescalerTested = LSM6DSO_NB_SPI_PRESCALERS;
+    device->state           = stateCalibratingBus;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the fastest reliable SPI speed is determined
+ * @details
+ *  Two patterns are first written at the slowest speed, and the registers from FIFO_CTRL1 to WHO_AM_I
+ *  are read as a reference. Then, starting with the fastest speed within the LSM6DSO limit (10MHz),
+ *  each speed must read the same values several times in a row (one speed checked per call).
+ *  The bus then runs one step slower than the fastest reliable speed (margin), even when the fastest speed
+ *  within the limit passed, and the slowest speed required by the devices is kept for all of them.
+ *  A read returning an error fails the speed without comparing its values, as they may not all be written.
+ *  Both patterns are overwritten by the reset which comes next.
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Error while writing the patterns or reading the reference values
+ * @retval 2 Reference values not read back at the slowest speed
+ */
+static errorCode_u stateCalibratingBus(lsm6dso_t* device) {
+    uint8_t* reference = device->burst.registers8bits;
+
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //if first call, write the patterns and read the reference values at the slowest speed
+    if(device->prescalerTested >= (uint8_t)LSM6DSO_NB_SPI_PRESCALERS) {
+        lsm6dsoBusSetPrescaler(LSM6DSO_NB_SPI_PRESCALERS - 1U);
+        result = lsm6dsoBusWriteRegister(&device->chipSelect, FIFO_CTRL1, BUS_CHECK_PATTERN1);
+        if(!isError(result)) {
+            result = lsm6dsoBusWriteRegister(&device->chipSelect, COUNTER_BDR_REG2, BUS_CHECK_PATTERN2);
+        }
+        if(!isError(result)) {
+            result = lsm6dsoBusReadRegisters(&device->chipSelect, FIFO_CTRL1, reference, NB_BUS_CHECK_REG);
+        }
+        lsm6dsoBusSetPrescaler(busPrescaler);
+
+        if(isError(result)) {
+            device->state = stateError;
+            return (pushErrorCode(result, CALIBRATING_BUS, 1));
+        }
+
+        if((reference[0] != (uint8_t)BUS_CHECK_PATTERN1)
+           || (reference[COUNTER_BDR_REG2 - FIFO_CTRL1] != (uint8_t)BUS_CHECK_PATTERN2)
+           || (reference[WHO_AM_I - FIFO_CTRL1] != LSM6_WHOAMI)) {
+            device->state = stateError;
+            return (createErrorCode(CALIBRATING_BUS, 2, ERR_CRITICAL));
+        }
+
+        device->prescalerTested = lsm6dsoBusGetFastestAllowedPrescaler();
+        return (ERR_SUCCESS);
+    }
+
+    //read the reference values several times at the speed tested
+    uint8_t reliable = 1;
+    lsm6dsoBusSetPrescaler(device->prescalerTested);
+    for(uint8_t i = 0; reliable && (i < (uint8_t)BUS_CHECK_READS); i++) {
+        uint8_t values[NB_BUS_CHECK_REG];
+        result   = lsm6dsoBusReadRegisters(&device->chipSelect, FIFO_CTRL1, values, NB_BUS_CHECK_REG);
+        reliable = !isError(result);
+        for(uint8_t j = 0; reliable && (j < (uint8_t)NB_BUS_CHECK_REG); j++) {
+            reliable = (values[j] == reference[j]);
+        }
+    }
+    lsm6dsoBusSetPrescaler(busPrescaler);
+
+    //if not reliable, check the next slower speed (the slowest one gave the reference values)
+    if(!reliable && (device->prescalerTested < (LSM6DSO_NB_SPI_PRESCALERS - 1U))) {
+        device->prescalerTested++;
+        return (ERR_SUCCESS);
+    }
+
+    //run one step slower than the fastest reliable speed (margin), the slowest device setting the speed of the bus
+    if(reliable && (device->prescalerTested < (LSM6DSO_NB_SPI_PRESCALERS - 1U))) {
+        device->prescalerTested++;
+    }
+    if(!busCalibrated || (device->prescalerTested > busPrescaler)) {
+        busPrescaler = device->prescalerTested;
+    }
+    busCalibrated = 1;
+    lsm6dsoBusSetPrescaler(busPrescaler);
+
+    //get to the self-test, unless its result has been restored after a warm reset
+    device->state = (device->selfTestResult ? stateConfiguring : stateStartingSelfTest);
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the device is reset before running the self-test procedure
+ * @note The self-test runs while the other modules (e.g. the screen) are initialised
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Error while resetting the device
+ */
+static errorCode_u stateStartingSelfTest(lsm6dso_t* device) {
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //reset the device to make sure no filter or previous configuration alters the measurements
+    result = lsm6dsoBusWriteRegister(&device->chipSelect, CTRL3_C, LSM6_SOFTWARE_RESET);
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, SELF_TESTING, 1));
+    }
+
+    selfTestStart(&device->selfTest);
+    device->timer_ms = getSystick();
+    device->state    = stateApplyingSelfTestStep;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the registers of the current self-test step are configured
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Error while writing a register
+ */
+static errorCode_u stateApplyingSelfTestStep(lsm6dso_t* device) {
+    const selfTestStep_t* step                       = selfTestGetStep(&device->selfTest);
+    const registerValue_t stepArray[NB_SELFTEST_REG] = {
+        { CTRL3_C, LSM6_BLOCK_DATA_UPDATE | LSM6_AUTO_INCREMENT}, //update the outputs only once fully read
+        {CTRL1_XL,                                step->ctrl1XL}, //set the accelerometer ODR and full scale
+        { CTRL2_G,                                 step->ctrl2G}, //set the gyroscope ODR and full scale
+        { CTRL5_C,                                 step->ctrl5C}, //apply the self-test stimulus
+    };
+
+    //if software reset not finished or bus used by another device, wait
+    if(!isTimeElapsed(device->timer_ms, SOFTWARE_RESET_MS) || lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //write all registers values from the step array
+    for(uint8_t i = 0; i < (uint8_t)NB_SELFTEST_REG; i++) {
+        result = lsm6dsoBusWriteRegister(&device->chipSelect, stepArray[i].registerID, stepArray[i].value);
+        if(isError(result)) {
+            device->state = stateError;
+            return (pushErrorCode(result, SELF_TESTING, 2));
+        }
+    }
+
+    //drop the first sample after the change, then sample once the outputs settled
+    device->samplesToIgnore = 1;
+    device->timer_ms        = getSystick();
+    device->state           = stateSamplingSelfTest;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the samples of the current self-test step are averaged
+ * @details
+ *  Once all the steps are done, the result is cached and the device is configured for the measurements.
+ *  A failed self-test is reported, but does not prevent the measurements.
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 No sample received in a timely manner
+ * @retval 2 Error while reading the samples
+ * @retval 3 Self-test out of the datasheet limits
+ */
+static errorCode_u stateSamplingSelfTest(lsm6dso_t* device) {
+    const selfTestStep_t* step = selfTestGetStep(&device->selfTest);
+
+    //if outputs not settled yet, wait
+    if(!isTimeElapsed(device->timer_ms, SELFTEST_SETTLING_MS)) {
+        return (ERR_SUCCESS);
+    }
+
+    //if 1s elapsed without getting a sample, error
+    if(isTimeElapsed(device->timer_ms, SELFTEST_SETTLING_MS + TIMEOUT_MS)) {
+        device->state = stateError;
+        return (createErrorCode(SELF_TESTING, 1, ERR_CRITICAL));
+    }
+
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //read the status and all the outputs
+    result = lsm6dsoBusReadRegisters(&device->chipSelect, STATUS_REG, device->burst.registers8bits, NB_REGISTERS_TO_READ);
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, SELF_TESTING, 2));
+    }
+
+    //if no new sample of the sensor tested, exit
+    const uint8_t isAccelerometer = (step->sensor == SELFTEST_ACCELEROMETER);
+    if(!(device->burst.registers8bits[0] & (isAccelerometer ? LSM6_AXL_DATA_AVAIL : LSM6_GYR_DATA_AVAIL))) {
+        return (ERR_SUCCESS);
+    }
+
+    //if first sample after the step change, drop it
+    if(device->samplesToIgnore) {
+        device->samplesToIgnore--;
+        return (ERR_SUCCESS);
+    }
+
+    //add the sample, and exit if the step still needs some
+    const int16_t* values = &device->burst.values16bits[isAccelerometer ? ACCELEROMETER_INDEX : GYROSCOPE_INDEX];
+    if(!selfTestAddSample(&device->selfTest, values)) {
+        return (ERR_SUCCESS);
+    }
+
+    //if steps remaining, configure the next one
+    device->timer_ms = getSystick();
+    if(selfTestGetStep(&device->selfTest)) {
+        device->state = stateApplyingSelfTestStep;
+        return (ERR_SUCCESS);
+    }
+
+    //cache the result and configure the device for the measurements (which removes the stimulus)
+    device->selfTestResult = selfTestGetResult(&device->selfTest);
+    selfTestStoreCache((uint8_t)(device - devices), device->selfTestResult);
+    device->state = stateConfiguring;
+
+    if(device->selfTestResult != (uint8_t)SELFTEST_PASSED) {
+        return (createErrorCode(SELF_TESTING, 3, ERR_ERROR));
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the registers are configured in the LSM6DSO
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Error while writing a register
+ */
+static errorCode_u stateConfiguring(lsm6dso_t* device) {
+    const uint8_t AXL_SAMPLES_TO_IGNORE = 2U;  ///< Number of samples to drop (see stateIgnoringSamples())
+
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //write all registers values from the initialisation array
+    for(uint8_t i = 0; i < (uint8_t)NB_INIT_REG; i++) {
+        result = lsm6dsoBusWriteRegister(&device->chipSelect, initialisationArray[i].registerID,
+                                         initialisationArray[i].value);
+        if(isError(result)) {
+            device->state = stateError;
+            return (pushErrorCode(result, CONFIGURING, 1));
+        }
+    }
+
+    //set the number of samples to ignore after changing ODR and power mode
+    device->samplesToIgnore = AXL_SAMPLES_TO_IGNORE;
+    device->historyFilled   = 0;
+    device->timer_ms        = getSystick();
+    device->scrubTimer_ms   = device->timer_ms;
+    device->syncTimer_ms    = device->timer_ms;
+
+    //timestamp restarted by the reset : restart the clock synchronisation window (rate estimated kept)
+    clockSyncReset(&device->clockSync);
+
+#if defined(LSM6DSO_USE_FIFO)
+    //FIFO emptied by the reset : wait for new full samples (first accelerometer samples dropped while decoding)
+    fifoDecoderReset(&device->decoder);
+    device->queueCount[FIFO_GYROSCOPE]     = 0;
+    device->queueCount[FIFO_ACCELEROMETER] = 0;
+    device->state                          = stateMeasuring;
+#else
+    device->state = stateIgnoringSamples;
+#endif
+    return (ERR_SUCCESS);
+}
+
+#if !defined(LSM6DSO_USE_FIFO)
+/**
+ * @brief State in which the first few samples measured are dropped
+ * @note This is recommended in the document AN5192, Table 12
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 No measurement received in a timely manner
+ * @retval 2 Error while reading a register
+ */
+static errorCode_u stateIgnoringSamples(lsm6dso_t* device) {
+    //if 1s elapsed without getting any data ready interrupt, error
+    if(isTimeElapsed(device->timer_ms, TIMEOUT_MS)) {
+        device->state = stateError;
+        return (createErrorCode(DROPPING, 1, ERR_CRITICAL));
+    }
+
+    //if no interrupt occurred or bus used by another device, exit
+    if(!dataReady(device) || lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //read an accelerometer value to reset the latched interrupt
+    uint8_t dummyValue = 0;
+    result             = lsm6dsoBusReadRegisters(&device->chipSelect, OUTX_H_A, &dummyValue, 1);
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, DROPPING, 2));
+    }
+
+    //reset the timer
+    device->timer_ms = getSystick();
+
+    //decrement the remaining amount to ignore and exit if still remaining
+    device->samplesToIgnore--;
+    if(device->samplesToIgnore) {
+        return (ERR_SUCCESS);
+    }
+
+    //get to measuring state
+    device->state = stateMeasuring;
+    return (ERR_SUCCESS);
+}
+#endif
+
+/**
+ * @brief State in which the module waits for a measurement to be available
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 No measurement received in a timely manner
+ * @retval 2 Error while starting the burst read
+ * @retval 3 Error while reading the FIFO status
+ * @retval 4 Error while synchronising the sensor clock
+ */
+static errorCode_u stateMeasuring(lsm6dso_t* device) {
+    //if hold requested, shut the device down
+    if(holdRequested) {
+        device->state = stateEnteringHold;
+        return (ERR_SUCCESS);
+    }
+
+    //if 1s elapsed without getting any data ready interrupt, error
+    if(isTimeElapsed(device->timer_ms, TIMEOUT_MS)) {
+        device->state = stateError;
+        return (createErrorCode(MEASURING, 1, ERR_CRITICAL));
+    }
+
+    //if no interrupt for a whole scrub period, check whether the device lost its configuration
+    if(isTimeElapsed(device->timer_ms, SCRUB_PERIOD_MS) && isTimeElapsed(device->scrubTimer_ms, SCRUB_PERIOD_MS)) {
+        device->state = stateScrubbingRegisters;
+        return (ERR_SUCCESS);
+    }
+
+    //if no interrupt occurred or bus used by another device, exit
+    if(!dataReady(device) || lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //reset the timer
+    device->timer_ms = getSystick();
+
+    //if due, capture a timestamp pair while the bus is free (the sample is still available in the registers)
+    if(isTimeElapsed(device->syncTimer_ms, CLOCK_SYNC_PERIOD_MS)) {
+        result = synchroniseClock(device);
+        if(isError(result)) {
+            device->state = stateError;
+            return (pushErrorCode(result, MEASURING, 4));
+        }
+    }
+
+#if defined(LSM6DSO_USE_FIFO)
+    //get the number of words in the FIFO
+    uint8_t fifoStatus[NB_FIFO_STATUS_REG];
+    result = lsm6dsoBusReadRegisters(&device->chipSelect, FIFO_STATUS1, fifoStatus, NB_FIFO_STATUS_REG);
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, MEASURING, 3));
+    }
+    device->telemetry.bytesRead += NB_FIFO_STATUS_REG + 1U;
+
+    device->nbFifoWords = (uint16_t)(fifoStatus[0] | ((fifoStatus[1] & FIFO_DIFF_MSB_MASK) << 8U));
+    if(!device->nbFifoWords) {
+        device->telemetry.duplicateEvents++;
+        return (ERR_SUCCESS);
+    }
+    if(device->nbFifoWords > (uint16_t)FIFO_MAX_WORDS) {
+        device->nbFifoWords = FIFO_MAX_WORDS;
+    }
+
+    //start reading all the FIFO words in a single burst (address rolled back to the tag after each word)
+    const uint16_t burstSize = (uint16_t)(device->nbFifoWords * FIFO_WORD_NB_BYTES);
+    result = lsm6dsoBusStartBurst(&device->chipSelect, FIFO_DATA_OUT_TAG, (uint8_t*)device->fifoWords, burstSize);
+#else
+    //start reading the status register and all temp/accelerometer/gyroscope values in a single burst
+    const uint16_t burstSize = NB_REGISTERS_TO_READ;
+    result = lsm6dsoBusStartBurst(&device->chipSelect, STATUS_REG, device->burst.registers8bits, burstSize);
+#endif
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, MEASURING, 2));
+    }
+    device->telemetry.bytesRead += (uint32_t)burstSize + 1U;
+
+    device->state = stateReadingBurst;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the module waits for the DMA to be done reading a measurements burst
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Timeout while waiting for the burst to be received
+ * @retval 2 Error interrupt occurred during the DMA transfer
+ */
+static errorCode_u stateReadingBurst(lsm6dso_t* device) {
+    const lsm6dsoBurst_e burst = lsm6dsoBusGetBurstStatus();
+
+    //if burst not fully received yet, exit
+    if(burst == LSM6DSO_BURST_BUSY) {
+        return (ERR_SUCCESS);
+    }
+
+    //if DMA error or timeout, stop and error
+    if(burst != LSM6DSO_BURST_DONE) {
+        lsm6dsoBusStopBurst();
+        device->state = stateError;
+        return (createErrorCode(READING_BURST, (burst == LSM6DSO_BURST_FAILED) ? 2 : 1, ERR_ERROR));
+    }
+
+    //free the bus for the other devices and process the values received
+    lsm6dsoBusStopBurst();
+#if defined(LSM6DSO_USE_FIFO)
+    processFifo(device);
+#else
+    processBurst(device);
+#endif
+
+    //if scrub due, do it now that the sample has been read (longest idle time before the next one)
+    device->state = (isTimeElapsed(device->scrubTimer_ms, SCRUB_PERIOD_MS) ? stateScrubbingRegisters : stateMeasuring);
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the control registers are read back and compared with the configuration written
+ * @details
+ *  If the device browned out or glitched, its registers are back to their default values
+ *  (e.g. accelerometer and gyroscope powered down) and no error would ever show.
+ *  The registers from FIFO_CTRL1 to CTRL10_C are read in a single burst (plus the tap engine block
+ *  from TAP_CFG0 to MD2_CFG in a second one), and any of them which does not match the initialisation array
+ *  is rewritten, without resetting the device.
+ *  CTRL3_C is left out, as it only holds the software reset and the default interface settings.
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Error while reading the registers
+ * @retval 2 Device ID not read back, device reconfigured from scratch
+ * @retval 3 Error while rewriting a register
+ * @retval 4 Registers found altered and repaired
+ */
+static errorCode_u stateScrubbingRegisters(lsm6dso_t* device) {
+    uint8_t registers[NB_SCRUB_REG];
+#if defined(LSM6DSO_TAP_CONTROL)
+    uint8_t tapRegisters[NB_SCRUB_TAP_REG];
+#endif
+    uint8_t nbMismatches = 0;
+
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //if a sample is already waiting, read it first (the scrub is retried after it)
+    device->state = stateMeasuring;
+    if(dataReady(device)) {
+        return (ERR_SUCCESS);
+    }
+
+    //read all the control registers at once
+    device->scrubTimer_ms = getSystick();
+    result                = lsm6dsoBusReadRegisters(&device->chipSelect, FIFO_CTRL1, registers, NB_SCRUB_REG);
+#if defined(LSM6DSO_TAP_CONTROL)
+    if(!isError(result)) {
+        result = lsm6dsoBusReadRegisters(&device->chipSelect, TAP_CFG0, tapRegisters, NB_SCRUB_TAP_REG);
+    }
+#endif
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, SCRUBBING, 1));
+    }
+
+    //if device ID not read back, the device does not answer properly anymore : reconfigure it completely
+    if(registers[WHO_AM_I - FIFO_CTRL1] != LSM6_WHOAMI) {
+        device->timer_ms = getSystick();
+        device->state    = stateWaitingDeviceID;
+        return (createErrorCode(SCRUBBING, 2, ERR_WARNING));
+    }
+
+    //rewrite the registers which do not match their configured value
+    result = repairRegisters(device, FIFO_CTRL1, registers, NB_SCRUB_REG, &nbMismatches);
+#if defined(LSM6DSO_TAP_CONTROL)
+    if(!isError(result)) {
+        result = repairRegisters(device, TAP_CFG0, tapRegisters, NB_SCRUB_TAP_REG, &nbMismatches);
+    }
+#endif
+    if(isError(result)) {
+        device->state = stateError;
+        return (pushErrorCode(result, SCRUBBING, 3));
+    }
+
+    if(!nbMismatches) {
+        return (ERR_SUCCESS);
+    }
+
+#if defined(LSM6DSO_USE_FIFO)
+    //the embedded functions (FIFO compression) have been lost as well : rewrite them
+    for(uint8_t i = 1; i < (uint8_t)NB_INIT_REG; i++) {
+        if(initialisationArray[i].registerID >= FIFO_CTRL1) {
+            continue;
+        }
+
+        result = lsm6dsoBusWriteRegister(&device->chipSelect, initialisationArray[i].registerID,
+                                         initialisationArray[i].value);
+        if(isError(result)) {
+            device->state = stateError;
+            return (pushErrorCode(result, SCRUBBING, 3));
+        }
+    }
+
+    //FIFO stream restarted : drop the samples waiting for their counterpart
+    fifoDecoderReset(&device->decoder);
+    device->queueCount[FIFO_GYROSCOPE]     = 0;
+    device->queueCount[FIFO_ACCELEROMETER] = 0;
+#endif
+
+    //restart the spike filter and give the device time to produce new samples
+    device->telemetry.shadowMismatches += nbMismatches;
+    device->historyFilled = 0;
+    device->timer_ms      = getSystick();
+    return (createErrorCode(SCRUBBING, 4, ERR_WARNING));
+}
+
+/**
+ * @brief Rewrite the registers of a block read back which do not match their configured value
+ * @note The software reset (first entry of the initialisation array) is never rewritten
+ *
+ * @param device Device of which repair the registers
+ * @param firstRegister First register of the block read back
+ * @param values Values read back, starting with the first register
+ * @param nbValues Number of registers in the block
+ * @param[in,out] nbMismatches Number of registers rewritten, incremented with the ones of the block
+ * @retval 0 Success
+ * @retval 1 Error while rewriting a register
+ */
+static errorCode_u repairRegisters(const lsm6dso_t* device, LSM6DSOregister_e firstRegister, const uint8_t values[],
+                                   uint8_t nbValues, uint8_t* nbMismatches) {
+    const uint32_t lastRegister = (uint32_t)firstRegister + nbValues - 1U;
+
+    for(uint8_t i = 1; i < (uint8_t)NB_INIT_REG; i++) {
+        const registerValue_t* shadow = &initialisationArray[i];
+        if((shadow->registerID < firstRegister) || ((uint32_t)shadow->registerID > lastRegister)
+           || (values[shadow->registerID - firstRegister] == shadow->value)) {
+            continue;
+        }
+
+        result = lsm6dsoBusWriteRegister(&device->chipSelect, shadow->registerID, shadow->value);
+        if(isError(result)) {
+            return (pushErrorCode(result, REPAIRING_REGISTERS, 1));
+        }
+        (*nbMismatches)++;
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the accelerometer and gyroscope are powered down
+ *
+ * @param device Device for which run the state
+ * @retval 0 Success
+ * @retval 1 Error while sending shut down instructions
+ */
+static errorCode_u stateEnteringHold(lsm6dso_t* device) {
+    const registerValue_t configurationArray[NB_HOLD_REG] = {
+#if defined(LSM6DSO_TAP_CONTROL)
+        {CTRL1_XL, LSM6_ODR_416HZ | LSM6_AXL_LPF2_ENABLE}, //keep the accelerometer running for the tap engine
+#else
+        {CTRL1_XL,                       LSM6_POWER_DOWN}, //set accelerometer in power down mode
+#endif
+        { CTRL2_G,                       LSM6_POWER_DOWN}, //set gyroscope in power down mode
+    };
+
+    //if bus used by another device, wait
+    if(lsm6dsoBusIsBusy()) {
+        return (ERR_SUCCESS);
+    }
+
+    //write all registers values from the configurationArray array
+    for(uint8_t i = 0; i < (uint8_t)NB_HOLD_REG; i++) {
+        result = lsm6dsoBusWriteRegister(&device->chipSelect, configurationArray[i].registerID,
+                                         configurationArray[i].value);
+        if(isError(result)) {
+            device->state = stateError;
+            return (pushErrorCode(result, ENTERING_HOLD, 1));
+        }
+    }
+
+    device->state = stateHoldingValues;
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the MEMS is shut down and the module waits for a user release
+ *
+ * @param device Device for which run the state
+ * @return Success
+ */
+static errorCode_u stateHoldingValues(lsm6dso_t* device) {
+    //if released, reconfigure the device
+    if(!holdRequested) {
+        device->state = stateConfiguring;
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief State in which the LSM6DSO is in error and no further treatment is done
+ *
+ * @param device Device for which run the state
  * @return Success
  */
-static errorCode_u stateError() {
+static errorCode_u stateError(lsm6dso_t* device) {
+#if defined(LSM6DSO_TILT_ALARM)
+    //without any measurement to rely on, keep the tilt alarm raised (fail-safe)
+    setTiltAlarm(device, 1);
+#else
+    (void)device;
+#endif
     return (ERR_SUCCESS);
 }
@@ -1,6 +1,7 @@
 #ifndef LSM6DSO_H_INCLUDED
 #define LSM6DSO_H_INCLUDED
 #include <main.h>
+#include "LSM6DSO_pipeline.h"
 #include "errorstack.h"
 
 /**
@@ -13,12 +14,88 @@ typedef enum {
     NB_AXIS
 } axis_e;
 
-errorCode_u lsm6dsoInitialise(const SPI_TypeDef* handle);
-errorCode_u lsm6dsoUpdate();
-uint8_t     lsm6dsoHasChanged(axis_e axis);
-int16_t     getAngleDegreesTenths(axis_e axis);
-void        lsm6dsoZeroDown(void);
-void        lsm6dsoCancelZeroing(void);
-errorCode_u lsm6dsoHold(uint8_t toHold);
+/**
+ * @brief Structure regrouping the counters regarding the measurements stream
+ */
+typedef struct {
+    uint32_t accelerometerGated;  ///< Number of accelerometer samples ignored because of a shock
+    uint32_t duplicateEvents;     ///< Number of data-ready events without any new data
+    uint32_t staleGyroscope;      ///< Number of events without a new gyroscope sample (no filter update)
+    uint32_t staleAccelerometer;  ///< Number of gyroscope updates without a new accelerometer sample
+    uint32_t samplesProcessed;    ///< Number of samples integrated by the filter
+    uint32_t bytesRead;           ///< Number of bytes read over SPI to get the measurements (address bytes included)
+    uint32_t fifoWordsDecoded;    ///< Number of FIFO words decoded
+    uint32_t fifoWordsDropped;    ///< Number of compressed FIFO words dropped for lack of a full sample
+    uint32_t fifoDecodeCycles;    ///< Number of CPU cycles spent decoding the FIFO words
+    uint32_t filterCycles;        ///< Number of CPU cycles spent in the complementary filter
+    uint32_t shadowMismatches;    ///< Number of control registers found altered and rewritten by the scrub
+#if defined(LSM6DSO_PIPELINE_PROFILING)
+    uint32_t stageCycles[NB_PIPELINE_STAGES];  ///< Number of CPU cycles spent in each measurement pipeline stage
+#endif
+#if defined(LSM6DSO_FILTER_MONITOR)
+    uint32_t monitorMaxDeviation_urad;  ///< Maximum deviation of the filter from the reference model in [urad]
+#endif
+#if defined(LSM6DSO_TILT_ALARM)
+    uint32_t alarmLatencyCycles;     ///< CPU cycles from the latest data-ready edge to the alarm output written
+    uint32_t alarmLatencyMaxCycles;  ///< Maximum CPU cycles from a data-ready edge to the alarm output written
+    uint32_t alarmToggles;           ///< Number of times the alarm output changed level
+#endif
+} lsm6dsoTelemetry_t;
+
+/**
+ * @brief Enumeration of the LSM6DSO devices sharing the SPI bus
+ */
+typedef enum {
+    LSM6DSO_PRIMARY = 0,  ///< Device mounted in the reference orientation
+#if defined(LSM6DSO_DUAL_SENSOR)
+    LSM6DSO_SECONDARY,  ///< Device mounted rotated by 180° around the Z axis
+#endif
+    NB_LSM6DSO
+} lsm6dsoDevice_e;
+
+/**
+ * @brief Enumeration of the tap gestures detected by the LSM6DSO tap engine
+ */
+typedef enum {
+    TAP_NONE = 0,  ///< No tap detected
+    TAP_SINGLE,    ///< Single tap (not followed by a second one)
+    TAP_DOUBLE,    ///< Double tap
+} lsm6dsoTap_e;
+
+/**
+ * @brief Enumeration of the self-test result flags
+ */
+typedef enum {
+    SELFTEST_PENDING              = 0x00U,  ///< Self-test not finished yet
+    SELFTEST_PASSED               = 0x01U,  ///< Accelerometer and gyroscope within the datasheet limits
+    SELFTEST_ACCELEROMETER_FAILED = 0x02U,  ///< Accelerometer self-test out of the datasheet limits
+    SELFTEST_GYROSCOPE_FAILED     = 0x04U,  ///< Gyroscope self-test out of the datasheet limits
+    SELFTEST_FROM_CACHE           = 0x08U,  ///< Result restored from the backup registers after a warm reset
+} lsm6dsoSelfTest_e;
+
+errorCode_u               lsm6dsoInitialise(const SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t rxChannel,
+                                            uint32_t txChannel);
+errorCode_u               lsm6dsoUpdate();
+uint8_t                   lsm6dsoHasChanged(axis_e axis);
+uint8_t                   lsm6dsoIsUpsideDown(void);
+uint8_t                   lsm6dsoIsMoving(void);
+lsm6dsoTap_e              lsm6dsoGetTap(void);
+void                      lsm6dsoTapIRQhandler(void);
+void                      lsm6dsoDataReadyIRQhandler(lsm6dsoDevice_e device);
+uint8_t                   lsm6dsoDevicesDisagree(void);
+uint8_t                   lsm6dsoSlopeHasChanged(void);
+uint16_t                  lsm6dsoGetTiltDegreesTenths(void);
+int16_t                   lsm6dsoGetSlopeAzimuthDegreesTenths(void);
+const lsm6dsoTelemetry_t* lsm6dsoGetTelemetry(lsm6dsoDevice_e device);
+int32_t                   lsm6dsoGetClockDrift_ppm(lsm6dsoDevice_e device);
+uint8_t                   lsm6dsoGetSelfTestResult(lsm6dsoDevice_e device);
+errorCode_u               lsm6dsoCalibrateMounting(void);
+int16_t                   getAngleDegreesTenths(axis_e axis);
+void                      lsm6dsoSetRenderLatency(uint32_t latency_us);
+void                      lsm6dsoZeroDown(void);
+void                      lsm6dsoGetZeroing(float zeroing_rad[]);
+void                      lsm6dsoRestoreZeroing(const float zeroing_rad[]);
+void                      lsm6dsoCancelZeroing(void);
+errorCode_u               lsm6dsoHold(uint8_t toHold);
 
 #endif
@@ -0,0 +1,390 @@
+/**
+ * @file LSM6DSO_bus.c
+ * @brief Implement the SPI and DMA communication shared by the LSM6DSO devices
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  All the devices share the same SPI, each with its own chip select (or the SPI NSS pin when alone).
+ *  Single registers are read and written by polling, while the measurement bursts are read via DMA
+ *  (one channel receiving the burst, the other one sending the filler bytes which keep the SPI clock running).
+ *  A single burst can be in progress at a time : the bus stays owned by the device reading it
+ *  until lsm6dsoBusStopBurst() is called, which lets the devices interleave their bursts.
+ *  The timeouts are computed from the transfer duration at the current SPI speed.
+ */
+#include "LSM6DSO_bus.h"
+#include <stdint.h>
+#include "LSM6DSO_registers.h"
+#include "errorstack.h"
+#include "main.h"
+#include "stm32f103xb.h"
+#include "stm32f1xx_ll_dma.h"
+#include "stm32f1xx_ll_gpio.h"
+#include "stm32f1xx_ll_spi.h"
+#include "systick.h"
+
+enum {
+    SPI_TIMEOUT_EXTRA_US = 20U,        ///< Microseconds added to twice the SPI transfer time as a timeout
+    DMA_FLAGS_SHIFT      = 2U,         ///< Shift between the DMA flags of two consecutive channels
+    SPI_MAX_FREQUENCY_HZ = 10000000U,  ///< Maximum SPI clock frequency of the LSM6DSO (datasheet)
+    BITS_PER_BYTE        = 8U,         ///< Number of bits in a byte
+    US_PER_SECOND        = 1000000U,   ///< Number of microseconds in a second
+};
+
+/**
+ * @brief Enumeration of the function IDs of the LSM6DSO bus
+ */
+typedef enum {
+    READ_REGISTERS = 1,  ///< lsm6dsoBusReadRegisters() function
+    WRITE_REGISTER,      ///< lsm6dsoBusWriteRegister() function
+    START_BURST,         ///< lsm6dsoBusStartBurst() function
+} lsm6dsoBusFunction_e;
+
+static inline void     selectDevice(const lsm6dsoChipSelect_t* chip);
+static inline uint32_t dmaChannelFlag(uint32_t channel, uint32_t channel1Flag);
+static uint32_t        getBusClock_Hz(void);
+static uint32_t        getTransferTimeout_us(uint16_t nbBytes);
+
+static SPI_TypeDef*               spiHandle     = (void*)0;  ///< SPI handle shared by the LSM6DSO devices
+static DMA_TypeDef*               dmaHandle     = (void*)0;  ///< DMA handle used to read the measurement bursts
+static uint32_t                   dmaRxChannel  = 0;         ///< DMA channel used to receive the bursts
+static uint32_t                   dmaTxChannel  = 0;         ///< DMA channel used to send the filler bytes
+static const lsm6dsoChipSelect_t* busOwner      = (void*)0;  ///< Device currently reading a burst (NULL if bus free)
+static cyclecount_t               busTimer      = 0;         ///< Timer used to detect a DMA burst timeout
+static uint32_t                   busTimeout_us = 0;         ///< Time after which the DMA burst is in timeout (in us)
+static const uint8_t              SPI_RX_FILLER = 0xFFU;     ///< Byte sent as a filler while receiving a burst
+
+/**
+ * @brief Initialise the LSM6DSO bus
+ *
+ * @param handle        SPI handle used
+ * @param dma           DMA handle used
+ * @param rxChannel     DMA channel used to receive data from the SPI
+ * @param txChannel     DMA channel used to send data to the SPI
+ */
+void lsm6dsoBusInitialise(SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t rxChannel, uint32_t txChannel) {
+    spiHandle    = handle;
+    dmaHandle    = dma;
+    dmaRxChannel = rxChannel;
+    dmaTxChannel = txChannel;
+    busOwner     = (void*)0;
+
+    //make sure to disable LSM6DSO SPI communication
+    LL_SPI_Disable(spiHandle);
+    LL_DMA_DisableChannel(dmaHandle, dmaRxChannel);
+    LL_DMA_DisableChannel(dmaHandle, dmaTxChannel);
+}
+
+/**
+ * @brief Select a device on the SPI bus and enable the SPI
+ *
+ * @param chip Chip select of the device
+ */
+static inline void selectDevice(const lsm6dsoChipSelect_t* chip) {
+    if(chip->csPort) {
+        LL_GPIO_ResetOutputPin(chip->csPort, chip->csPin);
+    }
+    LL_SPI_Enable(spiHandle);
+}
+
+/**
+ * @brief Disable the SPI and release a device on the SPI bus
+ *
+ * @param chip Chip select of the device
+ */
+void lsm6dsoBusReleaseDevice(const lsm6dsoChipSelect_t* chip) {
+    LL_SPI_Disable(spiHandle);
+    if(chip->csPort) {
+        LL_GPIO_SetOutputPin(chip->csPort, chip->csPin);
+    }
+}
+
+/**
+ * @brief Check whether a device is reading a burst, in which case no other transfer can take place
+ *
+ * @retval 0 Bus free
+ * @retval 1 Bus owned by a device reading a burst
+ */
+uint8_t lsm6dsoBusIsBusy(void) {
+    return (busOwner != (void*)0);
+}
+
+/**
+ * @brief Get the flag of a DMA channel from its channel 1 equivalent
+ *
+ * @param channel DMA channel (LL_DMA_CHANNEL_x)
+ * @param channel1Flag Flag value for the channel 1 (e.g. DMA_ISR_TCIF1)
+ * @return Flag value for the channel
+ */
+static inline uint32_t dmaChannelFlag(uint32_t channel, uint32_t channel1Flag) {
+    return (channel1Flag << ((channel - LL_DMA_CHANNEL_1) << DMA_FLAGS_SHIFT));
+}
+
+/**
+ * @brief Set the SPI clock prescaler
+ * @note The SPI is disabled between transactions, which allows changing its speed
+ *
+ * @param prescaler Prescaler index (PCLK / 2^(index + 1))
+ */
+void lsm6dsoBusSetPrescaler(uint8_t prescaler) {
+    LL_SPI_SetBaudRatePrescaler(spiHandle, (uint32_t)prescaler << SPI_CR1_BR_Pos);
+}
+
+/**
+ * @brief Get the SPI clock prescaler currently set
+ *
+ * @return Prescaler index (PCLK / 2^(index + 1))
+ */
+uint8_t lsm6dsoBusGetPrescaler(void) {
+    return ((uint8_t)(LL_SPI_GetBaudRatePrescaler(spiHandle) >> SPI_CR1_BR_Pos));
+}
+
+/**
+ * @brief Get the fastest SPI prescaler which keeps the clock within the LSM6DSO limit
+ *
+ * @return Prescaler index (PCLK / 2^(index + 1))
+ */
+uint8_t lsm6dsoBusGetFastestAllowedPrescaler(void) {
+    const uint32_t apbClock_Hz = getBusClock_Hz();
+    uint8_t        prescaler   = 0;
+
+    while(((apbClock_Hz >> (prescaler + 1U)) > SPI_MAX_FREQUENCY_HZ)
+          && (prescaler < (LSM6DSO_NB_SPI_PRESCALERS - 1U))) {
+        prescaler++;
+    }
+
+    return (prescaler);
+}
+
+/**
+ * @brief Get the clock of the peripherals bus on which the SPI runs (APB2)
+ *
+ * @return Bus clock in [Hz]
+ */
+static uint32_t getBusClock_Hz(void) {
+    return (SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos]);
+}
+
+/**
+ * @brief Get the time after which an SPI transfer is in timeout, from its duration at the current speed
+ * @note A 17-bytes burst at 9MHz lasts about 15us, and is in timeout after about 50us (instead of 10ms)
+ *
+ * @param nbBytes Number of bytes transferred (address byte included)
+ * @return Timeout in [us]
+ */
+static uint32_t getTransferTimeout_us(uint16_t nbBytes) {
+    const uint32_t apbClock_MHz = getBusClock_Hz() / US_PER_SECOND;
+    const uint32_t prescaler    = LL_SPI_GetBaudRatePrescaler(spiHandle) >> SPI_CR1_BR_Pos;
+    const uint32_t apbCycles    = ((uint32_t)nbBytes * BITS_PER_BYTE) << (prescaler + 1U);
+    const uint32_t transfer_us  = (apbCycles + apbClock_MHz - 1U) / apbClock_MHz;
+
+    return ((transfer_us << 1U) + SPI_TIMEOUT_EXTRA_US);
+}
+
+/**
+ * @brief Read several registers on the LSM6DSO
+ *
+ * @param chip Chip select of the device on which read the registers
+ * @param firstRegister Number of the first register to read
+ * @param[out] value Registers value array
+ * @param size Number of registers to read
+ * @return   Success
+ * @retval 1 SPI handle or value buffer NULL
+ * @retval 2 Timeout
+ */
+errorCode_u lsm6dsoBusReadRegisters(const lsm6dsoChipSelect_t* chip, LSM6DSOregister_e firstRegister, uint8_t value[],
+                                    uint8_t size) {
+    //if no bytes to read, success
+    if(!size) {
+        return ERR_SUCCESS;
+    }
+
+    //make sure neither the handle nor the buffer are NULL
+    if(!spiHandle || !value) {
+        return (createErrorCode(READ_REGISTERS, 1, ERR_CRITICAL));
+    }
+
+    //set timeout timer and select the device
+    const uint32_t     timeout_us = getTransferTimeout_us((uint16_t)size + 1U);
+    const cyclecount_t timer      = getCycleCount();
+    selectDevice(chip);
+    uint8_t* iterator = value;
+
+    //send the read request and ignore the first byte received (reply to the write request)
+    LL_SPI_TransmitData8(spiHandle, LSM6_READ | (uint8_t)firstRegister);
+    while((!LL_SPI_IsActiveFlag_RXNE(spiHandle)) && !isTimeElapsed_us(timer, timeout_us)) {};
+    uint8_t received = (uint8_t)LL_SPI_IsActiveFlag_RXNE(spiHandle);
+    *iterator        = LL_SPI_ReceiveData8(spiHandle);
+
+    //receive the bytes to read, as long as the previous one has been received
+    while(size && received) {
+        //send a filler byte to keep the SPI clock running, to receive the next byte
+        LL_SPI_TransmitData8(spiHandle, SPI_RX_FILLER);
+
+        //wait for data to be available, and read it
+        while((!LL_SPI_IsActiveFlag_RXNE(spiHandle)) && !isTimeElapsed_us(timer, timeout_us)) {};
+        received  = (uint8_t)LL_SPI_IsActiveFlag_RXNE(spiHandle);
+        *iterator = LL_SPI_ReceiveData8(spiHandle);
+
+        iterator++;
+        size--;
+    }
+
+    //wait for transaction to be finished and clear Overrun flag
+    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed_us(timer, timeout_us)) {};
+    LL_SPI_ClearFlag_OVR(spiHandle);
+
+    //release the device
+    lsm6dsoBusReleaseDevice(chip);
+
+    //if a byte has not been received in time, error (time elapsed after the last byte does not count)
+    if(!received) {
+        return (createErrorCode(READ_REGISTERS, 2, ERR_WARNING));
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Write a single register on the LSM6DSO
+ *
+ * @param chip Chip select of the device on which write the register
+ * @param registerNumber Register number
+ * @param value Register value
+ * @return	 Success
+ * @retval 1 No SPI handle specified
+ * @retval 2 Register number out of range
+ * @retval 3 Timeout
+ */
+errorCode_u lsm6dsoBusWriteRegister(const lsm6dsoChipSelect_t* chip, LSM6DSOregister_e registerNumber, uint8_t value) {
+    //if handle not specified, error
+    if(!spiHandle) {
+        return (createErrorCode(WRITE_REGISTER, 1, ERR_WARNING));
+    }
+
+    //if register number above known or within the reserved range, error
+    if(registerNumber > MAX_REGISTER) {
+        return (createErrorCode(WRITE_REGISTER, 2, ERR_WARNING));
+    }
+
+    //set timeout timer and select the device
+    const uint32_t     timeout_us = getTransferTimeout_us(2U);
+    const cyclecount_t timer      = getCycleCount();
+    selectDevice(chip);
+
+    //send the write instruction
+    LL_SPI_TransmitData8(spiHandle, LSM6_WRITE | (uint8_t)registerNumber);
+
+    //wait for TX buffer to be ready and send value to write
+    while(!LL_SPI_IsActiveFlag_TXE(spiHandle) && !isTimeElapsed_us(timer, timeout_us)) {};
+    const uint8_t sent = (uint8_t)LL_SPI_IsActiveFlag_TXE(spiHandle);
+    if(sent) {
+        LL_SPI_TransmitData8(spiHandle, value);
+    }
+
+    //wait for transaction to be finished and clear Overrun flag
+    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed_us(timer, timeout_us)) {};
+    const uint8_t busy = (uint8_t)LL_SPI_IsActiveFlag_BSY(spiHandle);
+    LL_SPI_ClearFlag_OVR(spiHandle);
+
+    //release the device
+    lsm6dsoBusReleaseDevice(chip);
+
+    //if the value has not been shifted out in time, error (time elapsed after the transfer does not count)
+    if(!sent || busy) {
+        return (createErrorCode(WRITE_REGISTER, 3, ERR_WARNING));
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Start reading consecutive registers of a device via DMA
+ * @details
+ *  The read request is sent by polling (its reply byte is meaningless),
+ *  then the DMA sends filler bytes and receives the burst in the buffer.
+ *  The bus stays owned by the device until lsm6dsoBusStopBurst() is called.
+ *
+ * @param chip Chip select of the device from which read the burst
+ * @param firstRegister Number of the first register to read
+ * @param[out] buffer Buffer in which receive the registers values
+ * @param size Number of registers to read
+ * @return Success
+ * @retval 1 Timeout while sending the read request
+ */
+errorCode_u lsm6dsoBusStartBurst(const lsm6dsoChipSelect_t* chip, LSM6DSOregister_e firstRegister, uint8_t buffer[],
+                                 uint16_t size) {
+    //take the bus and select the device
+    busOwner      = chip;
+    busTimeout_us = getTransferTimeout_us(size + 1U);
+    busTimer      = getCycleCount();
+    selectDevice(chip);
+
+    //send the read request and ignore the first byte received
+    LL_SPI_TransmitData8(spiHandle, LSM6_READ | (uint8_t)firstRegister);
+    while((!LL_SPI_IsActiveFlag_RXNE(spiHandle)) && !isTimeElapsed_us(busTimer, busTimeout_us)) {};
+    const uint8_t replied = (uint8_t)LL_SPI_IsActiveFlag_RXNE(spiHandle);
+    (void)LL_SPI_ReceiveData8(spiHandle);
+    if(!replied) {
+        lsm6dsoBusStopBurst();
+        return (createErrorCode(START_BURST, 1, ERR_WARNING));
+    }
+
+    //configure the reception channel (SPI to device buffer)
+    WRITE_REG(dmaHandle->IFCR, dmaChannelFlag(dmaRxChannel, DMA_IFCR_CGIF1));
+    LL_DMA_ConfigAddresses(dmaHandle, dmaRxChannel, LL_SPI_DMA_GetRegAddr(spiHandle), (uint32_t)buffer,
+                           LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(dmaHandle, dmaRxChannel, size);
+
+    //configure the transmission channel (same filler byte over and over)
+    WRITE_REG(dmaHandle->IFCR, dmaChannelFlag(dmaTxChannel, DMA_IFCR_CGIF1));
+    LL_DMA_ConfigAddresses(dmaHandle, dmaTxChannel, (uint32_t)&SPI_RX_FILLER, LL_SPI_DMA_GetRegAddr(spiHandle),
+                           LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetDataLength(dmaHandle, dmaTxChannel, size);
+
+    //start the transfer (reception first, to never miss a byte)
+    LL_SPI_EnableDMAReq_RX(spiHandle);
+    LL_DMA_EnableChannel(dmaHandle, dmaRxChannel);
+    LL_DMA_EnableChannel(dmaHandle, dmaTxChannel);
+    LL_SPI_EnableDMAReq_TX(spiHandle);
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Get the state of the burst in progress
+ *
+ * @return State of the burst (a DMA error prevails over the timeout)
+ */
+lsm6dsoBurst_e lsm6dsoBusGetBurstStatus(void) {
+    if(READ_BIT(dmaHandle->ISR, dmaChannelFlag(dmaRxChannel, DMA_ISR_TEIF1))) {
+        return (LSM6DSO_BURST_FAILED);
+    }
+
+    if(READ_BIT(dmaHandle->ISR, dmaChannelFlag(dmaRxChannel, DMA_ISR_TCIF1))) {
+        return (LSM6DSO_BURST_DONE);
+    }
+
+    return (isTimeElapsed_us(busTimer, busTimeout_us) ? LSM6DSO_BURST_TIMEOUT : LSM6DSO_BURST_BUSY);
+}
+
+/**
+ * @brief Stop the DMA burst in progress, release the device and free the bus
+ */
+void lsm6dsoBusStopBurst(void) {
+    LL_DMA_DisableChannel(dmaHandle, dmaTxChannel);
+    LL_DMA_DisableChannel(dmaHandle, dmaRxChannel);
+
+    //wait for transaction to be finished and clear Overrun flag
+    const uint32_t     timeout_us = getTransferTimeout_us(1U);
+    const cyclecount_t timer      = getCycleCount();
+    while(LL_SPI_IsActiveFlag_BSY(spiHandle) && !isTimeElapsed_us(timer, timeout_us)) {};
+    LL_SPI_DisableDMAReq_TX(spiHandle);
+    LL_SPI_DisableDMAReq_RX(spiHandle);
+    LL_SPI_ClearFlag_OVR(spiHandle);
+
+    if(busOwner) {
+        lsm6dsoBusReleaseDevice(busOwner);
+    }
+    busOwner = (void*)0;
+}
@@ -0,0 +1,44 @@
+#ifndef LSM6DSO_BUS_H_INCLUDED
+#define LSM6DSO_BUS_H_INCLUDED
+#include <stdint.h>
+#include "LSM6DSO_registers.h"
+#include "errorstack.h"
+#include "stm32f103xb.h"
+
+enum {
+    LSM6DSO_NB_SPI_PRESCALERS = 8U,  ///< Number of SPI prescalers (from PCLK/2 to PCLK/256)
+};
+
+/**
+ * @brief Structure holding the chip select of a device on the SPI bus
+ */
+typedef struct {
+    GPIO_TypeDef* csPort;  ///< Chip select GPIO port (NULL if driven by the SPI NSS pin)
+    uint32_t      csPin;   ///< Chip select GPIO pin
+} lsm6dsoChipSelect_t;
+
+/**
+ * @brief Enumeration of the states of a DMA burst read
+ */
+typedef enum {
+    LSM6DSO_BURST_BUSY = 0,  ///< Bytes still being received
+    LSM6DSO_BURST_DONE,      ///< All the bytes received
+    LSM6DSO_BURST_FAILED,    ///< DMA transfer error
+    LSM6DSO_BURST_TIMEOUT,   ///< Bytes not all received in time
+} lsm6dsoBurst_e;
+
+void           lsm6dsoBusInitialise(SPI_TypeDef* handle, DMA_TypeDef* dma, uint32_t rxChannel, uint32_t txChannel);
+errorCode_u    lsm6dsoBusReadRegisters(const lsm6dsoChipSelect_t* chip, LSM6DSOregister_e firstRegister, uint8_t value[],
+                                       uint8_t size);
+errorCode_u    lsm6dsoBusWriteRegister(const lsm6dsoChipSelect_t* chip, LSM6DSOregister_e registerNumber, uint8_t value);
+errorCode_u    lsm6dsoBusStartBurst(const lsm6dsoChipSelect_t* chip, LSM6DSOregister_e firstRegister, uint8_t buffer[],
+                                    uint16_t size);
+lsm6dsoBurst_e lsm6dsoBusGetBurstStatus(void);
+void           lsm6dsoBusStopBurst(void);
+uint8_t        lsm6dsoBusIsBusy(void);
+void           lsm6dsoBusReleaseDevice(const lsm6dsoChipSelect_t* chip);
+void           lsm6dsoBusSetPrescaler(uint8_t prescaler);
+uint8_t        lsm6dsoBusGetPrescaler(void);
+uint8_t        lsm6dsoBusGetFastestAllowedPrescaler(void);
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file LSM6DSO_clocksync.c
+ * @brief Implement the synchronisation of the LSM6DSO clock with the MCU clock
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The LSM6DSO timestamp and output data rate both run on the sensor internal oscillator (±1-2%),
+ *  while the MCU time runs on the HSE crystal. Pairs of (sensor timestamp, MCU time) are captured
+ *  about once per second, and a least-squares line is fitted over the latest pairs to map sensor time to MCU time.
+ *  The line slope gives the actual sensor clock rate, used to correct the sample period integrated by the filter.
+ *  A constant latency between the two captures only shifts the line, and does not affect the rate.
+ *
+ * @note Additional information can be found in :
+ *   - AN5192 (timestamp, section 6.4) : https://www.st.com/resource/en/application_note/an5192-lsm6dso-alwayson-3axis-accelerometer-and-3axis-gyroscope-stmicroelectronics.pdf
+ */
+#include "LSM6DSO_clocksync.h"
+#include <stdint.h>
+#include "fastmath.h"
+#include "systick.h"
+
+#define TIMESTAMP_PERIOD_US 25.0F   ///< Nominal period of the LSM6DSO timestamp LSB in [us]
+#define MAX_DRIFT           0.05F   ///< Maximum relative drift accepted (beyond, the pair is considered a glitch)
+#define PPM_PER_UNIT        1.0e6F  ///< Number of parts per million in a unit
+
+enum {
+    MAX_PAIR_GAP_MS = 10000U,  ///< Time between two pairs beyond which the window restarts (timebase overflow at 59s)
+    US_PER_MS       = 1000U,   ///< Number of microseconds in a millisecond
+};
+
+static void    restartWindow(clockSync_t* sync, uint32_t timestamp_LSB, cyclecount_t tick);
+static uint8_t fitWindow(clockSync_t* sync);
+
+/**
+ * @brief Empty the regression window, keeping the latest sensor clock rate estimated
+ * @note This is to be called whenever the sensor timestamp restarts (e.g. after a software reset)
+ *
+ * @param[out] sync Clock synchronisation context
+ */
+void clockSyncReset(clockSync_t* sync) {
+    sync->head    = 0;
+    sync->nbPairs = 0;
+}
+
+/**
+ * @brief Add a timestamp pair to the regression window, and update the estimate once enough pairs are gathered
+ * @details
+ *  The MCU time of a pair is extended from the previous one with the CPU cycles count,
+ *  the first pair of a window being anchored on the system tick.
+ *  A pair whose interval does not match the previous one within the maximum drift
+ *  (timestamp reset, missed counter overflow, ...) restarts the window.
+ *
+ * @param[in,out] sync Clock synchronisation context
+ * @param timestamp_LSB Sensor timestamp (25us LSB)
+ * @param tick CPU cycles count captured along with the timestamp
+ * @retval 0 Estimate not updated
+ * @retval 1 Estimate updated
+ */
+uint8_t clockSyncAddPair(clockSync_t* sync, uint32_t timestamp_LSB, cyclecount_t tick) {
+    //if first pair, or previous pair too old to extend the MCU time with the timebase, restart the window
+    if(!sync->nbPairs || isTimeElapsed(sync->latestTick_ms, MAX_PAIR_GAP_MS)) {
+        restartWindow(sync, timestamp_LSB, tick);
+        return (0);
+    }
+
+    //compute the intervals since the latest pair (the cycles remainder is carried over to the next pair)
+    const uint8_t  latest       = (uint8_t)((sync->head + CLOCKSYNC_NB_PAIRS - 1U) % CLOCKSYNC_NB_PAIRS);
+    const uint32_t interval_us  = (tick - sync->latestTick) / cyclesPerMicrosecond;
+    const uint32_t interval_LSB = timestamp_LSB - sync->timestamps_LSB[latest];
+
+    //if intervals not matching within the maximum drift, restart the window
+    const float intervalRatio = (float)interval_us / ((float)interval_LSB * TIMESTAMP_PERIOD_US);
+    if(!interval_LSB || (MATH_ABS(intervalRatio - 1.0F) > MAX_DRIFT)) {
+        restartWindow(sync, timestamp_LSB, tick);
+        return (0);
+    }
+
+    //store the pair (overwriting the oldest one once the window is full)
+    sync->timestamps_LSB[sync->head] = timestamp_LSB;
+    sync->mcuTimes_us[sync->head]    = sync->mcuTimes_us[latest] + interval_us;
+    sync->head                       = (uint8_t)((sync->head + 1U) % CLOCKSYNC_NB_PAIRS);
+    sync->latestTick += interval_us * cyclesPerMicrosecond;
+    sync->latestTick_ms = getSystick();
+    if(sync->nbPairs < (uint8_t)CLOCKSYNC_NB_PAIRS) {
+        sync->nbPairs++;
+    }
+
+    if(sync->nbPairs < (uint8_t)CLOCKSYNC_MIN_PAIRS) {
+        return (0);
+    }
+
+    return (fitWindow(sync));
+}
+
+/**
+ * @brief Restart the regression window from a single pair
+ * @note The latest rate estimated is kept, and the sensor to MCU time mapping restarts from the pair
+ *
+ * @param[in,out] sync Clock synchronisation context
+ * @param timestamp_LSB Sensor timestamp (25us LSB)
+ * @param tick CPU cycles count captured along with the timestamp
+ */
+static void restartWindow(clockSync_t* sync, uint32_t timestamp_LSB, cyclecount_t tick) {
+    sync->latestTick_ms     = getSystick();
+    sync->latestTick        = tick;
+    sync->timestamps_LSB[0] = timestamp_LSB;
+    sync->mcuTimes_us[0]    = sync->latestTick_ms * US_PER_MS;
+    sync->head              = 1U;
+    sync->nbPairs           = 1U;
+
+    sync->referenceTimestamp_LSB = timestamp_LSB;
+    sync->referenceTime_us       = sync->mcuTimes_us[0];
+    sync->offset_us              = 0.0F;
+}
+
+/**
+ * @brief Fit a least-squares line through the pairs of the window
+ * @details
+ *  The pairs are taken relative to the oldest one, so that the values stay exact in single precision
+ *  (15s of pairs is 600000 timestamp LSB and 15000000us), and the sums are centred on their means.
+ *  A slope beyond the maximum drift is rejected and restarts the window, keeping the previous estimate.
+ *
+ * @param[in,out] sync Clock synchronisation context
+ * @retval 0 Estimate rejected
+ * @retval 1 Estimate updated
+ */
+static uint8_t fitWindow(clockSync_t* sync) {
+    const uint8_t  oldest        = (uint8_t)((sync->head + CLOCKSYNC_NB_PAIRS - sync->nbPairs) % CLOCKSYNC_NB_PAIRS);
+    const uint32_t reference_LSB = sync->timestamps_LSB[oldest];
+    const uint32_t reference_us  = sync->mcuTimes_us[oldest];
+    float          x[CLOCKSYNC_NB_PAIRS];
+    float          y[CLOCKSYNC_NB_PAIRS];
+    float          meanX = 0.0F;
+    float          meanY = 0.0F;
+
+    //compute the means of the pairs relative to the oldest one
+    for(uint8_t i = 0; i < sync->nbPairs; i++) {
+        const uint8_t index = (uint8_t)((oldest + i) % CLOCKSYNC_NB_PAIRS);
+        x[i]                = (float)(sync->timestamps_LSB[index] - reference_LSB);
+        y[i]                = (float)(sync->mcuTimes_us[index] - reference_us);
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= (float)sync->nbPairs;
+    meanY /= (float)sync->nbPairs;
+
+    //compute the centred sums
+    float sumXX = 0.0F;
+    float sumXY = 0.0F;
+    for(uint8_t i = 0; i < sync->nbPairs; i++) {
+        sumXX += (x[i] - meanX) * (x[i] - meanX);
+        sumXY += (x[i] - meanX) * (y[i] - meanY);
+    }
+
+    //if slope beyond the maximum drift, restart the window from the latest pair
+    const float slope_usPerLSB = (sumXX > 0.0F ? (sumXY / sumXX) : 0.0F);
+    const float drift          = (slope_usPerLSB / TIMESTAMP_PERIOD_US) - 1.0F;
+    if(MATH_ABS(drift) > MAX_DRIFT) {
+        const uint8_t latest = (uint8_t)((sync->head + CLOCKSYNC_NB_PAIRS - 1U) % CLOCKSYNC_NB_PAIRS);
+        restartWindow(sync, sync->timestamps_LSB[latest], sync->latestTick);
+        return (0);
+    }
+
+    sync->slope_usPerLSB         = slope_usPerLSB;
+    sync->drift                  = drift;
+    sync->referenceTimestamp_LSB = reference_LSB;
+    sync->referenceTime_us       = reference_us;
+    sync->offset_us              = meanY - (slope_usPerLSB * meanX);
+    return (1);
+}
+
+/**
+ * @brief Get the actual rate of the sensor clock relative to its nominal rate
+ *
+ * @param[in] sync Clock synchronisation context
+ * @return Ratio between the actual and the nominal sensor clock periods (1.0 until estimated)
+ */
+float clockSyncGetRate(const clockSync_t* sync) {
+    return (1.0F + sync->drift);
+}
+
+/**
+ * @brief Get the estimated drift of the sensor clock
+ *
+ * @param[in] sync Clock synchronisation context
+ * @return Drift in [ppm], positive when the sensor clock is slower than nominal
+ */
+int32_t clockSyncGetDrift_ppm(const clockSync_t* sync) {
+    return ((int32_t)(sync->drift * PPM_PER_UNIT));
+}
+
+/**
+ * @brief Map a sensor timestamp to the MCU time
+ * @note The mapping is most accurate around the regression window (the latest 15s)
+ *
+ * @param[in] sync Clock synchronisation context
+ * @param timestamp_LSB Sensor timestamp (25us LSB)
+ * @return MCU time in [us] since boot (modulo 2^32, the window being anchored on the system tick to the millisecond)
+ */
+uint32_t clockSyncToMcuTime_us(const clockSync_t* sync, uint32_t timestamp_LSB) {
+    const float slope_usPerLSB = (sync->slope_usPerLSB > 0.0F ? sync->slope_usPerLSB : TIMESTAMP_PERIOD_US);
+    const float elapsed_LSB    = (float)(int32_t)(timestamp_LSB - sync->referenceTimestamp_LSB);
+
+    return (sync->referenceTime_us + (uint32_t)(int32_t)(sync->offset_us + (slope_usPerLSB * elapsed_LSB)));
+}
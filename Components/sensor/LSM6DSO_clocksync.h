@@ -0,0 +1,35 @@
+#ifndef LSM6DSO_CLOCKSYNC_H_INCLUDED
+#define LSM6DSO_CLOCKSYNC_H_INCLUDED
+#include <stdint.h>
+#include "systick.h"
+
+enum {
+    CLOCKSYNC_NB_PAIRS  = 16U,  ///< Number of timestamp pairs in the regression window
+    CLOCKSYNC_MIN_PAIRS = 4U,   ///< Number of timestamp pairs needed before estimating the sensor clock rate
+};
+
+/**
+ * @brief Structure holding the regression between the sensor timestamps and the MCU time
+ * @note A zeroed structure is valid, and reports the nominal sensor clock rate (no drift)
+ */
+typedef struct {
+    uint32_t     timestamps_LSB[CLOCKSYNC_NB_PAIRS];  ///< Sensor timestamps of the pairs in the window (25us LSB)
+    uint32_t     mcuTimes_us[CLOCKSYNC_NB_PAIRS];     ///< MCU times of the pairs in the window in [us]
+    uint8_t      head;                                ///< Index at which the next pair is stored
+    uint8_t      nbPairs;                             ///< Number of pairs in the window
+    cyclecount_t latestTick;                          ///< CPU cycles count of the latest pair
+    systick_t    latestTick_ms;                       ///< System tick of the latest pair
+    uint32_t     referenceTimestamp_LSB;              ///< Sensor timestamp from which the regression is computed
+    uint32_t     referenceTime_us;                    ///< MCU time from which the regression is computed in [us]
+    float        offset_us;                           ///< MCU time at the reference timestamp, minus the reference
+    float        slope_usPerLSB;                      ///< Estimated sensor timestamp period in [us] (0 : none yet)
+    float        drift;                               ///< Estimated relative drift of the sensor clock (0 : nominal)
+} clockSync_t;
+
+void     clockSyncReset(clockSync_t* sync);
+uint8_t  clockSyncAddPair(clockSync_t* sync, uint32_t timestamp_LSB, cyclecount_t tick);
+float    clockSyncGetRate(const clockSync_t* sync);
+int32_t  clockSyncGetDrift_ppm(const clockSync_t* sync);
+uint32_t clockSyncToMcuTime_us(const clockSync_t* sync, uint32_t timestamp_LSB);
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file LSM6DSO_fifo.c
+ * @brief Implement the decoding of the LSM6DSO FIFO words, compressed or not
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Each FIFO word is made of a tag byte (sensor ID, counter and parity) and 6 data bytes.
+ *  When compression is enabled, the accelerometer and gyroscope samples are either :
+ *      - non-compressed (NC, NC_T_1, NC_T_2) : full samples, used as the reference for the next ones
+ *      - 2xC : two samples, each as three 8-bits differences with the previous sample
+ *      - 3xC : three samples, each as three 5-bits differences packed in 16 bits
+ *  The samples of a sensor being stored in chronological order, they are rebuilt by accumulating the differences.
+ *
+ * @note Additional information can be found in :
+ *   - AN5192 (FIFO compression, section 9.10) : https://www.st.com/resource/en/application_note/an5192-lsm6dso-alwayson-3axis-accelerometer-and-3axis-gyroscope-stmicroelectronics.pdf
+ */
+#include "LSM6DSO_fifo.h"
+#include <stdint.h>
+
+enum {
+    TAG_SENSOR_SHIFT   = 3U,     ///< Shift of the sensor ID in the tag byte
+    DIFF_5BITS_MASK    = 0x1FU,  ///< Mask of a 5-bits difference in a 3xC word
+    DIFF_5BITS_SIGN    = 0x10U,  ///< Sign bit of a 5-bits difference in a 3xC word
+    DIFF_5BITS_SHIFT   = 5U,     ///< Shift between two 5-bits differences in a 3xC word
+    DIFF_5BITS_EXTEND  = 0x20,   ///< Value to subtract to sign-extend a 5-bits difference
+    BYTE_SHIFT         = 8U,     ///< Number of bits in a byte
+    NB_SAMPLES_2XC     = 2U,     ///< Number of samples in a 2xC word
+    NB_SAMPLES_3XC     = 3U,     ///< Number of samples in a 3xC word
+    FIRST_DATA_BYTE    = 1U,     ///< Index of the first data byte in a FIFO word
+    BYTES_PER_3XC_DIFF = 2U,     ///< Number of bytes used by a sample in a 3xC word
+};
+
+/**
+ * @brief Enumeration of the FIFO tags sensor IDs
+ * @note See datasheet p.104 (FIFO_DATA_OUT_TAG)
+ */
+typedef enum {
+    TAG_GYROSCOPE_NC = 0x01U,       ///< Gyroscope non-compressed sample (t)
+    TAG_ACCELEROMETER_NC,           ///< Accelerometer non-compressed sample (t)
+    TAG_TEMPERATURE,                ///< Temperature sample
+    TAG_TIMESTAMP,                  ///< Timestamp
+    TAG_CONFIG_CHANGE,              ///< Configuration change
+    TAG_ACCELEROMETER_NC_T_2,       ///< Accelerometer non-compressed sample (t-2)
+    TAG_ACCELEROMETER_NC_T_1,       ///< Accelerometer non-compressed sample (t-1)
+    TAG_ACCELEROMETER_2XC,          ///< Accelerometer 2x compressed samples
+    TAG_ACCELEROMETER_3XC,          ///< Accelerometer 3x compressed samples
+    TAG_GYROSCOPE_NC_T_2,           ///< Gyroscope non-compressed sample (t-2)
+    TAG_GYROSCOPE_NC_T_1,           ///< Gyroscope non-compressed sample (t-1)
+    TAG_GYROSCOPE_2XC,              ///< Gyroscope 2x compressed samples
+    TAG_GYROSCOPE_3XC,              ///< Gyroscope 3x compressed samples
+} fifoTag_e;
+
+static uint8_t decodeFull(fifoDecoder_t* decoder, fifoSensor_e sensor, const uint8_t data[], fifoSample_t samples[]);
+static uint8_t decode2xC(fifoDecoder_t* decoder, fifoSensor_e sensor, const uint8_t data[], fifoSample_t samples[]);
+static uint8_t decode3xC(fifoDecoder_t* decoder, fifoSensor_e sensor, const uint8_t data[], fifoSample_t samples[]);
+static void    applyDifferences(fifoDecoder_t* decoder, fifoSensor_e sensor, const int16_t differences[],
+                                fifoSample_t* sample);
+
+/**
+ * @brief Reset a decoder, in order to wait for a new full sample of each sensor
+ *
+ * @param[out] decoder Decoder to reset
+ */
+void fifoDecoderReset(fifoDecoder_t* decoder) {
+    for(uint8_t sensor = 0; sensor < (uint8_t)FIFO_TEMPERATURE; sensor++) {
+        decoder->referenceValid[sensor] = 0;
+        for(uint8_t axis = 0; axis < (uint8_t)FIFO_NB_AXIS; axis++) {
+            decoder->reference[sensor][axis] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Decode a single FIFO word into samples
+ *
+ * @param[in,out] decoder Decompression context of the FIFO stream
+ * @param[in] word FIFO word (tag byte followed by the 6 data bytes)
+ * @param[out] samples Samples decoded, in chronological order (at least FIFO_MAX_SAMPLES_PER_WORD)
+ * @return Number of samples decoded (0 if the word holds no accelerometer/gyroscope/temperature data)
+ */
+uint8_t fifoDecodeWord(fifoDecoder_t* decoder, const uint8_t word[], fifoSample_t samples[]) {
+    const uint8_t* data = &word[FIRST_DATA_BYTE];
+
+    switch((fifoTag_e)(word[0] >> TAG_SENSOR_SHIFT)) {
+        case TAG_GYROSCOPE_NC:
+        case TAG_GYROSCOPE_NC_T_1:
+        case TAG_GYROSCOPE_NC_T_2:
+            return (decodeFull(decoder, FIFO_GYROSCOPE, data, samples));
+
+        case TAG_ACCELEROMETER_NC:
+        case TAG_ACCELEROMETER_NC_T_1:
+        case TAG_ACCELEROMETER_NC_T_2:
+            return (decodeFull(decoder, FIFO_ACCELEROMETER, data, samples));
+
+        case TAG_GYROSCOPE_2XC:
+            return (decode2xC(decoder, FIFO_GYROSCOPE, data, samples));
+
+        case TAG_ACCELEROMETER_2XC:
+            return (decode2xC(decoder, FIFO_ACCELEROMETER, data, samples));
+
+        case TAG_GYROSCOPE_3XC:
+            return (decode3xC(decoder, FIFO_GYROSCOPE, data, samples));
+
+        case TAG_ACCELEROMETER_3XC:
+            return (decode3xC(decoder, FIFO_ACCELEROMETER, data, samples));
+
+        case TAG_TEMPERATURE:
+            samples[0].sensor    = FIFO_TEMPERATURE;
+            samples[0].values[0] = (int16_t)((uint16_t)data[0] | (uint16_t)((uint16_t)data[1] << BYTE_SHIFT));
+            samples[0].values[1] = 0;
+            samples[0].values[2] = 0;
+            return (1);
+
+        case TAG_TIMESTAMP:
+        case TAG_CONFIG_CHANGE:
+        default:
+            return (0);
+    }
+}
+
+/**
+ * @brief Decode a non-compressed sample and use it as the new reference
+ *
+ * @param[in,out] decoder Decompression context
+ * @param sensor Sensor which measured the sample
+ * @param[in] data Data bytes of the FIFO word
+ * @param[out] samples Sample decoded
+ * @return Number of samples decoded
+ */
+static uint8_t decodeFull(fifoDecoder_t* decoder, fifoSensor_e sensor, const uint8_t data[], fifoSample_t samples[]) {
+    samples[0].sensor = sensor;
+    for(uint8_t axis = 0; axis < (uint8_t)FIFO_NB_AXIS; axis++) {
+        const uint8_t lsb = data[axis << 1U];
+        const uint8_t msb = data[(axis << 1U) + 1U];
+
+        samples[0].values[axis]          = (int16_t)((uint16_t)lsb | (uint16_t)((uint16_t)msb << BYTE_SHIFT));
+        decoder->reference[sensor][axis] = samples[0].values[axis];
+    }
+
+    decoder->referenceValid[sensor] = 1;
+    return (1);
+}
+
+/**
+ * @brief Decode two samples stored as 8-bits differences
+ *
+ * @param[in,out] decoder Decompression context
+ * @param sensor Sensor which measured the samples
+ * @param[in] data Data bytes of the FIFO word
+ * @param[out] samples Samples decoded
+ * @return Number of samples decoded (0 if no reference sample yet)
+ */
+static uint8_t decode2xC(fifoDecoder_t* decoder, fifoSensor_e sensor, const uint8_t data[], fifoSample_t samples[]) {
+    int16_t differences[FIFO_NB_AXIS];
+
+    //if no full sample received yet, differences cannot be applied
+    if(!decoder->referenceValid[sensor]) {
+        decoder->wordsDropped++;
+        return (0);
+    }
+
+    for(uint8_t sample = 0; sample < (uint8_t)NB_SAMPLES_2XC; sample++) {
+        for(uint8_t axis = 0; axis < (uint8_t)FIFO_NB_AXIS; axis++) {
+            differences[axis] = (int8_t)data[(sample * FIFO_NB_AXIS) + axis];
+        }
+        applyDifferences(decoder, sensor, differences, &samples[sample]);
+    }
+
+    return (NB_SAMPLES_2XC);
+}
+
+/**
+ * @brief Decode three samples stored as 5-bits differences
+ *
+ * @param[in,out] decoder Decompression context
+ * @param sensor Sensor which measured the samples
+ * @param[in] data Data bytes of the FIFO word
+ * @param[out] samples Samples decoded
+ * @return Number of samples decoded (0 if no reference sample yet)
+ */
+static uint8_t decode3xC(fifoDecoder_t* decoder, fifoSensor_e sensor, const uint8_t data[], fifoSample_t samples[]) {
+    int16_t differences[FIFO_NB_AXIS];
+
+    //if no full sample received yet, differences cannot be applied
+    if(!decoder->referenceValid[sensor]) {
+        decoder->wordsDropped++;
+        return (0);
+    }
+
+    for(uint8_t sample = 0; sample < (uint8_t)NB_SAMPLES_3XC; sample++) {
+        const uint8_t* bytes  = &data[sample * BYTES_PER_3XC_DIFF];
+        uint16_t       packed = (uint16_t)((uint16_t)bytes[0] | (uint16_t)((uint16_t)bytes[1] << BYTE_SHIFT));
+
+        //sign-extend each 5-bits difference
+        for(uint8_t axis = 0; axis < (uint8_t)FIFO_NB_AXIS; axis++) {
+            const uint16_t difference = packed & DIFF_5BITS_MASK;
+            differences[axis] =
+                (int16_t)((difference & DIFF_5BITS_SIGN) ? (int16_t)difference - DIFF_5BITS_EXTEND : (int16_t)difference);
+            packed >>= DIFF_5BITS_SHIFT;
+        }
+        applyDifferences(decoder, sensor, differences, &samples[sample]);
+    }
+
+    return (NB_SAMPLES_3XC);
+}
+
+/**
+ * @brief Apply differences to the reference sample of a sensor, and output the result
+ *
+ * @param[in,out] decoder Decompression context
+ * @param sensor Sensor which measured the sample
+ * @param[in] differences Differences with the previous sample on all axis
+ * @param[out] sample Sample rebuilt
+ */
+static void applyDifferences(fifoDecoder_t* decoder, fifoSensor_e sensor, const int16_t differences[],
+                             fifoSample_t* sample) {
+    sample->sensor = sensor;
+    for(uint8_t axis = 0; axis < (uint8_t)FIFO_NB_AXIS; axis++) {
+        decoder->reference[sensor][axis] =
+            (int16_t)((int32_t)decoder->reference[sensor][axis] + (int32_t)differences[axis]);
+        sample->values[axis] = decoder->reference[sensor][axis];
+    }
+}
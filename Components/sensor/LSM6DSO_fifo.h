@@ -0,0 +1,41 @@
+#ifndef LSM6DSO_FIFO_H_INCLUDED
+#define LSM6DSO_FIFO_H_INCLUDED
+#include <stdint.h>
+
+enum {
+    FIFO_WORD_NB_BYTES        = 7U,  ///< Number of bytes in a FIFO word (tag + 6 data bytes)
+    FIFO_NB_AXIS              = 3U,  ///< Number of values in a FIFO sample
+    FIFO_MAX_SAMPLES_PER_WORD = 3U,  ///< Maximum number of samples held in a single FIFO word (3xC)
+};
+
+/**
+ * @brief Enumeration of the sensors of which the samples can be decoded
+ */
+typedef enum {
+    FIFO_GYROSCOPE = 0,  ///< Gyroscope sample
+    FIFO_ACCELEROMETER,  ///< Accelerometer sample
+    FIFO_TEMPERATURE,    ///< Temperature sample (X value only)
+    NB_FIFO_SENSORS
+} fifoSensor_e;
+
+/**
+ * @brief Structure representing a single decoded sample
+ */
+typedef struct {
+    fifoSensor_e sensor;                ///< Sensor which measured the sample
+    int16_t      values[FIFO_NB_AXIS];  ///< Values of the sample (raw LSB)
+} fifoSample_t;
+
+/**
+ * @brief Structure holding the decompression context of a FIFO stream
+ */
+typedef struct {
+    int16_t  reference[FIFO_TEMPERATURE][FIFO_NB_AXIS];  ///< Latest full sample of each compressed sensor
+    uint8_t  referenceValid[FIFO_TEMPERATURE];           ///< Flags indicating a full sample has been received
+    uint32_t wordsDropped;  ///< Number of compressed words dropped for lack of a full sample to apply them to
+} fifoDecoder_t;
+
+void    fifoDecoderReset(fifoDecoder_t* decoder);
+uint8_t fifoDecodeWord(fifoDecoder_t* decoder, const uint8_t word[], fifoSample_t samples[]);
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef LSM6DSO_FILTER_H_INCLUDED
+#define LSM6DSO_FILTER_H_INCLUDED
+#include <stdint.h>
+#include "LSM6DSO.h"
+#include "LSM6DSO_profile.h"
+
+#define FILTER_GRAVITATION_MG 1000.0F  ///< Gravitation value in [mG]
+
+/**
+ * @brief Define a complementary filter step function, computed with the math functions given
+ * @details
+ *  The filter equations only exist here : the hot path (LSM6DSO.c) defines its step with the math kernels
+ *  selected in fastmath.h, and the filter monitor (LSM6DSO_monitor.c) defines its reference with libm,
+ *  so that both always compute the same filter.
+ *
+ *  The function defined is static void name(accelerometer_mG, gyroscope_radps, filteredAngles_rad,
+ *  eulerRates_radps, accelerometerValid, dtPeriod_sec) :
+ *      - the accelerometer angle estimations are skipped if accelerometerValid is 0 (only the gyroscope integrated)
+ *      - the gyroscope rates (reference is the solid body) are transformed to Euler rates (reference is Earth),
+ *        each trigonometric function being computed once
+ *      - the Euler rates integrated over dtPeriod_sec are combined with the accelerometer estimations
+ *
+ * @param name Name of the function to define
+ * @param ASIN Arcsine function (the argument may get slightly out of [-1, 1] with noise)
+ * @param ATAN Arctangent function
+ * @param SIN Sine function
+ * @param COS Cosine function
+ * @param TAN Tangent function
+ */
+#define DEFINE_COMPLEMENTARY_FILTER(name, ASIN, ATAN, SIN, COS, TAN)                                            \
+    /*NOLINTNEXTLINE(bugprone-easily-swappable-parameters)*/                                                      \
+    static void name(const float accelerometer_mG[], const float gyroscope_radps[], float filteredAngles_rad[], \
+                     float eulerRates_radps[], uint8_t accelerometerValid, float dtPeriod_sec) {                  \
+        float alpha               = PROFILE_FILTER_ALPHA;                                                         \
+        float accelEstimatedX_rad = 0.0F;                                                                         \
+        float accelEstimatedY_rad = 0.0F;                                                                         \
+                                                                                                                  \
+        if(accelerometerValid) {                                                                                  \
+            accelEstimatedX_rad = ASIN(accelerometer_mG[X_AXIS] / FILTER_GRAVITATION_MG);                         \
+            accelEstimatedY_rad = ATAN(accelerometer_mG[Y_AXIS] / accelerometer_mG[Z_AXIS]);                      \
+        } else {                                                                                                  \
+            alpha = 0.0F;                                                                                         \
+        }                                                                                                         \
+                                                                                                                  \
+        const float sinX = SIN(filteredAngles_rad[X_AXIS]);                                                       \
+        const float cosX = COS(filteredAngles_rad[X_AXIS]);                                                       \
+        const float tanY = TAN(filteredAngles_rad[Y_AXIS]);                                                       \
+                                                                                                                  \
+        const float eulerRateX_radps = gyroscope_radps[X_AXIS] + (sinX * tanY * gyroscope_radps[Y_AXIS])          \
+                                     + (cosX * tanY * gyroscope_radps[Z_AXIS]);                                   \
+        const float eulerRateY_radps = (cosX * gyroscope_radps[Y_AXIS]) - (sinX * gyroscope_radps[Z_AXIS]);       \
+                                                                                                                  \
+        filteredAngles_rad[X_AXIS] =                                                                              \
+            ((1.0F - alpha) * (filteredAngles_rad[X_AXIS] + (eulerRateX_radps * dtPeriod_sec)))                   \
+            + (alpha * accelEstimatedX_rad);                                                                      \
+        filteredAngles_rad[Y_AXIS] =                                                                              \
+            ((1.0F - alpha) * (filteredAngles_rad[Y_AXIS] + (eulerRateY_radps * dtPeriod_sec)))                   \
+            + (alpha * accelEstimatedY_rad);                                                                      \
+                                                                                                                  \
+        eulerRates_radps[X_AXIS] = eulerRateX_radps;                                                              \
+        eulerRates_radps[Y_AXIS] = eulerRateY_radps;                                                              \
+    }
+
+#endif
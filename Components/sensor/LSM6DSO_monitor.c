@@ -0,0 +1,130 @@
+/**
+ * @file LSM6DSO_monitor.c
+ * @brief Implement the monitor checking the complementary filter hot path against a libm reference
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The hot path computes the complementary filter with the math kernels selected in fastmath.h
+ *  (in-tree polynomial approximations with FASTMATH_NO_LIBM). Every MONITOR_DECIMATION steps, the filter inputs,
+ *  the angles before the step and the angles it produced are captured (a few copies in the hot path).
+ *  The same step is then recomputed in idle time with the libm functions as a golden model
+ *  (both filters being defined from the same equations, see LSM6DSO_filter.h),
+ *  and the largest deviation is kept. Each new maximum beyond MONITOR_THRESHOLD_RAD is reported.
+ *  Each step is checked from the hot path state, so the reference never drifts away on its own.
+ */
+#include "LSM6DSO_monitor.h"
+#include <math.h>
+#include <stdint.h>
+#include "LSM6DSO.h"
+#include "LSM6DSO_filter.h"
+
+static inline float clampedAsinf(float value);
+static void         referenceFilterStep(const filterMonitor_t* monitor, float angles_rad[]);
+
+/**
+ * @brief Capture a filter step computed by the hot path, to be checked in idle time
+ *
+ * @param[out] monitor Filter monitor context
+ * @param[in] accelerometer_mG Accelerometer values fed to the filter in [mG]
+ * @param[in] gyroscope_radps Gyroscope values fed to the filter in [rad/s]
+ * @param accelerometerValid 0 if the accelerometer values were ignored (gyroscope only)
+ * @param dtPeriod_sec Time period integrated by the step in [s]
+ * @param[in] anglesBefore_rad Filtered angles before the step in [rad]
+ * @param[in] anglesAfter_rad Filtered angles computed by the hot path in [rad]
+ */
+//NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+void filterMonitorCapture(filterMonitor_t* monitor, const float accelerometer_mG[], const float gyroscope_radps[],
+                          uint8_t accelerometerValid, float dtPeriod_sec, const float anglesBefore_rad[],
+                          const float anglesAfter_rad[]) {
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        monitor->accelerometer_mG[axis] = accelerometer_mG[axis];
+        monitor->gyroscope_radps[axis]  = gyroscope_radps[axis];
+    }
+
+    for(uint8_t angle = 0; angle < (uint8_t)MONITOR_NB_ANGLES; angle++) {
+        monitor->anglesBefore_rad[angle] = anglesBefore_rad[angle];
+        monitor->anglesAfter_rad[angle]  = anglesAfter_rad[angle];
+    }
+
+    monitor->accelerometerValid = accelerometerValid;
+    monitor->dtPeriod_sec       = dtPeriod_sec;
+    monitor->countdown          = MONITOR_DECIMATION - 1U;
+    monitor->pending            = 1;
+}
+
+/**
+ * @brief Recompute the step captured with the reference model, and compare it with the hot path
+ * @warning This is to be called in idle time only, the libm functions being much slower than the hot path kernels
+ *
+ * @param[in,out] monitor Filter monitor context
+ * @retval 0 No new deviation beyond the threshold (or no step captured)
+ * @retval 1 New maximum deviation beyond the threshold
+ */
+uint8_t filterMonitorCheck(filterMonitor_t* monitor) {
+    float reference_rad[MONITOR_NB_ANGLES];
+    float deviation_rad = 0.0F;
+
+    if(!monitor->pending) {
+        return (0);
+    }
+
+    referenceFilterStep(monitor, reference_rad);
+    monitor->pending = 0;
+
+    //keep the largest deviation of both angles
+    for(uint8_t angle = 0; angle < (uint8_t)MONITOR_NB_ANGLES; angle++) {
+        const float difference_rad = fabsf(monitor->anglesAfter_rad[angle] - reference_rad[angle]);
+        if(difference_rad > deviation_rad) {
+            deviation_rad = difference_rad;
+        }
+    }
+
+    //if no new maximum, nothing to report
+    if(deviation_rad <= monitor->maxDeviation_rad) {
+        return (0);
+    }
+
+    monitor->maxDeviation_rad = deviation_rad;
+    return (deviation_rad > MONITOR_THRESHOLD_RAD);
+}
+
+/**
+ * @brief Compute the arcsine with libm, the value being clamped to [-1, 1] as fastAsin() does
+ * @note Without the clamp, asinf() returns NaN as soon as the accelerometer reads more than 1000mG on X
+ *
+ * @param value Value of which compute the arcsine
+ * @return Angle in [rad], between -PI/2 and PI/2
+ */
+static inline float clampedAsinf(float value) {
+    return (asinf(fminf(fmaxf(value, -1.0F), 1.0F)));
+}
+
+/**
+ * @brief Compute a complementary filter step with the libm functions
+ *
+ * @param[in] accelerometer_mG Array of acceleration values in [mG] on all axis
+ * @param[in] gyroscope_radps Array of gyroscope values in [rad/s] on all axis
+ * @param[in,out] filteredAngles_rad Array of angle values in [rad] on X and Y axis
+ * @param[out] eulerRates_radps Array of Euler angle rates in [rad/s] on X and Y axis
+ * @param accelerometerValid 0 if the accelerometer values are to be ignored (gyroscope only)
+ * @param dtPeriod_sec Time period between two updates in [s]
+ */
+DEFINE_COMPLEMENTARY_FILTER(libmComplementaryFilter, clampedAsinf, atanf, sinf, cosf, tanf)
+
+/**
+ * @brief Recompute the step captured with the reference model
+ *
+ * @param[in] monitor Filter monitor context holding the step inputs
+ * @param[out] angles_rad Reference angles after the step in [rad]
+ */
+static void referenceFilterStep(const filterMonitor_t* monitor, float angles_rad[]) {
+    float eulerRates_radps[MONITOR_NB_ANGLES];
+
+    for(uint8_t angle = 0; angle < (uint8_t)MONITOR_NB_ANGLES; angle++) {
+        angles_rad[angle] = monitor->anglesBefore_rad[angle];
+    }
+
+    libmComplementaryFilter(monitor->accelerometer_mG, monitor->gyroscope_radps, angles_rad, eulerRates_radps,
+                            monitor->accelerometerValid, monitor->dtPeriod_sec);
+}
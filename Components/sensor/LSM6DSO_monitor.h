@@ -0,0 +1,49 @@
+#ifndef LSM6DSO_MONITOR_H_INCLUDED
+#define LSM6DSO_MONITOR_H_INCLUDED
+#include <stdint.h>
+#include "LSM6DSO.h"
+
+#define MONITOR_THRESHOLD_RAD 0.000174533F  ///< Deviation from the reference beyond which an error is raised (0.01°)
+
+enum {
+    MONITOR_DECIMATION = 16U,           ///< Number of filter steps between two steps checked
+    MONITOR_NB_ANGLES  = NB_AXIS - 1U,  ///< Number of angles checked (roll and pitch)
+};
+
+/**
+ * @brief Structure holding a filter step captured in the hot path, to be checked in idle time
+ */
+typedef struct {
+    float   accelerometer_mG[NB_AXIS];            ///< Accelerometer values fed to the filter in [mG]
+    float   gyroscope_radps[NB_AXIS];             ///< Gyroscope values fed to the filter in [rad/s]
+    float   anglesBefore_rad[MONITOR_NB_ANGLES];  ///< Filtered angles before the step in [rad]
+    float   anglesAfter_rad[MONITOR_NB_ANGLES];   ///< Filtered angles computed by the hot path in [rad]
+    float   dtPeriod_sec;                         ///< Time period integrated by the step in [s]
+    float   maxDeviation_rad;                     ///< Maximum deviation from the reference found in [rad]
+    uint8_t accelerometerValid;                   ///< Flag indicating the accelerometer values were used
+    uint8_t countdown;                            ///< Number of filter steps before the next one captured
+    uint8_t pending;                              ///< Flag indicating a step is captured and not checked yet
+} filterMonitor_t;
+
+/**
+ * @brief Check whether the next filter step is to be captured, without any cost on the others
+ *
+ * @param[in,out] monitor Filter monitor context
+ * @retval 0 Step not captured
+ * @retval 1 Step to capture (filterMonitorCapture() to be called around it)
+ */
+static inline uint8_t filterMonitorIsDue(filterMonitor_t* monitor) {
+    if(monitor->countdown) {
+        monitor->countdown--;
+        return (0);
+    }
+
+    return (!monitor->pending);
+}
+
+void    filterMonitorCapture(filterMonitor_t* monitor, const float accelerometer_mG[], const float gyroscope_radps[],
+                             uint8_t accelerometerValid, float dtPeriod_sec, const float anglesBefore_rad[],
+                             const float anglesAfter_rad[]);
+uint8_t filterMonitorCheck(filterMonitor_t* monitor);
+
+#endif
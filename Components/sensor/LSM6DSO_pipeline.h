@@ -0,0 +1,58 @@
+#ifndef LSM6DSO_PIPELINE_H_INCLUDED
+#define LSM6DSO_PIPELINE_H_INCLUDED
+
+//optional stages, enabled unless disabled by the build variant (e.g. -DPIPELINE_SPIKES=0)
+#if defined(LSM6DSO_DUAL_SENSOR)
+#define PIPELINE_ALIGNMENT 1  ///< Secondary device axis inverted (only a dual sensor has a device rotated by 180°)
+#else
+#define PIPELINE_ALIGNMENT 0  ///< Secondary device axis inverted (only a dual sensor has a device rotated by 180°)
+#endif
+#if defined(LSM6DSO_TILT_ALARM)
+#define PIPELINE_TILT_ALARM 1  ///< Tilt alarm output driven from the filtered angles (only with the alarm enabled)
+#else
+#define PIPELINE_TILT_ALARM 0  ///< Tilt alarm output driven from the filtered angles (only with the alarm enabled)
+#endif
+#if !defined(PIPELINE_SPIKES)
+#define PIPELINE_SPIKES 1  ///< Median filter and magnitude gate on the raw accelerometer samples
+#endif
+#if !defined(PIPELINE_UPSIDE_DOWN)
+#define PIPELINE_UPSIDE_DOWN 1  ///< Turned over detection (used by the automatic display orientation)
+#endif
+#if !defined(PIPELINE_GRAVITY)
+#define PIPELINE_GRAVITY 1  ///< Low-passed gravity vector (used by the slope readout)
+#endif
+
+/**
+ * @brief Measurement pipeline, from the raw LSB values to the filtered angles, in processing order
+ * @details
+ *  Each entry is STAGE(ID, function, enabled) :
+ *      - ID is the index of the stage in the profiling counters
+ *      - function is a static inline stage of LSM6DSO.c, returning 0 to stop the pipeline on this sample
+ *      - enabled is a compile-time constant, a disabled stage being removed from the composed function
+ *
+ *  Adding a stage only requires a line here and its function in LSM6DSO.c.
+ */
+#define LSM6DSO_PIPELINE(STAGE)                                                 \
+    STAGE(STAGE_ALIGNMENT,     stageAlignDevice,          PIPELINE_ALIGNMENT)   \
+    STAGE(STAGE_MOUNTING,      stageRotateMounting,       1)                    \
+    STAGE(STAGE_TEMPERATURE,   stageConvertTemperature,   1)                    \
+    STAGE(STAGE_SPIKES,        stageRejectSpikes,         PIPELINE_SPIKES)      \
+    STAGE(STAGE_ACCELEROMETER, stageConvertAccelerometer, 1)                    \
+    STAGE(STAGE_UPSIDE_DOWN,   stageDetectUpsideDown,     PIPELINE_UPSIDE_DOWN) \
+    STAGE(STAGE_GRAVITY,       stageFilterGravity,        PIPELINE_GRAVITY)     \
+    STAGE(STAGE_GYROSCOPE,     stageConvertGyroscope,     1)                    \
+    STAGE(STAGE_FILTER,        stageComplementaryFilter,  1)                    \
+    STAGE(STAGE_TILT_ALARM,    stageTiltAlarm,            PIPELINE_TILT_ALARM)
+
+#define PIPELINE_STAGE_ID(id, function, enabled) id,  ///< Expand a pipeline stage to its ID
+
+/**
+ * @brief Enumeration of the measurement pipeline stages
+ */
+typedef enum {
+    LSM6DSO_PIPELINE(PIPELINE_STAGE_ID) NB_PIPELINE_STAGES
+} pipelineStage_e;
+
+#undef PIPELINE_STAGE_ID
+
+#endif
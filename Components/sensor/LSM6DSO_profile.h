@@ -0,0 +1,12 @@
+#ifndef LSM6DSO_PROFILE_H_INCLUDED
+#define LSM6DSO_PROFILE_H_INCLUDED
+
+//default profile (datasheet typical noise densities, bias instabilities not characterised), see tools/allan.py
+#define PROFILE_GYR_WHITE_NOISE_RADPS_RTHZ 6.632251e-05F  ///< Gyroscope white noise (ARW) in [rad/s/sqrt(Hz)]
+#define PROFILE_GYR_BIAS_INSTABILITY_RADPS 0.000000e+00F  ///< Gyroscope bias instability in [rad/s]
+#define PROFILE_AXL_WHITE_NOISE_MG_RTHZ    7.000000e-02F  ///< Accelerometer white noise (VRW) in [mG/sqrt(Hz)]
+#define PROFILE_AXL_BIAS_INSTABILITY_MG    0.000000e+00F  ///< Accelerometer bias instability in [mG]
+#define PROFILE_FILTER_TIME_CONSTANT_S     1.177885e-01F  ///< Complementary filter time constant in [s]
+#define PROFILE_FILTER_ALPHA               2.000000e-02F  ///< Accelerometer proportion in the complementary filter
+
+#endif
@@ -5,31 +5,59 @@
 #define LSM6_READ             0x80U  ///< Address byte value for a read operation
 #define LSM6_NB_OUT_REGISTERS 12U    ///< Number of output data registers for the accelerometer and the gyroscope
 
+// FIFO control register 2 (0x08) values
+#define FIFO_COMPRESSION_RUNTIME   0x40U  ///< Bit value to enable the FIFO compression at runtime
+#define FIFO_UNCOMPRESSED_32_BDR   0x06U  ///< Bit value to force a non-compressed sample every 32 batch data rate
+#define FIFO_UNCOMPRESSED_DISABLED 0x00U  ///< Bit value to never force non-compressed samples
+
+// FIFO control register 3 (0x09) values
+#define FIFO_BDR_XL_416HZ 0x06U  ///< Bit value to batch the accelerometer in the FIFO at 416Hz
+#define FIFO_BDR_GY_416HZ 0x60U  ///< Bit value to batch the gyroscope in the FIFO at 416Hz
+
 // FIFO control register 4 (0x0A) values
-#define FIFO_MODE_BYPASS 0x00U  ///< Bit value to disable the FIFO
+#define FIFO_MODE_BYPASS     0x00U  ///< Bit value to disable the FIFO
+#define FIFO_MODE_CONTINUOUS 0x06U  ///< Bit value to set the FIFO in continuous mode (oldest values overwritten)
+#define FIFO_TEMP_BATCH_52HZ 0x30U  ///< Bit value to batch the temperature in the FIFO at 52Hz
 
 // INT1 pin control register (0x0D) values
-#define INT1_AXL_DATA_RDY 0x01U  ///< Bit value to enable the accelerometer data-ready interrupt on INT1
+#define INT1_AXL_DATA_RDY   0x01U  ///< Bit value to enable the accelerometer data-ready interrupt on INT1
+#define INT1_FIFO_THRESHOLD 0x08U  ///< Bit value to enable the FIFO threshold interrupt on INT1
+
+// FIFO status register 2 (0x3B) values
+#define FIFO_DIFF_MSB_MASK 0x03U  ///< Mask of the 2 MSB of the number of unread FIFO words
 
 // WhoAmI register (0x0F) values
 #define LSM6_WHOAMI 0x6CU  ///< Who Am I constant value
 
 // Accelerometer Control register (0x10) values
 #define LSM6_POWER_DOWN      0x00U  ///< Accelerometer/gyroscope ODR value for power-down
+#define LSM6_ODR_52HZ        0x30U  ///< Accelerometer/gyroscope ODR value for 52Hz
+#define LSM6_ODR_208HZ       0x50U  ///< Accelerometer/gyroscope ODR value for 208Hz
 #define LSM6_ODR_416HZ       0x60U  ///< Accelerometer/gyroscope ODR value for 416Hz High-Performance
+#define AXL_FS_4G            0x08U  ///< Bit value used to set the accelerometer full scale to 4G
 #define LSM6_AXL_LPF2_ENABLE 0x02U  ///< Bit value to enable the accelerometers LP filter 2
 
 // Accelerometer Control register (0x10) values
-#define GYR_FS_125_DPS 0x02U  ///< Bit value used to force gyroscope sensitivity to 125 °/s
+#define GYR_FS_125_DPS  0x02U  ///< Bit value used to force gyroscope sensitivity to 125 °/s
+#define GYR_FS_2000_DPS 0x0CU  ///< Bit value used to set the gyroscope full scale to 2000 °/s
 
 // Control register 3 (0x12) values
-#define LSM6_REBOOT_MEMORY  0x80U  ///< Bit value to reboot the LSM6DSO memory
-#define LSM6_INT_ACTIVE_LOW 0x20U  ///< Bit value to set interrupts as active low (falling-edge)
-#define LSM6_SOFTWARE_RESET 0x01U  ///< Bit value to reset the LSM6DSO software
+#define LSM6_REBOOT_MEMORY     0x80U  ///< Bit value to reboot the LSM6DSO memory
+#define LSM6_BLOCK_DATA_UPDATE 0x40U  ///< Bit value to update the output registers only once both bytes are read
+#define LSM6_INT_ACTIVE_LOW    0x20U  ///< Bit value to set interrupts as active low (falling-edge)
+#define LSM6_AUTO_INCREMENT    0x04U  ///< Bit value to increment the register address during multiple accesses
+#define LSM6_SOFTWARE_RESET    0x01U  ///< Bit value to reset the LSM6DSO software
 
 // Control register 4 (0x13) values
 #define GYR_LPF1_ENABLE 0x02U  ///< Bit value to enable gyroscope LP1 filter
 
+// Control register 5 (0x14) values
+#define LSM6_SELFTEST_DISABLED 0x00U  ///< Bit value to disable the accelerometer and gyroscope self-tests
+#define AXL_SELFTEST_POSITIVE  0x01U  ///< Bit value to enable the accelerometer positive self-test
+#define AXL_SELFTEST_NEGATIVE  0x02U  ///< Bit value to enable the accelerometer negative self-test
+#define GYR_SELFTEST_POSITIVE  0x04U  ///< Bit value to enable the gyroscope positive self-test
+#define GYR_SELFTEST_NEGATIVE  0x0CU  ///< Bit value to enable the gyroscope negative self-test
+
 // Control register 6 (0x15) values (valid with gyroscope 416Hz ODR)
 #define GYR_LPF1_CUTOFF_136_6HZ 0x00U  ///< Bit value to set gyroscope LPF1 cutoff freq. to 136.6Hz
 #define GYR_LPF1_CUTOFF_130_5HZ 0x01U  ///< Bit value to set gyroscope LPF1 cutoff freq. to 130.5Hz
@@ -58,11 +86,32 @@
 #define AXL_LPF2_ODR_400 0xC0U  ///< Bit value to set the accelerometer's LP filter 2 cutoff value to ODR/400
 #define AXL_LPF2_ODR_800 0xE0U  ///< Bit value to set the accelerometer's LP filter 2 cutoff value to ODR/800
 
+// Control register 10 (0x19) values
+#define LSM6_TIMESTAMP_ENABLE 0x20U  ///< Bit value to enable the timestamp counter (25us LSB)
+
+// Tap source register (0x1C) values
+#define TAP_SRC_DOUBLE_TAP 0x10U  ///< Bit value indicating a double tap has been detected
+#define TAP_SRC_SINGLE_TAP 0x20U  ///< Bit value indicating a single tap has been detected
+
 // Status register (0x1E) values
 #define LSM6_AXL_DATA_AVAIL 0x01U  ///< Bit value indicating new accelerometer reading is available
 #define LSM6_GYR_DATA_AVAIL 0x02U  ///< Bit value indicating new gyroscope reading is available
 #define LSM6_TMP_DATA_AVAIL 0x04U  ///< Bit value indicating new temperature reading is available
 
+// Tap configuration registers (0x56 to 0x5B) values (durations valid with the accelerometer at 416Hz)
+#define TAP_LATCHED_CLEAR_ON_READ 0x41U  ///< Bit value to latch the tap interrupts until the source register is read
+#define TAP_XYZ_ENABLE            0x0EU  ///< Bit value to detect taps on the X, Y and Z axis
+#define TAP_INTERRUPTS_ENABLE     0x80U  ///< Bit value to enable the basic interrupts (tap, wake-up, 6D)
+#define TAP_THRESHOLD_750MG       0x0CU  ///< Tap threshold on an axis (FS/32 per LSB, so 750mG at 2G full scale)
+#define TAP_DURATION_538MS        0x70U  ///< Maximum time between the two taps of a double tap (7 * 32 / ODR)
+#define TAP_QUIET_29MS            0x0CU  ///< Time after a tap during which no other tap is detected (3 * 4 / ODR)
+#define TAP_SHOCK_58MS            0x03U  ///< Maximum duration of an over-threshold tap (3 * 8 / ODR)
+#define TAP_SINGLE_AND_DOUBLE     0x80U  ///< Bit value to detect both single and double taps
+
+// Functions routing on INT2 register (0x5F) values
+#define INT2_DOUBLE_TAP 0x08U  ///< Bit value to route the double tap events on INT2
+#define INT2_SINGLE_TAP 0x40U  ///< Bit value to route the single tap events on INT2
+
 // Embedded Function register (0x01) values
 #define LSM6_ENABLE_EMB_FUNCT  0x80U  ///< Enable the embedded function register access
 #define LSM6_DISABLE_FUNCTIONS 0x00U  ///< Disable the embedded function and sensor hub registers access
@@ -72,6 +121,10 @@
 #define LSM6_ENABLE_PG_READ  0x20U  ///< Enable read operations to an embedded function page
 #define LSM6_DISABLE_PG_RDWR 0x00U  ///< Disable read/write operations on embedded functions
 
+// Embedded functions enable register B (0x05) values
+#define EMB_FIFO_COMPRESSION_ENABLE  0x08U  ///< Bit value to enable the FIFO compression feature
+#define EMB_FIFO_COMPRESSION_DISABLE 0x00U  ///< Bit value to disable the FIFO compression feature
+
 // Page selection register (0x02) values
 #define LSM6_PG_SELECT_DEFAULT 0x01U  ///< Value of the 4 lower bits needed for correct operation
 
@@ -125,10 +178,10 @@ typedef enum {
     STATUS_MASTER_MAINPAGE = 0x39U,    ///< 0x39 - RO : Sensor hub source register
     FIFO_STATUS1,                      ///< 0x3A - RO : FIFO status register 1
     FIFO_STATUS2,                      ///< 0x3B - RO : FIFO status register 2
-    TIMESTAMP0 = 0x40U,                ///< 0x40 - RO : Timestamp first data output register, bits [31-24]
-    TIMESTAMP1,                        ///< 0x41 - RO : Timestamp first data output register, bits [23-16]
-    TIMESTAMP2,                        ///< 0x42 - RO : Timestamp first data output register, bits [15-8]
-    TIMESTAMP3,                        ///< 0x43 - RO : Timestamp first data output register, bits [7-0]
+    TIMESTAMP0 = 0x40U,                ///< 0x40 - RO : Timestamp first data output register, bits [7-0]
+    TIMESTAMP1,                        ///< 0x41 - RO : Timestamp second data output register, bits [15-8]
+    TIMESTAMP2,                        ///< 0x42 - RO : Timestamp third data output register, bits [23-16]
+    TIMESTAMP3,                        ///< 0x43 - RO : Timestamp fourth data output register, bits [31-24]
     TAP_CFG0 = 0x56U,  ///< 0x56 - RW : Activity/inactivity functions, configuration of filtering, and tap recognition
                        ///< functions
     TAP_CFG1,          ///< 0x57 - RW : Tap configuration register
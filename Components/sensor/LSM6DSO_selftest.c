@@ -0,0 +1,216 @@
+/**
+ * @file LSM6DSO_selftest.c
+ * @brief Implement the LSM6DSO accelerometer and gyroscope self-test procedure
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Each sensor is measured without stimulus, then with the positive and the negative self-test stimulus.
+ *  The averages of the stimulated steps are compared to the average without stimulus,
+ *  and each axis difference must lie within the datasheet limits.
+ *  The results are cached in a backup register, to be reused after a warm reset (the MEMS being still powered).
+ *
+ * @note Additional information can be found in :
+ *   - Datasheet (self-test output change, Table 3 and 4) : https://www.st.com/resource/en/datasheet/lsm6dso.pdf
+ *   - AN5192 (self-test procedure, section 11) : https://www.st.com/resource/en/application_note/an5192-lsm6dso-alwayson-3axis-accelerometer-and-3axis-gyroscope-stmicroelectronics.pdf
+ */
+#include "LSM6DSO_selftest.h"
+#include <stdint.h>
+#include "LSM6DSO_registers.h"
+#include "stm32f103xb.h"
+#include "stm32f1xx_ll_bus.h"
+#include "stm32f1xx_ll_pwr.h"
+#include "stm32f1xx_ll_rcc.h"
+
+enum {
+    NB_SELFTEST_STEPS  = 6U,       ///< Number of steps in the self-test procedure
+    AXL_MIN_DELTA_LSB  = 410,      ///< Minimum accelerometer self-test difference (50mG at 0.122mG/LSB)
+    AXL_MAX_DELTA_LSB  = 13934,    ///< Maximum accelerometer self-test difference (1700mG at 0.122mG/LSB)
+    GYR_MIN_DELTA_LSB  = 2143,     ///< Minimum gyroscope self-test difference (150dps at 70mdps/LSB)
+    GYR_MAX_DELTA_LSB  = 10000,    ///< Maximum gyroscope self-test difference (700dps at 70mdps/LSB)
+    CACHE_MAGIC        = 0xA500U,  ///< Value of the cache MSB indicating the backup register holds results
+    CACHE_MAGIC_MASK   = 0xFF00U,  ///< Mask of the magic value in the backup register
+    CACHE_RESULT_MASK  = 0x07U,    ///< Mask of a device result in the backup register
+    CACHE_RESULT_SHIFT = 4U,       ///< Shift between the results of two consecutive devices
+};
+
+/**
+ * @brief Steps of the self-test procedure (see AN5192, Figure 37 and 38)
+ * @note The accelerometer is tested at 52Hz and 4G, the gyroscope at 208Hz and 2000dps
+ */
+static const selfTestStep_t STEPS[NB_SELFTEST_STEPS] = {
+    {SELFTEST_ACCELEROMETER, LSM6_ODR_52HZ | AXL_FS_4G,                                 LSM6_POWER_DOWN, LSM6_SELFTEST_DISABLED, 0},
+    {SELFTEST_ACCELEROMETER, LSM6_ODR_52HZ | AXL_FS_4G,                                 LSM6_POWER_DOWN,  AXL_SELFTEST_POSITIVE, 1},
+    {SELFTEST_ACCELEROMETER, LSM6_ODR_52HZ | AXL_FS_4G,                                 LSM6_POWER_DOWN,  AXL_SELFTEST_NEGATIVE, 1},
+    {    SELFTEST_GYROSCOPE,           LSM6_POWER_DOWN, LSM6_ODR_208HZ | GYR_FS_2000_DPS, LSM6_SELFTEST_DISABLED, 0},
+    {    SELFTEST_GYROSCOPE,           LSM6_POWER_DOWN, LSM6_ODR_208HZ | GYR_FS_2000_DPS,  GYR_SELFTEST_POSITIVE, 1},
+    {    SELFTEST_GYROSCOPE,           LSM6_POWER_DOWN, LSM6_ODR_208HZ | GYR_FS_2000_DPS,  GYR_SELFTEST_NEGATIVE, 1},
+};
+
+static uint8_t isWithinLimits(selfTestSensor_e sensor, const int16_t baseline_LSB[], const int16_t average_LSB[]);
+
+/**
+ * @brief Reset a self-test context to start the procedure from its first step
+ *
+ * @param[out] test Self-test context to reset
+ */
+void selfTestStart(selfTest_t* test) {
+    test->step      = 0;
+    test->nbSamples = 0;
+    test->failures  = 0;
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        test->sums_LSB[axis]     = 0;
+        test->baseline_LSB[axis] = 0;
+    }
+}
+
+/**
+ * @brief Get the registers configuration of the current step
+ *
+ * @param[in] test Self-test context
+ * @return Current step (NULL if the procedure is finished)
+ */
+const selfTestStep_t* selfTestGetStep(const selfTest_t* test) {
+    return (test->step < (uint8_t)NB_SELFTEST_STEPS ? &STEPS[test->step] : (void*)0);
+}
+
+/**
+ * @brief Add a sample of the sensor tested to the current step, and evaluate the step once complete
+ *
+ * @param[in,out] test Self-test context
+ * @param[in] values_LSB Raw values of the sensor tested on all axis
+ * @retval 0 Step still needs samples
+ * @retval 1 Step complete (the next one can be configured)
+ */
+uint8_t selfTestAddSample(selfTest_t* test, const int16_t values_LSB[]) {
+    int16_t average_LSB[NB_AXIS];
+
+    //if procedure finished, nothing to add
+    if(test->step >= (uint8_t)NB_SELFTEST_STEPS) {
+        return (1);
+    }
+
+    //accumulate the sample, and exit if more are needed
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        test->sums_LSB[axis] += values_LSB[axis];
+    }
+    test->nbSamples++;
+    if(test->nbSamples < (uint8_t)SELFTEST_NB_SAMPLES) {
+        return (0);
+    }
+
+    //average the samples and restart the sums for the next step
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        average_LSB[axis]    = (int16_t)(test->sums_LSB[axis] / (int32_t)SELFTEST_NB_SAMPLES);
+        test->sums_LSB[axis] = 0;
+    }
+    test->nbSamples = 0;
+
+    //compare the stimulated steps with the latest one without stimulus, which becomes the baseline otherwise
+    const selfTestStep_t* step = &STEPS[test->step];
+    if(step->stimulated) {
+        if(!isWithinLimits(step->sensor, test->baseline_LSB, average_LSB)) {
+            test->failures |= (uint8_t)(step->sensor == SELFTEST_ACCELEROMETER ? SELFTEST_ACCELEROMETER_FAILED
+                                                                                : SELFTEST_GYROSCOPE_FAILED);
+        }
+    } else {
+        for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+            test->baseline_LSB[axis] = average_LSB[axis];
+        }
+    }
+
+    test->step++;
+    return (1);
+}
+
+/**
+ * @brief Get the result of a self-test procedure
+ *
+ * @param[in] test Self-test context
+ * @return Result of the procedure (lsm6dsoSelfTest_e flags)
+ */
+uint8_t selfTestGetResult(const selfTest_t* test) {
+    if(test->step < (uint8_t)NB_SELFTEST_STEPS) {
+        return (SELFTEST_PENDING);
+    }
+
+    return (test->failures ? test->failures : (uint8_t)SELFTEST_PASSED);
+}
+
+/**
+ * @brief Get the result cached for a device, if the MCU has been warm reset
+ * @attention This must be called before the reset flags are cleared
+ *
+ * @param deviceIndex Index of the device
+ * @return Result cached (lsm6dsoSelfTest_e flags, SELFTEST_PENDING if none or after a power-on reset)
+ */
+uint8_t selfTestLoadCache(uint8_t deviceIndex) {
+    //if power-on reset, the MEMS has been power cycled and must be tested again
+    if(LL_RCC_IsActiveFlag_PORRST()) {
+        return (SELFTEST_PENDING);
+    }
+
+    //if backup register does not hold results, no cache
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_BKP);
+    const uint16_t cache = (uint16_t)READ_REG(BKP->DR1);
+    if((cache & CACHE_MAGIC_MASK) != CACHE_MAGIC) {
+        return (SELFTEST_PENDING);
+    }
+
+    const uint8_t cachedResult = (uint8_t)((cache >> (deviceIndex * CACHE_RESULT_SHIFT)) & CACHE_RESULT_MASK);
+    return (cachedResult ? (uint8_t)(cachedResult | SELFTEST_FROM_CACHE) : (uint8_t)SELFTEST_PENDING);
+}
+
+/**
+ * @brief Store the result of a device in the backup register
+ *
+ * @param deviceIndex Index of the device
+ * @param testResult Result of the procedure (lsm6dsoSelfTest_e flags)
+ */
+void selfTestStoreCache(uint8_t deviceIndex, uint8_t testResult) {
+    const uint16_t shift = (uint16_t)(deviceIndex * CACHE_RESULT_SHIFT);
+
+    //allow writing in the backup domain
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR | LL_APB1_GRP1_PERIPH_BKP);
+    LL_PWR_EnableBkUpAccess();
+
+    //if no results cached yet, start from an empty cache
+    uint16_t cache = (uint16_t)READ_REG(BKP->DR1);
+    if((cache & CACHE_MAGIC_MASK) != CACHE_MAGIC) {
+        cache = CACHE_MAGIC;
+    }
+
+    //replace the result of the device
+    cache &= (uint16_t)~(uint16_t)(CACHE_RESULT_MASK << shift);
+    cache |= (uint16_t)((testResult & CACHE_RESULT_MASK) << shift);
+    WRITE_REG(BKP->DR1, cache);
+
+    LL_PWR_DisableBkUpAccess();
+}
+
+/**
+ * @brief Check if the self-test differences of all axis lie within the datasheet limits
+ *
+ * @param sensor Sensor tested
+ * @param[in] baseline_LSB Averages without stimulus
+ * @param[in] average_LSB Averages with stimulus
+ * @retval 0 At least one axis out of the limits
+ * @retval 1 All axis within the limits
+ */
+static uint8_t isWithinLimits(selfTestSensor_e sensor, const int16_t baseline_LSB[], const int16_t average_LSB[]) {
+    const int32_t minimum = (sensor == SELFTEST_ACCELEROMETER ? AXL_MIN_DELTA_LSB : GYR_MIN_DELTA_LSB);
+    const int32_t maximum = (sensor == SELFTEST_ACCELEROMETER ? AXL_MAX_DELTA_LSB : GYR_MAX_DELTA_LSB);
+
+    for(uint8_t axis = 0; axis < (uint8_t)NB_AXIS; axis++) {
+        int32_t delta = (int32_t)average_LSB[axis] - (int32_t)baseline_LSB[axis];
+        if(delta < 0) {
+            delta = -delta;
+        }
+
+        if((delta < minimum) || (delta > maximum)) {
+            return (0);
+        }
+    }
+
+    return (1);
+}
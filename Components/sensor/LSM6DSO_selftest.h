@@ -0,0 +1,48 @@
+#ifndef LSM6DSO_SELFTEST_H_INCLUDED
+#define LSM6DSO_SELFTEST_H_INCLUDED
+#include <stdint.h>
+#include "LSM6DSO.h"
+
+enum {
+    SELFTEST_NB_SAMPLES  = 5U,    ///< Number of samples averaged at each step
+    SELFTEST_SETTLING_MS = 100U,  ///< Number of milliseconds to wait for the outputs to settle after each step change
+};
+
+/**
+ * @brief Enumeration of the sensors tested
+ */
+typedef enum {
+    SELFTEST_ACCELEROMETER = 0,  ///< Accelerometer tested
+    SELFTEST_GYROSCOPE,          ///< Gyroscope tested
+} selfTestSensor_e;
+
+/**
+ * @brief Structure representing a single step of the self-test procedure
+ */
+typedef struct {
+    selfTestSensor_e sensor;      ///< Sensor measured during the step
+    uint8_t          ctrl1XL;     ///< Value of the CTRL1_XL register (accelerometer ODR and full scale)
+    uint8_t          ctrl2G;      ///< Value of the CTRL2_G register (gyroscope ODR and full scale)
+    uint8_t          ctrl5C;      ///< Value of the CTRL5_C register (self-test stimulus)
+    uint8_t          stimulated;  ///< Flag indicating the step is compared to the latest non-stimulated one
+} selfTestStep_t;
+
+/**
+ * @brief Structure holding the context of a self-test procedure
+ */
+typedef struct {
+    int32_t sums_LSB[NB_AXIS];      ///< Sums of the samples of the current step
+    int16_t baseline_LSB[NB_AXIS];  ///< Average of the latest step without stimulus
+    uint8_t step;                   ///< Index of the current step
+    uint8_t nbSamples;              ///< Number of samples summed in the current step
+    uint8_t failures;               ///< Sensors out of the datasheet limits (lsm6dsoSelfTest_e flags)
+} selfTest_t;
+
+void                  selfTestStart(selfTest_t* test);
+const selfTestStep_t* selfTestGetStep(const selfTest_t* test);
+uint8_t               selfTestAddSample(selfTest_t* test, const int16_t values_LSB[]);
+uint8_t               selfTestGetResult(const selfTest_t* test);
+uint8_t               selfTestLoadCache(uint8_t deviceIndex);
+void                  selfTestStoreCache(uint8_t deviceIndex, uint8_t testResult);
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file fusion.c
+ * @brief Implement the fusion of the angles measured by several MEMS sensors
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Both devices being filtered separately, their angles are simply averaged,
+ *  which divides the uncorrelated noise variance by 2.
+ *  A disagreement above a threshold indicates one of the devices is faulty or has shifted on the PCB.
+ */
+#include "fusion.h"
+#include "fastmath.h"
+
+/**
+ * @brief Average the angles of two devices and check whether they disagree
+ *
+ * @param[in] primary_rad Angles measured by the primary device in [rad]
+ * @param[in] secondary_rad Angles measured by the secondary device in [rad]
+ * @param[out] fused_rad Averaged angles in [rad]
+ * @param nbAngles Number of angles in each array
+ * @param maxDisagreement_rad Maximum difference allowed between two angles in [rad]
+ * @retval 0 Devices agree on all the angles
+ * @retval 1 At least one angle differs by more than the maximum allowed
+ */
+//NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+uint8_t fuseAngles(const float primary_rad[], const float secondary_rad[], float fused_rad[], uint8_t nbAngles,
+                   float maxDisagreement_rad) {
+    const float HALF         = 0.5F;
+    uint8_t     disagreement = 0;
+
+    for(uint8_t angle = 0; angle < nbAngles; angle++) {
+        fused_rad[angle] = (primary_rad[angle] + secondary_rad[angle]) * HALF;
+
+        if(MATH_ABS(primary_rad[angle] - secondary_rad[angle]) > maxDisagreement_rad) {
+            disagreement = 1;
+        }
+    }
+
+    return (disagreement);
+}
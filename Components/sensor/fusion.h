@@ -0,0 +1,8 @@
+#ifndef FUSION_H_INCLUDED
+#define FUSION_H_INCLUDED
+#include <stdint.h>
+
+uint8_t fuseAngles(const float primary_rad[], const float secondary_rad[], float fused_rad[], uint8_t nbAngles,
+                   float maxDisagreement_rad);
+
+#endif
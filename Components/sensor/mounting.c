@@ -0,0 +1,264 @@
+/**
+ * @file mounting.c
+ * @brief Implement the rotation of the sensor vectors from the PCB axis to the tool axis
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The rotation is made of a fixed mounting variant, selected at compile time (axis permutation and signs),
+ *  followed by a small correction calibrated on the tool and stored in flash.
+ *  Both are multiplied once at boot into a single Q14 matrix, so rotating a raw vector always costs
+ *  9 integer multiply-accumulates, whatever the mounting.
+ */
+#include "mounting.h"
+#include <stdint.h>
+#include "fastmath.h"
+#include "storage.h"
+
+#define MIN_CALIBRATION_COSINE 0.866025F  ///< Cosine of the max. angle between the gravity and Z when calibrating (30°)
+#define ROUNDING_HALF          0.5F       ///< Value added before truncating a float to round it
+#define NEWTON_THREE_HALFS     1.5F       ///< Constant of the Newton-Raphson inverse square root iteration
+#define NEWTON_HALF            0.5F       ///< Factor of the Newton-Raphson inverse square root iteration
+
+enum {
+    Q14_SHIFT    = 14U,      ///< Number of fractional bits in the Q14 format
+    Q14_ROUNDING = 8192,     ///< Value added before shifting a Q14 product to round it (0.5 in Q14)
+    RECORD_MAGIC = 0x4D54U,  ///< Value identifying a mounting record in flash ("MT")
+    RECORD_ALIGN = 2,        ///< Alignment of the record (flash written by half-words)
+};
+
+/**
+ * @brief Enumeration of all the function ID used in errors
+ */
+typedef enum {
+    CALIBRATE = 1,  ///< mountingCalibrate() function
+} mountingFunction_e;
+
+/**
+ * @brief Structure representing the calibration record stored in flash
+ */
+typedef struct {
+    uint16_t magic;                                              ///< Value identifying the record
+    int16_t  correction_Q14[MOUNTING_NB_AXIS][MOUNTING_NB_AXIS];  ///< Correction applied after the fixed variant
+    uint16_t checksum;                                           ///< One's complement of the sum of the half-words
+} __attribute__((aligned(RECORD_ALIGN))) mountingRecord_t;
+
+/**
+ * @brief Fixed mounting variant, mapping the PCB axis to the tool axis
+ */
+static const int16_t FIXED_Q14[MOUNTING_NB_AXIS][MOUNTING_NB_AXIS] = {
+#if defined(MOUNTING_ROTATED_90)
+  //PCB rotated by 90° counter-clockwise around Z
+    {               0, -MOUNTING_Q14_ONE,                0},
+    {MOUNTING_Q14_ONE,                 0,                0},
+    {               0,                 0, MOUNTING_Q14_ONE},
+#elif defined(MOUNTING_ROTATED_180)
+  //PCB rotated by 180° around Z
+    {-MOUNTING_Q14_ONE,                 0,                0},
+    {                0, -MOUNTING_Q14_ONE,                0},
+    {                0,                 0, MOUNTING_Q14_ONE},
+#elif defined(MOUNTING_ROTATED_270)
+  //PCB rotated by 90° clockwise around Z
+    {                0, MOUNTING_Q14_ONE,                0},
+    {-MOUNTING_Q14_ONE,                0,                0},
+    {                0,                0, MOUNTING_Q14_ONE},
+#elif defined(MOUNTING_UPSIDE_DOWN)
+  //PCB components facing down (rotated by 180° around X)
+    {MOUNTING_Q14_ONE,                 0,                 0},
+    {               0, -MOUNTING_Q14_ONE,                 0},
+    {               0,                 0, -MOUNTING_Q14_ONE},
+#elif defined(MOUNTING_VERTICAL)
+  //PCB standing on its edge, its Y axis pointing up
+    {MOUNTING_Q14_ONE,                0,                 0},
+    {               0,                0, -MOUNTING_Q14_ONE},
+    {               0, MOUNTING_Q14_ONE,                 0},
+#else
+  //PCB axis matching the tool axis
+    {MOUNTING_Q14_ONE,                0,                0},
+    {               0, MOUNTING_Q14_ONE,                0},
+    {               0,                0, MOUNTING_Q14_ONE},
+#endif
+};
+
+static int16_t correction_Q14[MOUNTING_NB_AXIS][MOUNTING_NB_AXIS];  ///< Calibrated correction (tool axis)
+static int16_t rotation_Q14[MOUNTING_NB_AXIS][MOUNTING_NB_AXIS];    ///< Full rotation (correction x fixed variant)
+
+static void           multiplyMatrices(const int16_t left_Q14[][MOUNTING_NB_AXIS],
+                                       const int16_t right_Q14[][MOUNTING_NB_AXIS],
+                                       int16_t       product_Q14[][MOUNTING_NB_AXIS]);
+static uint16_t       computeChecksum(const mountingRecord_t* record);
+static inline int16_t saturateQ14(int32_t value);
+static inline int16_t floatToQ14(float value);
+
+/**
+ * @brief Load the calibrated correction from flash and compute the full rotation
+ */
+void mountingInitialise(void) {
+    const mountingRecord_t* record = storageGetPage(STORAGE_MOUNTING);
+    const uint8_t valid = (record && (record->magic == RECORD_MAGIC) && (record->checksum == computeChecksum(record)));
+
+    //use the correction stored, or no correction if none calibrated yet
+    for(uint8_t row = 0; row < (uint8_t)MOUNTING_NB_AXIS; row++) {
+        for(uint8_t column = 0; column < (uint8_t)MOUNTING_NB_AXIS; column++) {
+            correction_Q14[row][column] =
+                (valid ? record->correction_Q14[row][column] : (row == column ? MOUNTING_Q14_ONE : 0));
+        }
+    }
+
+    multiplyMatrices(correction_Q14, FIXED_Q14, rotation_Q14);
+}
+
+/**
+ * @brief Rotate a raw vector from the PCB axis to the tool axis
+ *
+ * @param[in,out] vector_LSB Raw vector on all axis
+ */
+void mountingRotate(int16_t vector_LSB[]) {
+    int32_t rotated[MOUNTING_NB_AXIS];
+
+    for(uint8_t row = 0; row < (uint8_t)MOUNTING_NB_AXIS; row++) {
+        rotated[row] = Q14_ROUNDING;
+        for(uint8_t column = 0; column < (uint8_t)MOUNTING_NB_AXIS; column++) {
+            rotated[row] += (int32_t)rotation_Q14[row][column] * (int32_t)vector_LSB[column];
+        }
+    }
+
+    for(uint8_t row = 0; row < (uint8_t)MOUNTING_NB_AXIS; row++) {
+        vector_LSB[row] = saturateQ14(rotated[row]);
+    }
+}
+
+/**
+ * @brief Calibrate the correction so that the current gravity vector lies on the tool Z axis, and store it
+ * @details
+ *  The correction is the smallest rotation bringing the gravity onto Z (Rodrigues formula),
+ *  applied on top of the previous correction. The heading around Z is left to the fixed variant.
+ *
+ * @param[in] gravity_mG Gravity vector measured in the tool axis in [mG]
+ * @retval 0 Success
+ * @retval 1 Gravity too far from the Z axis (wrong fixed variant or tool not laid flat)
+ * @retval 2 Error while erasing the flash page
+ * @retval 3 Error while writing the flash page
+ */
+errorCode_u mountingCalibrate(const float gravity_mG[]) {
+    int16_t          alignment_Q14[MOUNTING_NB_AXIS][MOUNTING_NB_AXIS];
+    mountingRecord_t record;
+    errorCode_u      result;
+
+    //normalise the gravity vector, and make sure it is close enough to Z
+    const float normSquared = (gravity_mG[0] * gravity_mG[0]) + (gravity_mG[1] * gravity_mG[1])
+                            + (gravity_mG[2] * gravity_mG[2]);
+    if(normSquared <= 0.0F) {
+        return (createErrorCode(CALIBRATE, 1, ERR_WARNING));
+    }
+
+    //refine the inverse norm with a second Newton-Raphson iteration, to keep the rotation orthonormal
+    float inverseNorm = fastInverseSqrt(normSquared);
+    inverseNorm *= NEWTON_THREE_HALFS - (NEWTON_HALF * normSquared * inverseNorm * inverseNorm);
+    const float unitX = gravity_mG[0] * inverseNorm;
+    const float unitY = gravity_mG[1] * inverseNorm;
+    const float unitZ = gravity_mG[2] * inverseNorm;
+    if(unitZ < MIN_CALIBRATION_COSINE) {
+        return (createErrorCode(CALIBRATE, 1, ERR_WARNING));
+    }
+
+    //compute the rotation bringing the gravity onto Z
+    const float ratio   = 1.0F / (1.0F + unitZ);
+    alignment_Q14[0][0] = floatToQ14(1.0F - (ratio * unitX * unitX));
+    alignment_Q14[0][1] = floatToQ14(-ratio * unitX * unitY);
+    alignment_Q14[0][2] = floatToQ14(-unitX);
+    alignment_Q14[1][0] = alignment_Q14[0][1];
+    alignment_Q14[1][1] = floatToQ14(1.0F - (ratio * unitY * unitY));
+    alignment_Q14[1][2] = floatToQ14(-unitY);
+    alignment_Q14[2][0] = floatToQ14(unitX);
+    alignment_Q14[2][1] = floatToQ14(unitY);
+    alignment_Q14[2][2] = floatToQ14(unitZ);
+
+    //apply it on top of the current correction, and store the record
+    record.magic = RECORD_MAGIC;
+    multiplyMatrices(alignment_Q14, correction_Q14, record.correction_Q14);
+    record.checksum = computeChecksum(&record);
+
+    result = storageErasePage(STORAGE_MOUNTING);
+    if(isError(result)) {
+        return (pushErrorCode(result, CALIBRATE, 2));
+    }
+
+    result = storageWrite(STORAGE_MOUNTING, 0, &record, (uint16_t)sizeof(record));
+    if(isError(result)) {
+        return (pushErrorCode(result, CALIBRATE, 3));
+    }
+
+    //use the new correction from now on
+    mountingInitialise();
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Multiply two Q14 matrices
+ *
+ * @param[in] left_Q14 Left matrix
+ * @param[in] right_Q14 Right matrix
+ * @param[out] product_Q14 Product of both matrices
+ */
+static void multiplyMatrices(const int16_t left_Q14[][MOUNTING_NB_AXIS], const int16_t right_Q14[][MOUNTING_NB_AXIS],
+                             int16_t product_Q14[][MOUNTING_NB_AXIS]) {
+    for(uint8_t row = 0; row < (uint8_t)MOUNTING_NB_AXIS; row++) {
+        for(uint8_t column = 0; column < (uint8_t)MOUNTING_NB_AXIS; column++) {
+            int32_t sum = Q14_ROUNDING;
+            for(uint8_t i = 0; i < (uint8_t)MOUNTING_NB_AXIS; i++) {
+                sum += (int32_t)left_Q14[row][i] * (int32_t)right_Q14[i][column];
+            }
+            product_Q14[row][column] = saturateQ14(sum);
+        }
+    }
+}
+
+/**
+ * @brief Compute the checksum of a record
+ *
+ * @param[in] record Record of which compute the checksum
+ * @return One's complement of the sum of the magic value and the correction coefficients
+ */
+static uint16_t computeChecksum(const mountingRecord_t* record) {
+    uint16_t sum = record->magic;
+
+    for(uint8_t row = 0; row < (uint8_t)MOUNTING_NB_AXIS; row++) {
+        for(uint8_t column = 0; column < (uint8_t)MOUNTING_NB_AXIS; column++) {
+            sum = (uint16_t)(sum + (uint16_t)record->correction_Q14[row][column]);
+        }
+    }
+
+    return ((uint16_t)~sum);
+}
+
+/**
+ * @brief Shift a Q28 product back to Q14, and saturate it to 16 bits
+ * @note The product is expected to already hold the rounding value
+ *
+ * @param value Q28 product
+ * @return Saturated Q14 value
+ */
+static inline int16_t saturateQ14(int32_t value) {
+    const int32_t shifted = value >> Q14_SHIFT;
+
+    if(shifted > INT16_MAX) {
+        return (INT16_MAX);
+    }
+    if(shifted < INT16_MIN) {
+        return (INT16_MIN);
+    }
+
+    return ((int16_t)shifted);
+}
+
+/**
+ * @brief Convert a float coefficient (between -1 and 1) to Q14
+ *
+ * @param value Coefficient to convert
+ * @return Rounded Q14 coefficient
+ */
+static inline int16_t floatToQ14(float value) {
+    const float scaled = value * (float)MOUNTING_Q14_ONE;
+    return ((int16_t)(scaled + (scaled < 0.0F ? -ROUNDING_HALF : ROUNDING_HALF)));
+}
@@ -0,0 +1,15 @@
+#ifndef MOUNTING_H_INCLUDED
+#define MOUNTING_H_INCLUDED
+#include <stdint.h>
+#include "errorstack.h"
+
+enum {
+    MOUNTING_NB_AXIS = 3U,     ///< Number of axis in a rotated vector
+    MOUNTING_Q14_ONE = 16384,  ///< Value of 1.0 in the Q14 fixed-point format of the rotation matrices
+};
+
+void        mountingInitialise(void);
+void        mountingRotate(int16_t vector_LSB[]);
+errorCode_u mountingCalibrate(const float gravity_mG[]);
+
+#endif
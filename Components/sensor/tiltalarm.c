@@ -0,0 +1,85 @@
+/**
+ * @file tiltalarm.c
+ * @brief Implement the tilt alarm thresholds, with hysteresis
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The alarm of an axis is raised as soon as its angle magnitude exceeds the threshold,
+ *  and released once it gets back under the threshold minus the hysteresis (no chattering around the limit).
+ *  Thresholds are set at compile time in tenths of degrees, and converted once to radians by the compiler.
+ *  The evaluation is a fixed sequence of comparisons without any division nor trigonometry,
+ *  so it takes the same time on each filter step.
+ */
+#include "tiltalarm.h"
+#include <stdint.h>
+#include "fastmath.h"
+
+#if !defined(TILT_ALARM_X_TENTHS)
+#define TILT_ALARM_X_TENTHS 50U  ///< Roll alarm threshold in tenths of degrees (0 : axis not monitored)
+#endif
+#if !defined(TILT_ALARM_Y_TENTHS)
+#define TILT_ALARM_Y_TENTHS 50U  ///< Pitch alarm threshold in tenths of degrees (0 : axis not monitored)
+#endif
+#if !defined(TILT_ALARM_HYSTERESIS_TENTHS)
+#define TILT_ALARM_HYSTERESIS_TENTHS 5U  ///< Angle decrease needed to release an alarm in tenths of degrees
+#endif
+
+#if (TILT_ALARM_X_TENTHS && (TILT_ALARM_HYSTERESIS_TENTHS >= TILT_ALARM_X_TENTHS)) \
+    || (TILT_ALARM_Y_TENTHS && (TILT_ALARM_HYSTERESIS_TENTHS >= TILT_ALARM_Y_TENTHS))
+#error "The tilt alarm hysteresis must be smaller than the thresholds"
+#endif
+
+#define RADIANS_TO_DEGREES_TENTHS 572.957795F  ///< Ratio between radians and tenths of degrees (= 10 * (180°/PI))
+
+/**
+ * @brief Flags indicating which axis are monitored
+ */
+static const uint8_t axisMonitored[TILT_ALARM_NB_ANGLES] = {
+    (TILT_ALARM_X_TENTHS > 0U),
+    (TILT_ALARM_Y_TENTHS > 0U),
+};
+
+/**
+ * @brief Angles beyond which the alarm of each axis is raised in [rad]
+ */
+static const float raiseThresholds_rad[TILT_ALARM_NB_ANGLES] = {
+    (float)TILT_ALARM_X_TENTHS / RADIANS_TO_DEGREES_TENTHS,
+    (float)TILT_ALARM_Y_TENTHS / RADIANS_TO_DEGREES_TENTHS,
+};
+
+/**
+ * @brief Angles under which the alarm of each axis is released in [rad]
+ */
+static const float releaseThresholds_rad[TILT_ALARM_NB_ANGLES] = {
+    (float)(TILT_ALARM_X_TENTHS - TILT_ALARM_HYSTERESIS_TENTHS) / RADIANS_TO_DEGREES_TENTHS,
+    (float)(TILT_ALARM_Y_TENTHS - TILT_ALARM_HYSTERESIS_TENTHS) / RADIANS_TO_DEGREES_TENTHS,
+};
+
+/**
+ * @brief Update the alarm of each axis with the latest angles
+ *
+ * @param[in,out] alarm Tilt alarm context
+ * @param[in] angles_rad Roll and pitch angles in [rad]
+ * @retval 0 Alarm released on all axis
+ * @retval 1 Alarm raised on at least one axis
+ */
+uint8_t tiltAlarmEvaluate(tiltAlarm_t* alarm, const float angles_rad[]) {
+    uint8_t raised = 0;
+
+    for(uint8_t angle = 0; angle < (uint8_t)TILT_ALARM_NB_ANGLES; angle++) {
+        const float magnitude_rad = MATH_ABS(angles_rad[angle]);
+
+        if(!axisMonitored[angle]) {
+            alarm->axisRaised[angle] = 0;
+        } else if(magnitude_rad > raiseThresholds_rad[angle]) {
+            alarm->axisRaised[angle] = 1;
+        } else if(magnitude_rad < releaseThresholds_rad[angle]) {
+            alarm->axisRaised[angle] = 0;
+        }
+
+        raised |= alarm->axisRaised[angle];
+    }
+
+    return (raised);
+}
@@ -0,0 +1,19 @@
+#ifndef TILTALARM_H_INCLUDED
+#define TILTALARM_H_INCLUDED
+#include <stdint.h>
+
+enum {
+    TILT_ALARM_NB_ANGLES = 2U,  ///< Number of angles monitored (roll and pitch)
+};
+
+/**
+ * @brief Structure holding the state of the tilt alarm of a device
+ * @note A zeroed structure is valid (alarm released on all axis)
+ */
+typedef struct {
+    uint8_t axisRaised[TILT_ALARM_NB_ANGLES];  ///< Flag indicating the alarm is raised on an axis
+} tiltAlarm_t;
+
+uint8_t tiltAlarmEvaluate(tiltAlarm_t* alarm, const float angles_rad[]);
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef USERDEFINED_FASTMATH_H_INCLUDED
+#define USERDEFINED_FASTMATH_H_INCLUDED
+#include <stdint.h>
+
+#define FAST_PI         3.14159265F  ///< Value of PI
+#define FAST_HALF_PI    1.57079633F  ///< Value of PI / 2
+#define FAST_TWO_PI     6.28318531F  ///< Value of 2 * PI
+#define FAST_INV_TWO_PI 0.15915494F  ///< Value of 1 / (2 * PI)
+
+/**
+ * @brief Compute an approximation of 1/sqrt(x), without any libm call
+ * @note One Newton-Raphson iteration is applied (max. relative error : 0.175%)
+ *
+ * @param value Value of which compute the inverse square root (must be strictly positive)
+ * @return Inverse square root of the value
+ */
+static inline float fastInverseSqrt(float value) {
+    const uint32_t MAGIC_NUMBER = 0x5F3759DFU;
+    const float    THREE_HALFS  = 1.5F;
+    const float    HALF         = 0.5F;
+
+    union {
+        float    floating;
+        uint32_t integer;
+    } conversion = {.floating = value};
+
+    conversion.integer = MAGIC_NUMBER - (conversion.integer >> 1U);
+    return (conversion.floating * (THREE_HALFS - (HALF * value * conversion.floating * conversion.floating)));
+}
+
+/**
+ * @brief Compute an approximation of atan2(y, x), without any libm call
+ * @details
+ *  The ratio is always brought back between -1 and 1 to use a 9th order polynomial,
+ *  then the result is moved to the right quadrant (max. error : 1e-5 rad)
+ *
+ * @param ordinate Ordinate (y) of the vector
+ * @param abscissa Abscissa (x) of the vector
+ * @return Angle of the vector in [rad], between -PI and PI (0 if null vector)
+ */
+static inline float fastAtan2(float ordinate, float abscissa) {
+    const float COEFF_1 = 0.99986600F;
+    const float COEFF_3 = -0.33029950F;
+    const float COEFF_5 = 0.18014100F;
+    const float COEFF_7 = -0.08513300F;
+    const float COEFF_9 = 0.02083510F;
+
+    const float absOrdinate = (ordinate < 0.0F ? -ordinate : ordinate);
+    const float absAbscissa = (abscissa < 0.0F ? -abscissa : abscissa);
+    const uint8_t swapped   = (absOrdinate > absAbscissa);
+
+    //if null vector, angle is 0
+    if(!swapped && (absAbscissa <= 0.0F)) {
+        return (0.0F);
+    }
+
+    //compute the arctangent of a ratio between -1 and 1
+    const float ratio   = (swapped ? abscissa / ordinate : ordinate / abscissa);
+    const float squared = ratio * ratio;
+    float       angle =
+        ratio * (COEFF_1 + (squared * (COEFF_3 + (squared * (COEFF_5 + (squared * (COEFF_7 + (squared * COEFF_9))))))));
+
+    //if ratio was inverted, atan2(y, x) = ±PI/2 - atan(x/y), already in the right quadrant (sign of y)
+    //  (the ratio sign cannot be used there, as it is lost when the abscissa is a signed zero)
+    if(swapped) {
+        return ((ordinate < 0.0F ? -FAST_HALF_PI : FAST_HALF_PI) - angle);
+    }
+
+    //move the angle to the right quadrant
+    if(abscissa < 0.0F) {
+        angle += (ordinate < 0.0F ? -FAST_PI : FAST_PI);
+    }
+
+    return (angle);
+}
+
+/**
+ * @brief Compute the absolute value of a float, without any libm call
+ *
+ * @param value Value of which compute the absolute value
+ * @return Absolute value
+ */
+static inline float fastAbs(float value) {
+    return (value < 0.0F ? -value : value);
+}
+
+/**
+ * @brief Compute an approximation of sqrt(x), without any libm call
+ * @note Two Newton-Raphson iterations are applied on the inverse square root (max. relative error : 5e-6)
+ *
+ * @param value Value of which compute the square root
+ * @return Square root of the value (0 if negative or null)
+ */
+static inline float fastSqrt(float value) {
+    const float THREE_HALFS = 1.5F;
+    const float HALF        = 0.5F;
+
+    if(value <= 0.0F) {
+        return (0.0F);
+    }
+
+    float inverse = fastInverseSqrt(value);
+    inverse *= THREE_HALFS - (HALF * value * inverse * inverse);
+    return (value * inverse);
+}
+
+/**
+ * @brief Compute an approximation of sin(x), without any libm call
+ * @details
+ *  The angle is brought back between -PI/2 and PI/2 to use an 11th order Taylor polynomial (max. error : 3e-7)
+ *
+ * @param angle_rad Angle in [rad] (finite, a few turns at most)
+ * @return Sine of the angle
+ */
+static inline float fastSin(float angle_rad) {
+    const float COEFF_3  = -1.66666667e-1F;
+    const float COEFF_5  = 8.33333333e-3F;
+    const float COEFF_7  = -1.98412698e-4F;
+    const float COEFF_9  = 2.75573192e-6F;
+    const float COEFF_11 = -2.50521084e-8F;
+    const float HALF     = 0.5F;
+
+    //bring the angle between -PI and PI
+    const float turns = angle_rad * FAST_INV_TWO_PI;
+    angle_rad -= (float)(int32_t)(turns + (turns < 0.0F ? -HALF : HALF)) * FAST_TWO_PI;
+
+    //sin(PI - x) = sin(x), to get between -PI/2 and PI/2
+    if(angle_rad > FAST_HALF_PI) {
+        angle_rad = FAST_PI - angle_rad;
+    } else if(angle_rad < -FAST_HALF_PI) {
+        angle_rad = -FAST_PI - angle_rad;
+    }
+
+    const float squared = angle_rad * angle_rad;
+    const float polynomial =
+        COEFF_3 + (squared * (COEFF_5 + (squared * (COEFF_7 + (squared * (COEFF_9 + (squared * COEFF_11)))))));
+    return (angle_rad * (1.0F + (squared * polynomial)));
+}
+
+/**
+ * @brief Compute an approximation of cos(x), without any libm call
+ *
+ * @param angle_rad Angle in [rad] (finite, a few turns at most)
+ * @return Cosine of the angle
+ */
+static inline float fastCos(float angle_rad) {
+    return (fastSin(angle_rad + FAST_HALF_PI));
+}
+
+/**
+ * @brief Compute an approximation of tan(x), without any libm call
+ *
+ * @param angle_rad Angle in [rad] (finite, a few turns at most)
+ * @return Tangent of the angle
+ */
+static inline float fastTan(float angle_rad) {
+    return (fastSin(angle_rad) / fastCos(angle_rad));
+}
+
+/**
+ * @brief Compute an approximation of atan(x), without any libm call
+ *
+ * @param value Value of which compute the arctangent
+ * @return Angle in [rad], between -PI/2 and PI/2
+ */
+static inline float fastAtan(float value) {
+    return (fastAtan2(value, 1.0F));
+}
+
+/**
+ * @brief Compute an approximation of asin(x), without any libm call
+ * @note Values out of [-1, 1] are clamped (instead of returning NaN)
+ *
+ * @param value Value of which compute the arcsine
+ * @return Angle in [rad], between -PI/2 and PI/2
+ */
+static inline float fastAsin(float value) {
+    if(value >= 1.0F) {
+        return (FAST_HALF_PI);
+    }
+    if(value <= -1.0F) {
+        return (-FAST_HALF_PI);
+    }
+
+    return (fastAtan2(value, fastSqrt(1.0F - (value * value))));
+}
+
+/**
+ * @brief Math functions used in the measurements hot path
+ * @note With FASTMATH_NO_LIBM, the in-tree kernels above are used and libm is not linked at all
+ */
+#if defined(FASTMATH_NO_LIBM)
+#define MATH_ABS(value)  fastAbs(value)
+#define MATH_SIN(angle)  fastSin(angle)
+#define MATH_COS(angle)  fastCos(angle)
+#define MATH_TAN(angle)  fastTan(angle)
+#define MATH_ATAN(value) fastAtan(value)
+#define MATH_ASIN(value) fastAsin(value)
+#else
+#include <math.h>
+#define MATH_ABS(value)  fabsf(value)
+#define MATH_SIN(angle)  sinf(angle)
+#define MATH_COS(angle)  cosf(angle)
+#define MATH_TAN(angle)  tanf(angle)
+#define MATH_ATAN(value) atanf(value)
+#define MATH_ASIN(value) asinf(value)
+#endif
+
+#endif
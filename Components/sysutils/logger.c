@@ -0,0 +1,111 @@
+/**
+ * @file logger.c
+ * @brief Implement a deferred binary logger, drained through the ITM stimulus port 0 (SWO pin)
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Messages are never formatted on target : a call only copies the format ID and the raw arguments
+ *  in a ring buffer, and the main loop drains it without blocking when the ITM FIFO is ready.
+ *  The format strings are kept in a non-loaded ELF section, and the host tool tools/logdecode.py
+ *  formats the messages received with them.
+ *
+ *  Each message is made of 32-bits words :
+ *  - header : magic (bits 31-24), format ID (bits 23-8), number of arguments (bits 7-4)
+ *    and number of messages dropped just before it (bits 3-0)
+ *  - timestamp in milliseconds
+ *  - arguments
+ */
+#include "logger.h"
+#include <stdint.h>
+#include "stm32f103xb.h"
+#include "systick.h"
+
+enum {
+    HEADER_MAGIC       = 0xA5U,                       ///< Value identifying a message header
+    HEADER_MAGIC_SHIFT = 24U,                         ///< Shift of the magic value in the header
+    FORMAT_ID_SHIFT    = 8U,                          ///< Shift of the format ID in the header
+    NB_ARGUMENTS_SHIFT = 4U,                          ///< Shift of the number of arguments in the header
+    MAX_DROPPED        = 0x0FU,                       ///< Maximum number of messages dropped reported in a header
+    NB_HEADER_WORDS    = 2U,                          ///< Number of words before the arguments (header and timestamp)
+    BUFFER_MASK        = (LOGGER_BUFFER_WORDS - 1U),  ///< Mask applied to the buffer indexes
+    ITM_PORT           = 0,                           ///< ITM stimulus port used
+};
+
+_Static_assert(((uint32_t)LOGGER_BUFFER_WORDS & ((uint32_t)LOGGER_BUFFER_WORDS - 1U)) == 0,
+               "The logger buffer size must be a power of 2");
+
+#if defined(LOGGER_ENABLED)
+static uint32_t          buffer[LOGGER_BUFFER_WORDS];  ///< Ring buffer of the messages words
+static volatile uint16_t head    = 0;                  ///< Index of the next word to write
+static volatile uint16_t tail    = 0;                  ///< Index of the next word to send
+static uint8_t           dropped = 0;                  ///< Number of messages dropped since the latest one written
+#endif
+
+/**
+ * @brief Copy a message in the ring buffer (or drop it if the buffer is full)
+ * @note This can be called from interrupts
+ *
+ * @param formatID ID of the format string (see LOG_MESSAGE())
+ * @param nbArguments Number of arguments
+ * @param[in] arguments Raw arguments
+ */
+void loggerWrite(uint16_t formatID, uint8_t nbArguments, const uint32_t arguments[]) {
+#if defined(LOGGER_ENABLED)
+    if(nbArguments > (uint8_t)LOGGER_MAX_ARGS) {
+        nbArguments = LOGGER_MAX_ARGS;
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    //if not enough room in the buffer, drop the message
+    const uint16_t used = (uint16_t)((head - tail) & BUFFER_MASK);
+    if((LOGGER_BUFFER_WORDS - 1U - used) < ((uint32_t)NB_HEADER_WORDS + nbArguments)) {
+        if(dropped < (uint8_t)MAX_DROPPED) {
+            dropped++;
+        }
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    //write the header, the timestamp and the arguments
+    uint16_t index = head;
+    buffer[index]  = ((uint32_t)HEADER_MAGIC << HEADER_MAGIC_SHIFT) | ((uint32_t)formatID << FORMAT_ID_SHIFT)
+                  | ((uint32_t)nbArguments << NB_ARGUMENTS_SHIFT) | dropped;
+    index          = (uint16_t)((index + 1U) & BUFFER_MASK);
+    buffer[index]  = getSystick();
+    for(uint8_t argument = 0; argument < nbArguments; argument++) {
+        index         = (uint16_t)((index + 1U) & BUFFER_MASK);
+        buffer[index] = arguments[argument];
+    }
+
+    head    = (uint16_t)((index + 1U) & BUFFER_MASK);
+    dropped = 0;
+    __set_PRIMASK(primask);
+#else
+    (void)formatID;
+    (void)nbArguments;
+    (void)arguments;
+#endif
+}
+
+/**
+ * @brief Send the words buffered as long as the ITM FIFO accepts them
+ * @note If no debugger enabled the ITM port, the messages are discarded
+ */
+void loggerFlush(void) {
+#if defined(LOGGER_ENABLED)
+    //if ITM or stimulus port disabled, nobody listens
+    if(!(ITM->TCR & ITM_TCR_ITMENA_Msk) || !(ITM->TER & (1UL << ITM_PORT))) {
+        tail = head;
+        return;
+    }
+
+    //send the words without blocking (FIFO ready when the port reads 1)
+    while((tail != head) && ITM->PORT[ITM_PORT].u32) {
+        ITM->PORT[ITM_PORT].u32 = buffer[tail];
+        tail                    = (uint16_t)((tail + 1U) & BUFFER_MASK);
+    }
+#endif
+}
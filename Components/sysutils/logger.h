@@ -0,0 +1,39 @@
+#ifndef LOGGER_H_INCLUDED
+#define LOGGER_H_INCLUDED
+#include <stdint.h>
+
+enum {
+    LOGGER_BUFFER_WORDS = 256U,  ///< Number of 32-bits words in the ring buffer (must be a power of 2)
+    LOGGER_MAX_ARGS     = 3U,    ///< Maximum number of arguments in a message
+};
+
+void loggerWrite(uint16_t formatID, uint8_t nbArguments, const uint32_t arguments[]);
+void loggerFlush(void);
+
+#if defined(LOGGER_ENABLED)
+/**
+ * @brief Declare a format string in the .logstrings section (not loaded in flash) and log a message with its ID
+ * @note The ID is the address of the string in the section, which tools/logdecode.py reads from the ELF file
+ */
+#define LOG_MESSAGE(format, nbArguments, arguments)                                           \
+    do {                                                                                      \
+        static const char logFormat[] __attribute__((section(".logstrings"), used)) = format; \
+        loggerWrite((uint16_t)(uintptr_t)logFormat, nbArguments, arguments);                  \
+    } while(0)
+
+/**
+ * @brief Log a message, its integer arguments being formatted on the host
+ */
+#define LOG0(format)             LOG_MESSAGE(format, 0, (void*)0)
+#define LOG1(format, arg1)       LOG_MESSAGE(format, 1U, ((const uint32_t[]){(uint32_t)(arg1)}))
+#define LOG2(format, arg1, arg2) LOG_MESSAGE(format, 2U, ((const uint32_t[]){(uint32_t)(arg1), (uint32_t)(arg2)}))
+#define LOG3(format, arg1, arg2, arg3) \
+    LOG_MESSAGE(format, 3U, ((const uint32_t[]){(uint32_t)(arg1), (uint32_t)(arg2), (uint32_t)(arg3)}))
+#else
+#define LOG0(format)                   ((void)0)
+#define LOG1(format, arg1)             ((void)(arg1))
+#define LOG2(format, arg1, arg2)       ((void)(arg1), (void)(arg2))
+#define LOG3(format, arg1, arg2, arg3) ((void)(arg1), (void)(arg2), (void)(arg3))
+#endif
+
+#endif
@@ -0,0 +1,335 @@
+/**
+ * @file powerfail.c
+ * @brief Implement the power-fail detection, writing the application state in flash when the supply voltage drops
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The PVD raises an interrupt (EXTI line 16) as soon as VDD falls under 2.9V.
+ *  The interrupt stops all the DMA transfers and programs the latest application state in a slot
+ *  of a page erased beforehand, which only takes a few half-words programming (no erase in the hold-up time).
+ *  The main loop then stops updating the peripherals, and resets the MCU if the voltage comes back up.
+ *  The record can also be written right away (e.g. before releasing the power latch), in which case
+ *  the following power failure does not write it again unless the state changed in-between.
+ *
+ *  The page holds a sequence of records, written one after the other. At boot, the latest valid one
+ *  is restored, and the page is only erased once it is full (which spreads the flash wear).
+ *  A record cut by the power loss is detected by its checksum and ignored.
+ *
+ *  The time spent from the interrupt to the record written is measured with the DWT cycles counter,
+ *  and programmed in the last half-word of the record (reported at the next boot).
+ *  Worst case : 13 half-words programmed at 70us each (tPROG max.), so less than 1ms.
+ *
+ * @note Additional information can be found in :
+ *   - RM0008 (STM32F10xxx reference manual), section 5.2.2 (Programmable voltage detector) :
+ *       https://www.st.com/resource/en/reference_manual/rm0008-stm32f101xx-stm32f102xx-stm32f103xx-stm32f105xx-and-stm32f107xx-advanced-armbased-32bit-mcus-stmicroelectronics.pdf
+ */
+#include "powerfail.h"
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32f1xx_ll_dma.h"
+#include "stm32f1xx_ll_exti.h"
+#include "stm32f1xx_ll_pwr.h"
+#include "storage.h"
+#include "systick.h"
+
+enum {
+    RECORD_MAGIC       = 0x5046U,  ///< Value identifying a power-fail record in flash ("PF")
+    RECORD_BLANK       = 0xFFFFU,  ///< Value of an erased half-word
+    RECORD_ALIGN       = 4,        ///< Alignment of the record (state made of 32 bits words)
+    RECOVERY_DELAY_MS  = 100U,     ///< Number of milliseconds the voltage must be back up before restarting
+    PVD_IRQ_PRIORITY   = 0,        ///< Priority of the PVD interrupt (pre-empts all the others)
+    MAX_FLUSH_DURATION = 0xFFFEU,  ///< Maximum flush duration recorded in [us] (0xFFFF meaning not measured)
+};
+
+/**
+ * @brief Enumeration of all the function ID used in errors
+ */
+typedef enum {
+    INIT = 1,      ///< powerfailInitialise() function
+    SAVE,          ///< powerfailSaveState() function
+    WRITE_RECORD,  ///< writeRecord() function
+} powerfailFunction_e;
+
+/**
+ * @brief Structure representing a record stored in flash
+ */
+typedef struct {
+    uint16_t         magic;             ///< Value identifying the record
+    uint16_t         sequence;          ///< Number of records written
+    powerfailState_t state;             ///< Application state at the power failure
+    uint32_t         uptime_ms;         ///< Number of milliseconds elapsed since boot at the power failure
+    uint16_t         checksum;          ///< One's complement of the sum of the previous half-words
+    uint16_t         flushDuration_us;  ///< Time spent to write the record (programmed last)
+} __attribute__((aligned(RECORD_ALIGN))) powerfailRecord_t;
+
+enum {
+    NB_SLOTS        = STORAGE_PAGE_SIZE / sizeof(powerfailRecord_t),  ///< Number of records in the storage page
+    CHECKED_SIZE    = offsetof(powerfailRecord_t, checksum),          ///< Number of bytes covered by the checksum
+    DURATION_OFFSET = offsetof(powerfailRecord_t, flushDuration_us),  ///< Offset of the flush duration in a record
+};
+
+/**
+ * @brief Half-word allowed to alias any object, used to checksum and compare records
+ */
+typedef uint16_t __attribute__((may_alias)) halfword_t;
+
+static DMA_TypeDef*      dmaHandle        = (void*)0;  ///< DMA controller of which stop the transfers
+static powerfailRecord_t record;                       ///< Record to write at the next power failure
+static uint16_t          nextSlot         = NB_SLOTS;  ///< Index of the slot in which write the record
+static uint16_t          lastFlush_us     = 0;         ///< Flush duration read in the latest record in [us]
+static volatile uint8_t  powerFailed      = 0;         ///< Flag indicating the supply voltage dropped
+static volatile uint8_t  recordWritten    = 0;         ///< Flag indicating the current state is already in flash
+static systick_t         recoveryTimer_ms = 0;         ///< Timer used to debounce the voltage coming back up
+
+static errorCode_u writeRecord(cyclecount_t start);
+static uint8_t     isSameState(const powerfailState_t* first, const powerfailState_t* second);
+static uint16_t    computeChecksum(const powerfailRecord_t* slot);
+
+/**
+ * @brief Restore the state written at the latest power failure, and arm the power-fail detection
+ * @note The state restored is set to 0 (absolute referential) if no valid record is found
+ *
+ * @param dma DMA controller of which stop the transfers when the voltage drops
+ * @param[out] restored State restored
+ * @retval 0 Success
+ * @retval 1 Storage page not reserved by the linker script
+ * @retval 2 Error while erasing the full storage page (no record will be written)
+ */
+errorCode_u powerfailInitialise(DMA_TypeDef* dma, powerfailState_t* restored) {
+    const powerfailRecord_t* slots  = storageGetPage(STORAGE_POWERFAIL);
+    const powerfailRecord_t* latest = (void*)0;
+    errorCode_u              result;
+
+    dmaHandle     = dma;
+    *restored     = (powerfailState_t){0};
+    record        = (powerfailRecord_t){0};
+    nextSlot      = NB_SLOTS;
+    powerFailed   = 0;
+    recordWritten = 0;
+    if(!slots) {
+        return (createErrorCode(INIT, 1, ERR_ERROR));
+    }
+
+    //find the latest valid record (the records being written in order, the first blank slot ends the sequence)
+    for(uint16_t slot = 0; slot < (uint16_t)NB_SLOTS; slot++) {
+        if(slots[slot].magic == (uint16_t)RECORD_BLANK) {
+            nextSlot = slot;
+            break;
+        }
+
+        if((slots[slot].magic == (uint16_t)RECORD_MAGIC) && (slots[slot].checksum == computeChecksum(&slots[slot]))) {
+            latest = &slots[slot];
+        }
+    }
+
+    //restore it, and keep it as the record to write at the next power failure
+    if(latest) {
+        record       = *latest;
+        *restored    = latest->state;
+        lastFlush_us = latest->flushDuration_us;
+    }
+
+    //if the page is full, erase it while the voltage is still fine
+    if(nextSlot >= (uint16_t)NB_SLOTS) {
+        result = storageErasePage(STORAGE_POWERFAIL);
+        if(isError(result)) {
+            return (pushErrorCode(result, INIT, 2));
+        }
+        nextSlot = 0;
+    }
+
+    //raise an interrupt as soon as VDD drops under 2.9V
+    LL_PWR_SetPVDLevel(LL_PWR_PVDLEVEL_7);
+    LL_PWR_EnablePVD();
+    LL_EXTI_ClearFlag_0_31(LL_EXTI_LINE_16);
+    LL_EXTI_EnableRisingTrig_0_31(LL_EXTI_LINE_16);
+    LL_EXTI_EnableIT_0_31(LL_EXTI_LINE_16);
+    NVIC_SetPriority(PVD_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), PVD_IRQ_PRIORITY, 0));
+    NVIC_EnableIRQ(PVD_IRQn);
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Set the application state to write at the next power failure
+ *
+ * @param[in] state Current application state
+ */
+void powerfailSetState(const powerfailState_t* state) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if(!isSameState(&record.state, state)) {
+        record.state  = *state;
+        recordWritten = 0;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Write the application state in flash right away
+ * @note The interrupts are masked while the record is programmed (less than 1ms)
+ *
+ * @retval 0 Success
+ * @retval 1 Error while writing the record
+ */
+errorCode_u powerfailSaveState(void) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const errorCode_u result = writeRecord(getCycleCount());
+    __set_PRIMASK(primask);
+
+    if(isError(result)) {
+        return (pushErrorCode(result, SAVE, 1));
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Check whether the supply voltage dropped, and restart the MCU once it is back up
+ *
+ * @retval 0 Supply voltage fine
+ * @retval 1 Power failure, the peripherals must not be updated anymore
+ */
+uint8_t powerfailUpdate(void) {
+    if(!powerFailed) {
+        return (0);
+    }
+
+    //if the voltage is still low, restart the recovery timer
+    if(READ_BIT(PWR->CSR, PWR_CSR_PVDO)) {
+        recoveryTimer_ms = getSystick();
+        return (1);
+    }
+
+    //if the voltage has been back up long enough (sag), restart cleanly (the record will be restored)
+    if(isTimeElapsed(recoveryTimer_ms, RECOVERY_DELAY_MS)) {
+        NVIC_SystemReset();
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Stop the DMA transfers and write the power-fail record
+ * @warning This function must only be used in the PVD interrupt handler and nowhere else
+ */
+void powerfailIRQhandler(void) {
+    const cyclecount_t start = getCycleCount();
+
+    LL_EXTI_ClearFlag_0_31(LL_EXTI_LINE_16);
+    if(powerFailed) {
+        return;
+    }
+    powerFailed      = 1;
+    recoveryTimer_ms = getSystick();
+
+    //stop all the transfers (frame sent to the screen, sensor reads, blits) to save power
+    if(dmaHandle) {
+        for(uint32_t channel = LL_DMA_CHANNEL_1; channel <= LL_DMA_CHANNEL_7; channel++) {
+            LL_DMA_DisableChannel(dmaHandle, channel);
+        }
+    }
+
+    writeRecord(start);
+}
+
+/**
+ * @brief Get the number of records written since the storage page was erased
+ *
+ * @return Number of records (power failures and states saved right away)
+ */
+uint16_t powerfailGetNbRecords(void) {
+    return (record.sequence);
+}
+
+/**
+ * @brief Get the time spent writing the latest power-fail record
+ *
+ * @return Time in [us] (0xFFFF if not measured)
+ */
+uint16_t powerfailGetLastFlush_us(void) {
+    return (lastFlush_us);
+}
+
+/**
+ * @brief Program the record in the next erased slot, then the time it took
+ * @note A slot is never reused, even if programming it failed
+ *
+ * @param start CPU cycles count at which the write has been requested
+ * @retval 0 Success (or state already written)
+ * @retval 1 No erased slot available
+ * @retval 2 Error while programming the record
+ */
+static errorCode_u writeRecord(cyclecount_t start) {
+    if(recordWritten) {
+        return (ERR_SUCCESS);
+    }
+
+    if(nextSlot >= (uint16_t)NB_SLOTS) {
+        return (createErrorCode(WRITE_RECORD, 1, ERR_WARNING));
+    }
+
+    const uint16_t offset = (uint16_t)(nextSlot * sizeof(powerfailRecord_t));
+    record.magic          = RECORD_MAGIC;
+    record.sequence++;
+    record.uptime_ms = getSystick();
+    record.checksum  = computeChecksum(&record);
+    nextSlot++;
+
+    const errorCode_u result =
+        storageWrite(STORAGE_POWERFAIL, offset, &record, (uint16_t)CHECKED_SIZE + sizeof(record.checksum));
+    if(isError(result)) {
+        return (pushErrorCode(result, WRITE_RECORD, 2));
+    }
+
+    uint32_t duration_us = getElapsed_us(start);
+    if(duration_us > MAX_FLUSH_DURATION) {
+        duration_us = MAX_FLUSH_DURATION;
+    }
+    record.flushDuration_us = (uint16_t)duration_us;
+    storageWrite(STORAGE_POWERFAIL, offset + (uint16_t)DURATION_OFFSET, &record.flushDuration_us,
+                 sizeof(record.flushDuration_us));
+    recordWritten = 1;
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Check whether two application states hold the same bytes
+ *
+ * @param[in] first First state
+ * @param[in] second Second state
+ * @retval 0 States different
+ * @retval 1 States identical
+ */
+static uint8_t isSameState(const powerfailState_t* first, const powerfailState_t* second) {
+    const halfword_t* firstHalfwords  = (const halfword_t*)(const void*)first;
+    const halfword_t* secondHalfwords = (const halfword_t*)(const void*)second;
+
+    for(uint16_t i = 0; i < (uint16_t)(sizeof(powerfailState_t) / sizeof(uint16_t)); i++) {
+        if(firstHalfwords[i] != secondHalfwords[i]) {
+            return (0);
+        }
+    }
+
+    return (1);
+}
+
+/**
+ * @brief Compute the checksum of a record
+ *
+ * @param[in] slot Record of which compute the checksum
+ * @return One's complement of the sum of the half-words preceding the checksum
+ */
+static uint16_t computeChecksum(const powerfailRecord_t* slot) {
+    const halfword_t* halfwords = (const halfword_t*)(const void*)slot;
+    uint16_t          sum       = 0;
+
+    for(uint16_t i = 0; i < (uint16_t)(CHECKED_SIZE / sizeof(uint16_t)); i++) {
+        sum = (uint16_t)(sum + halfwords[i]);
+    }
+
+    return ((uint16_t)~sum);
+}
@@ -0,0 +1,29 @@
+#ifndef POWERFAIL_H_INCLUDED
+#define POWERFAIL_H_INCLUDED
+#include <stdint.h>
+#include "errorstack.h"
+#include "stm32f103xb.h"
+
+enum {
+    POWERFAIL_NB_ANGLES = 2U,  ///< Number of zeroing angles saved (X and Y axis)
+};
+
+/**
+ * @brief Structure holding the application state written in flash when the supply voltage drops
+ */
+typedef struct {
+    float    zeroing_rad[POWERFAIL_NB_ANGLES];  ///< Angles compensated in relative mode in [rad]
+    uint32_t lastError;                         ///< Latest error code reported by the application
+    uint8_t  relative;                          ///< 1 if the measurements were zeroed down (relative referential)
+    uint8_t  reserved[3];                       ///< Unused, keeps the record a multiple of 32 bits
+} powerfailState_t;
+
+errorCode_u powerfailInitialise(DMA_TypeDef* dma, powerfailState_t* restored);
+void        powerfailSetState(const powerfailState_t* state);
+errorCode_u powerfailSaveState(void);
+uint8_t     powerfailUpdate(void);
+void        powerfailIRQhandler(void);
+uint16_t    powerfailGetNbRecords(void);
+uint16_t    powerfailGetLastFlush_us(void);
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file storage.c
+ * @brief Implement the non-volatile records stored in the flash pages reserved by the linker script
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Each record has its own flash page, which must be erased before being written again.
+ *  The flash is written one half-word at a time, and the CPU stalls while a page is being erased
+ *  (max. 40ms, the watchdog being reloaded beforehand).
+ *  A page is never erased while the supply voltage is below the PVD threshold, as the erase could be cut halfway.
+ *  Writes are still allowed, as they are needed by the power-fail record (see powerfail.c).
+ *  The timeouts use the microseconds timebase, so that the flash can also be written in an interrupt.
+ *  As the power-fail interrupt can pre-empt an erase or a write of the main loop, each operation saves
+ *  the flash controller settings (lock, programming and page erase bits) when it starts, and restores them
+ *  once done, instead of locking the controller. The unlock key sequence is written with the interrupts masked,
+ *  as a key sequence cut by another one would lock the controller until the next reset.
+ *
+ * @note Additional information can be found in :
+ *   - PM0075 (STM32F10xxx Flash memory programming) : https://www.st.com/resource/en/programming_manual/pm0075-stm32f10xxx-flash-memory-microcontrollers-stmicroelectronics.pdf
+ */
+#include "storage.h"
+#include <stdint.h>
+#include "stm32f103xb.h"
+#include "stm32f1xx_ll_iwdg.h"
+#include "systick.h"
+
+enum {
+    FLASH_TIMEOUT_US = 50000U,  ///< Max number of microseconds to wait for a flash operation
+    HALFWORD_SIZE    = 2U,      ///< Number of bytes in a half-word
+    BYTE_SHIFT       = 8U,      ///< Number of bits in a byte
+};
+
+/**
+ * @brief Enumeration of all the function ID used in errors
+ */
+typedef enum {
+    ERASE_PAGE = 1,  ///< storageErasePage() function
+    WRITE,           ///< storageWrite() function
+} storageFunction_e;
+
+extern const uint8_t _sstorage[];  ///< First address of the storage region (see linker script)
+extern const uint8_t _estorage[];  ///< Address following the storage region (see linker script)
+
+static inline uint32_t unlockFlash(void);
+static inline void     restoreFlash(uint32_t interrupted);
+static inline void     writeUnlockKeys(void);
+static inline uint8_t  waitFlashOperation(void);
+
+/**
+ * @brief Get the address of a storage page
+ *
+ * @param page Page to get
+ * @return Address of the page (NULL if out of the storage region)
+ */
+const void* storageGetPage(storagePage_e page) {
+    const uint8_t* address = &_sstorage[(uint32_t)page * STORAGE_PAGE_SIZE];
+
+    if((page >= NB_STORAGE_PAGES) || (address >= _estorage)) {
+        return ((void*)0);
+    }
+
+    return (address);
+}
+
+/**
+ * @brief Erase a storage page (all bytes set to 0xFF)
+ *
+ * @param page Page to erase
+ * @retval 0 Success
+ * @retval 1 Page out of the storage region
+ * @retval 2 Timeout or error while erasing
+ * @retval 3 Supply voltage below the PVD threshold
+ */
+errorCode_u storageErasePage(storagePage_e page) {
+    const uint8_t* address = storageGetPage(page);
+    if(!address) {
+        return (createErrorCode(ERASE_PAGE, 1, ERR_ERROR));
+    }
+
+    //if the supply is failing, do not start an erase which could be cut halfway
+    if(READ_BIT(PWR->CSR, PWR_CSR_PVDO)) {
+        return (createErrorCode(ERASE_PAGE, 3, ERR_WARNING));
+    }
+
+    //make sure the watchdog does not expire while the CPU is stalled
+    LL_IWDG_ReloadCounter(IWDG);
+
+    //erase the page
+    const uint32_t interrupted = unlockFlash();
+    SET_BIT(FLASH->CR, FLASH_CR_PER);
+    WRITE_REG(FLASH->AR, (uint32_t)address);
+    SET_BIT(FLASH->CR, FLASH_CR_STRT);
+    const uint8_t success = waitFlashOperation();
+    restoreFlash(interrupted);
+
+    if(!success) {
+        return (createErrorCode(ERASE_PAGE, 2, ERR_ERROR));
+    }
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Write data in an erased storage page
+ *
+ * @param page Page in which write
+ * @param offset Offset of the data in the page, in bytes (must be even)
+ * @param[in] data Data to write
+ * @param size Number of bytes to write (a last odd byte is padded with 0xFF)
+ * @retval 0 Success
+ * @retval 1 Data out of the page, or offset not aligned on a half-word
+ * @retval 2 Timeout or error while programming
+ * @retval 3 Data read back different from the data written
+ */
+errorCode_u storageWrite(storagePage_e page, uint16_t offset, const void* data, uint16_t size) {
+    const uint8_t* address = storageGetPage(page);
+    const uint8_t* bytes   = data;
+
+    //if data out of the page or not aligned, error
+    if(!address || !data || (offset & 1U) || (((uint32_t)offset + size) > STORAGE_PAGE_SIZE)) {
+        return (createErrorCode(WRITE, 1, ERR_ERROR));
+    }
+
+    //wait for any operation interrupted by the power-fail record to finish
+    const cyclecount_t timer = getCycleCount();
+    while(READ_BIT(FLASH->SR, FLASH_SR_BSY) && !isTimeElapsed_us(timer, FLASH_TIMEOUT_US)) {};
+
+    //program the data one half-word at a time
+    volatile uint16_t* destination = (volatile uint16_t*)(uintptr_t)&address[offset];
+    const uint32_t     interrupted = unlockFlash();
+    CLEAR_BIT(FLASH->CR, FLASH_CR_PER);
+    SET_BIT(FLASH->CR, FLASH_CR_PG);
+    for(uint16_t i = 0; i < size; i += HALFWORD_SIZE) {
+        const uint8_t  msb      = ((i + 1U) < size ? bytes[i + 1U] : 0xFFU);
+        const uint16_t halfword = (uint16_t)((uint16_t)bytes[i] | (uint16_t)((uint16_t)msb << BYTE_SHIFT));
+
+        *destination = halfword;
+        if(!waitFlashOperation()) {
+            restoreFlash(interrupted);
+            return (createErrorCode(WRITE, 2, ERR_ERROR));
+        }
+
+        if(*destination != halfword) {
+            restoreFlash(interrupted);
+            return (createErrorCode(WRITE, 3, ERR_ERROR));
+        }
+
+        destination++;
+    }
+    restoreFlash(interrupted);
+
+    return (ERR_SUCCESS);
+}
+
+/**
+ * @brief Unlock the flash programming and erase controller, and save the settings of the operation interrupted
+ *
+ * @return Lock, programming and page erase bits before the unlock (only LOCK set if no operation interrupted)
+ */
+static inline uint32_t unlockFlash(void) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    const uint32_t interrupted = READ_BIT(FLASH->CR, FLASH_CR_LOCK | FLASH_CR_PG | FLASH_CR_PER);
+    if(interrupted & FLASH_CR_LOCK) {
+        writeUnlockKeys();
+    }
+
+    __set_PRIMASK(primask);
+    return (interrupted);
+}
+
+/**
+ * @brief Restore the flash controller settings saved by unlockFlash()
+ * @details
+ *  If no operation was interrupted, the controller is locked.
+ *  Otherwise, it is unlocked again if needed and gets back the programming and page erase bits,
+ *  so that the operation interrupted carries on as if nothing happened.
+ *
+ * @param interrupted Settings returned by unlockFlash()
+ */
+static inline void restoreFlash(uint32_t interrupted) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    CLEAR_BIT(FLASH->CR, FLASH_CR_PG | FLASH_CR_PER);
+    if(interrupted & FLASH_CR_LOCK) {
+        SET_BIT(FLASH->CR, FLASH_CR_LOCK);
+    } else {
+        if(READ_BIT(FLASH->CR, FLASH_CR_LOCK)) {
+            writeUnlockKeys();
+        }
+        SET_BIT(FLASH->CR, interrupted & (FLASH_CR_PG | FLASH_CR_PER));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Write the key sequence unlocking the flash programming and erase controller
+ * @warning The interrupts must be masked, as another key sequence in-between locks the controller until reset
+ */
+static inline void writeUnlockKeys(void) {
+    WRITE_REG(FLASH->KEYR, FLASH_KEY1);
+    WRITE_REG(FLASH->KEYR, FLASH_KEY2);
+}
+
+/**
+ * @brief Wait for the current flash operation to finish, and clear its status flags
+ *
+ * @retval 0 Timeout, programming or write protection error
+ * @retval 1 Operation successful
+ */
+static inline uint8_t waitFlashOperation(void) {
+    const cyclecount_t timer = getCycleCount();
+
+    while(READ_BIT(FLASH->SR, FLASH_SR_BSY) && !isTimeElapsed_us(timer, FLASH_TIMEOUT_US)) {};
+
+    const uint32_t status = READ_REG(FLASH->SR);
+    WRITE_REG(FLASH->SR, FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR);
+
+    return (!(status & (FLASH_SR_BSY | FLASH_SR_PGERR | FLASH_SR_WRPRTERR)));
+}
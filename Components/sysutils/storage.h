@@ -0,0 +1,24 @@
+#ifndef USERDEFINED_STORAGE_H_INCLUDED
+#define USERDEFINED_STORAGE_H_INCLUDED
+#include <stdint.h>
+#include "errorstack.h"
+
+enum {
+    STORAGE_PAGE_SIZE = 1024U,  ///< Size of a flash page in bytes (STM32F103 medium density)
+};
+
+/**
+ * @brief Enumeration of the flash pages reserved by the linker script for non-volatile records
+ * @attention The STORAGE region of the linker script must be at least NB_STORAGE_PAGES pages long
+ */
+typedef enum {
+    STORAGE_POWERFAIL = 0,  ///< State records written when the supply voltage drops (see powerfail.c)
+    STORAGE_MOUNTING,       ///< Mounting orientation calibration (last flash page)
+    NB_STORAGE_PAGES
+} storagePage_e;
+
+const void* storageGetPage(storagePage_e page);
+errorCode_u storageErasePage(storagePage_e page);
+errorCode_u storageWrite(storagePage_e page, uint16_t offset, const void* data, uint16_t size);
+
+#endif
@@ -1,3 +1,23 @@
 #include "systick.h"
 
-volatile systick_t sysTick_ms = 0;
+enum {
+    MICROSECONDS_PER_SECOND = 1000000U,  ///< Number of microseconds in a second
+};
+
+volatile systick_t sysTick_ms           = 0;  ///< Number of milliseconds elapsed since system boot
+uint32_t           cyclesPerMicrosecond = 1;  ///< Number of CPU cycles in a microsecond
+
+/**
+ * @brief Start the microseconds timebase (DWT cycles counter)
+ * @warning This must be called once the system clock is configured
+ */
+void initialiseMicroseconds(void) {
+    cyclesPerMicrosecond = SystemCoreClock / MICROSECONDS_PER_SECOND;
+    if(!cyclesPerMicrosecond) {
+        cyclesPerMicrosecond = 1;
+    }
+
+    SET_BIT(CoreDebug->DEMCR, CoreDebug_DEMCR_TRCENA_Msk);
+    WRITE_REG(DWT->CYCCNT, 0);
+    SET_BIT(DWT->CTRL, DWT_CTRL_CYCCNTENA_Msk);
+}
@@ -2,10 +2,15 @@
 #define USERDEFINED_SYSTICK_H_INCLUDED
 #include <stdint.h>
 #include <stdlib.h>
+#include "stm32f1xx.h"
 
 typedef uint32_t systick_t;
+typedef uint32_t cyclecount_t;  ///< Value of the DWT CPU cycles counter (see getCycleCount())
 
-extern volatile systick_t sysTick_ms;  ///< Number of milliseconds elapsed since system boot
+extern volatile systick_t sysTick_ms;            ///< Number of milliseconds elapsed since system boot
+extern uint32_t           cyclesPerMicrosecond;  ///< Number of CPU cycles in a microsecond
+
+void initialiseMicroseconds(void);
 
 /**
  * @brief Increment system ticks count
@@ -36,4 +41,42 @@ static inline uint8_t isTimeElapsed(systick_t previousTick_ms, size_t timespan_m
     return ((sysTick_ms - previousTick_ms) >= (systick_t)timespan_ms);
 }
 
+/**
+ * @brief Get the CPU cycles count, used as the microseconds timebase
+ * @note This is the raw DWT cycles counter (sub-microsecond resolution without any interrupt) :
+ *       a difference of two counts is converted with getElapsed_us() or isTimeElapsed_us(),
+ *       unless it is accumulated in CPU cycles (profiling)
+ *
+ * @return Current CPU cycles count
+ */
+static inline cyclecount_t getCycleCount(void) {
+    return (DWT->CYCCNT);
+}
+
+/**
+ * @brief Get the time elapsed since a saved CPU cycles count
+ * @note The difference is computed modulo 2^32, which makes it safe across the counter overflow,
+ *       as long as the time elapsed stays under 2^32 cycles (59s at 72MHz)
+ *
+ * @param previousCount Last saved CPU cycles count (see getCycleCount())
+ * @return Time elapsed in microseconds
+ */
+static inline uint32_t getElapsed_us(cyclecount_t previousCount) {
+    return ((DWT->CYCCNT - previousCount) / cyclesPerMicrosecond);
+}
+
+/**
+ * @brief Check if a time span has elapsed since a saved CPU cycles count
+ * @note The difference is computed modulo 2^32, which makes it safe across the counter overflow,
+ *       as long as the time span stays under 2^32 cycles (59s at 72MHz)
+ *
+ * @param previousCount Last saved CPU cycles count (see getCycleCount())
+ * @param timespan_us Time span in microseconds
+ * @retval 0 Time span not elapsed
+ * @retval 1 Time span elapsed
+ */
+static inline uint8_t isTimeElapsed_us(cyclecount_t previousCount, uint32_t timespan_us) {
+    return ((DWT->CYCCNT - previousCount) >= (timespan_us * cyclesPerMicrosecond));
+}
+
 #endif
@@ -118,6 +118,23 @@ void Error_Handler(void);
 #endif
 
 /* USER CODE BEGIN Private defines */
+#if defined(LSM6DSO_DUAL_SENSOR)
+#define LSM6DSO2_CS_Pin LL_GPIO_PIN_3
+#define LSM6DSO2_CS_GPIO_Port GPIOA
+#define LSM6DSO2_INT1_Pin LL_GPIO_PIN_2
+#define LSM6DSO2_INT1_GPIO_Port GPIOA
+#define LSM6DSO2_INT1_EXTI_Line LL_EXTI_LINE_2
+#endif
+#if defined(LSM6DSO_TAP_CONTROL)
+#define LSM6DSO_INT2_Pin LL_GPIO_PIN_5
+#define LSM6DSO_INT2_GPIO_Port GPIOB
+#define LSM6DSO_INT2_EXTI_Line LL_EXTI_LINE_5
+#endif
+#if defined(LSM6DSO_TILT_ALARM)
+#define LSM6DSO_INT1_EXTI_Line LL_EXTI_LINE_0
+#define TILT_ALARM_Pin LL_GPIO_PIN_8
+#define TILT_ALARM_GPIO_Port GPIOB
+#endif
 
 /* USER CODE END Private defines */
 
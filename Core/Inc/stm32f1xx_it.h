@@ -56,7 +56,11 @@ void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
 /* USER CODE BEGIN EFP */
-
+void PVD_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void EXTI0_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void DMA1_Channel5_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
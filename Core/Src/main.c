@@ -28,7 +28,11 @@
 /* USER CODE BEGIN Includes */
 #include "LSM6DSO.h"
 #include "SSD1306.h"
+#include "blit.h"
 #include "buttons.h"
+#include "logger.h"
+#include "powerfail.h"
+#include "systick.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -38,6 +42,11 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define MOUNTING_CALIBRATION_MS 5000U  ///< Number of milliseconds the zero button is held down to calibrate the mounting
+#if !defined(AUTO_POWER_OFF_MIN)
+#define AUTO_POWER_OFF_MIN 10U        ///< Number of minutes without movement nor button pressed before shutting down (0 : never)
+#endif
+#define AUTO_POWER_OFF_MS (AUTO_POWER_OFF_MIN * 60000U)  ///< Number of milliseconds before shutting down
 
 /* USER CODE END PD */
 
@@ -66,6 +75,18 @@ extern inline uint8_t isError(const errorCode_u code);
 static inline void powerOFF(){
   LL_GPIO_ResetOutputPin(POWER_ON_GPIO_Port, POWER_ON_Pin);
 }
+
+/**
+ * @brief Turn the screen off, write the application state in flash (restored at the next boot) and shut down
+ */
+static void shutDown(){
+  ssd1306TurnDisplayOFF();
+  errorCode_u result = powerfailSaveState();
+  if(isError(result)){
+    LOG1("state not saved before shutting down, error 0x%08X", result.dword);
+  }
+  powerOFF();
+}
 /* USER CODE END 0 */
 
 /**
@@ -77,6 +98,11 @@ int main(void)
 
   /* USER CODE BEGIN 1 */
   uint8_t holdingValues = 0;
+  uint8_t mountingCalibrated = 0;
+  powerfailState_t powerState = {0};
+#if AUTO_POWER_OFF_MIN > 0
+  systick_t inactivityTimer_ms = 0;
+#endif
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -114,8 +140,27 @@ int main(void)
   MX_SPI1_Init();
   /* USER CODE BEGIN 2 */
   LL_SYSTICK_EnableIT();
-  lsm6dsoInitialise(SPI1);
+  initialiseMicroseconds();
+  lsm6dsoInitialise(SPI1, DMA1, LL_DMA_CHANNEL_2, LL_DMA_CHANNEL_3);
+  blitInitialise(DMA1, LL_DMA_CHANNEL_1);
   ssd1306Initialise(SPI2, DMA1, LL_DMA_CHANNEL_5);
+#if defined(DISPLAY_ORIENTATION_FLIPPED)
+  ssd1306SetOrientation(ORIENTATION_FLIPPED);
+#endif
+
+  LOG1("boot, reset flags 0x%08X", READ_REG(RCC->CSR));
+
+  //restore the state written at the latest power failure, and arm the power-fail detection
+  if(isError(powerfailInitialise(DMA1, &powerState))){
+    LOG0("power-fail detection : no record can be written");
+  }
+  lsm6dsoRestoreZeroing(powerState.zeroing_rad);
+  ssd1306PrintReferentialIcon(powerState.relative ? RELATIVE : ABSOLUTE);
+  LOG3("state records %u, last flush %u us, last error 0x%08X", powerfailGetNbRecords(), powerfailGetLastFlush_us(),
+       powerState.lastError);
+
+  //clear the reset flags, so the next reset cause can be told apart (used by the LSM6DSO self-test cache)
+  LL_RCC_ClearResetFlags();
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -126,45 +171,101 @@ int main(void)
     //reset the watchdog
     LL_IWDG_ReloadCounter(IWDG);
 
+    //if the supply voltage dropped, stop updating the peripherals (state already written in flash)
+    if(powerfailUpdate()){
+      continue;
+    }
+
 	  //update the MEMS sensor state machine
 	  result = lsm6dsoUpdate();
 	  if(isError(result)){
 		  result.moduleID = 1;
+      LOG1("LSM6DSO error 0x%08X", result.dword);
+      powerState.lastError = result.dword;
+      powerfailSetState(&powerState);
     }
 
 	  //update the screen state machine
 	  result = ssd1306Update();
 	  if(isError(result)){
 		  result.moduleID = 2;
+      LOG1("SSD1306 error 0x%08X", result.dword);
+      powerState.lastError = result.dword;
+      powerfailSetState(&powerState);
     }
 
+    //send the log messages buffered, without blocking
+    loggerFlush();
+
     //update the buttons' state machines
     buttonsUpdate();
 
+    //get the latest tap gesture (single tap acting as the zero button, double tap as the hold button)
+    const lsm6dsoTap_e tap = lsm6dsoGetTap();
+
     //if zero button is pressed, zero down measurements
-    if(buttonHasRisingEdge(ZERO)){
+    if(buttonHasRisingEdge(ZERO) || (tap == TAP_SINGLE)){
      lsm6dsoZeroDown();
       ssd1306PrintReferentialIcon(RELATIVE);
+      lsm6dsoGetZeroing(powerState.zeroing_rad);
+      powerState.relative = 1;
+      powerfailSetState(&powerState);
     }
 
     //if zero button is held down, get back to absolute measurements
     if(isButtonHeldDown(ZERO)){
      lsm6dsoCancelZeroing();
       ssd1306PrintReferentialIcon(ABSOLUTE);
+      lsm6dsoGetZeroing(powerState.zeroing_rad);
+      powerState.relative = 0;
+      powerfailSetState(&powerState);
+    }
+
+    //if zero button is held down even longer, use the current position as the absolute reference (once per press)
+    if(isButtonHeldDownFor(ZERO, MOUNTING_CALIBRATION_MS) && !mountingCalibrated){
+      mountingCalibrated = 1;
+      result = lsm6dsoCalibrateMounting();
+      if(isError(result)){
+        result.moduleID = 1;
+      }
+      LOG1("mounting calibration, result 0x%08X", result.dword);
+    }
+    else if(isButtonReleased(ZERO)){
+      mountingCalibrated = 0;
     }
 
-    if(buttonHasRisingEdge(HOLD)){
+    if(buttonHasRisingEdge(HOLD) || (tap == TAP_DOUBLE)){
       holdingValues = !holdingValues;
       lsm6dsoHold(holdingValues);
       ssd1306PrintHoldIcon(holdingValues);
     }
 
+#if defined(DISPLAY_ORIENTATION_AUTO)
+    //flip the screen if it is held upside down (hysteresis done by the sensor)
+    ssd1306SetOrientation(lsm6dsoIsUpsideDown() ? ORIENTATION_FLIPPED : ORIENTATION_NORMAL);
+#endif
+
     //if power button is held down, shut down
     if(isButtonHeldDown(POWER)){
-      ssd1306TurnDisplayOFF();
-      powerOFF();
+      shutDown();
     }
 
+#if AUTO_POWER_OFF_MIN > 0
+    //if the device has been left still without any button pressed for too long, shut down
+    if(lsm6dsoIsMoving() || isAnyButtonPressed()){
+      inactivityTimer_ms = getSystick();
+    }
+    if(isTimeElapsed(inactivityTimer_ms, AUTO_POWER_OFF_MS)){
+      LOG0("inactivity, shutting down");
+      shutDown();
+    }
+#endif
+
+#if defined(LSM6DSO_PREDICTION)
+    //let the sensor extrapolate the angles to the time at which they will be displayed
+    lsm6dsoSetRenderLatency(ssd1306GetFrameDuration_us());
+#endif
+
 	  //if X axis angle changed, update the screen
 	  if(lsm6dsoHasChanged(X_AXIS)){
 		  ssd1306PrintAngleTenths(getAngleDegreesTenths(X_AXIS), ROLL);
@@ -174,6 +275,11 @@ int main(void)
 	  if(lsm6dsoHasChanged(Y_AXIS)){
 		  ssd1306PrintAngleTenths(getAngleDegreesTenths(Y_AXIS), PITCH);
     }
+
+    //if the slope changed, update its direction arrow
+    if(lsm6dsoSlopeHasChanged()){
+      ssd1306PrintSlopeArrow(lsm6dsoGetSlopeAzimuthDegreesTenths(), lsm6dsoGetTiltDegreesTenths());
+    }
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -58,6 +58,26 @@ void MX_SPI1_Init(void)
 
   /* USER CODE BEGIN SPI1_Init 1 */
 
+  /* SPI1 DMA Init (LSM6DSO measurement bursts) */
+
+  /* SPI1_RX Init */
+  LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_2, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+  LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_2, LL_DMA_PRIORITY_HIGH);
+  LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_2, LL_DMA_MODE_NORMAL);
+  LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_2, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_2, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_2, LL_DMA_PDATAALIGN_BYTE);
+  LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_2, LL_DMA_MDATAALIGN_BYTE);
+
+  /* SPI1_TX Init (constant filler byte, hence no memory increment) */
+  LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_3, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+  LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_3, LL_DMA_PRIORITY_MEDIUM);
+  LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_3, LL_DMA_MODE_NORMAL);
+  LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_3, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_3, LL_DMA_MEMORY_NOINCREMENT);
+  LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_3, LL_DMA_PDATAALIGN_BYTE);
+  LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_3, LL_DMA_MDATAALIGN_BYTE);
+
   /* USER CODE END SPI1_Init 1 */
   SPI_InitStruct.TransferDirection = LL_SPI_FULL_DUPLEX;
   SPI_InitStruct.Mode = LL_SPI_MODE_MASTER;
@@ -71,7 +91,63 @@ void MX_SPI1_Init(void)
   SPI_InitStruct.CRCPoly = 10;
   LL_SPI_Init(SPI1, &SPI_InitStruct);
   /* USER CODE BEGIN SPI1_Init 2 */
+#if defined(LSM6DSO_DUAL_SENSOR)
+  /* Two devices on the bus : chip selects driven by software, both released */
+  LL_SPI_SetNSSMode(SPI1, LL_SPI_NSS_SOFT);
+  LL_GPIO_SetOutputPin(GPIOA, LSM6DSO_CS_Pin|LSM6DSO2_CS_Pin);
 
+  GPIO_InitStruct.Pin = LSM6DSO_CS_Pin|LSM6DSO2_CS_Pin;
+  GPIO_InitStruct.Mode = LL_GPIO_MODE_OUTPUT;
+  GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+  LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+  GPIO_InitStruct.Pin = LSM6DSO2_INT1_Pin;
+  GPIO_InitStruct.Mode = LL_GPIO_MODE_INPUT;
+  GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;
+  LL_GPIO_Init(LSM6DSO2_INT1_GPIO_Port, &GPIO_InitStruct);
+#endif
+#if defined(LSM6DSO_TAP_CONTROL)
+  /* LSM6DSO INT2 (tap events, active high : the reset clears H_LACTIVE) : rising edge interrupt on EXTI line 5 */
+  GPIO_InitStruct.Pin = LSM6DSO_INT2_Pin;
+  GPIO_InitStruct.Mode = LL_GPIO_MODE_INPUT;
+  GPIO_InitStruct.Pull = LL_GPIO_PULL_UP;
+  LL_GPIO_Init(LSM6DSO_INT2_GPIO_Port, &GPIO_InitStruct);
+
+  LL_GPIO_AF_SetEXTISource(LL_GPIO_AF_EXTI_PORTB, LL_GPIO_AF_EXTI_LINE5);
+  LL_EXTI_ClearFlag_0_31(LSM6DSO_INT2_EXTI_Line);
+  LL_EXTI_EnableRisingTrig_0_31(LSM6DSO_INT2_EXTI_Line);
+  LL_EXTI_EnableIT_0_31(LSM6DSO_INT2_EXTI_Line);
+  NVIC_SetPriority(EXTI9_5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+  NVIC_EnableIRQ(EXTI9_5_IRQn);
+#endif
+#if defined(LSM6DSO_TILT_ALARM)
+  /* Tilt alarm output (active high), released at boot */
+  LL_GPIO_ResetOutputPin(TILT_ALARM_GPIO_Port, TILT_ALARM_Pin);
+
+  GPIO_InitStruct.Pin = TILT_ALARM_Pin;
+  GPIO_InitStruct.Mode = LL_GPIO_MODE_OUTPUT;
+  GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_LOW;
+  GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+  LL_GPIO_Init(TILT_ALARM_GPIO_Port, &GPIO_InitStruct);
+
+  /* LSM6DSO INT1 data-ready edges timestamped on EXTI line 0 (alarm latency measurement, highest priority after PVD) */
+  LL_GPIO_AF_SetEXTISource(LL_GPIO_AF_EXTI_PORTB, LL_GPIO_AF_EXTI_LINE0);
+  LL_EXTI_ClearFlag_0_31(LSM6DSO_INT1_EXTI_Line);
+  LL_EXTI_EnableRisingTrig_0_31(LSM6DSO_INT1_EXTI_Line);
+  LL_EXTI_EnableIT_0_31(LSM6DSO_INT1_EXTI_Line);
+  NVIC_SetPriority(EXTI0_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 0));
+  NVIC_EnableIRQ(EXTI0_IRQn);
+#if defined(LSM6DSO_DUAL_SENSOR)
+  /* Second LSM6DSO INT1 data-ready edges timestamped on EXTI line 2 */
+  LL_GPIO_AF_SetEXTISource(LL_GPIO_AF_EXTI_PORTA, LL_GPIO_AF_EXTI_LINE2);
+  LL_EXTI_ClearFlag_0_31(LSM6DSO2_INT1_EXTI_Line);
+  LL_EXTI_EnableRisingTrig_0_31(LSM6DSO2_INT1_EXTI_Line);
+  LL_EXTI_EnableIT_0_31(LSM6DSO2_INT1_EXTI_Line);
+  NVIC_SetPriority(EXTI2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 0));
+  NVIC_EnableIRQ(EXTI2_IRQn);
+#endif
+#endif
   /* USER CODE END SPI1_Init 2 */
 
 }
@@ -134,7 +210,11 @@ void MX_SPI2_Init(void)
   SPI_InitStruct.CRCPoly = 10;
   LL_SPI_Init(SPI2, &SPI_InitStruct);
   /* USER CODE BEGIN SPI2_Init 2 */
-
+#if defined(DISPLAY_PANEL_SH1106)
+  /* SPI2 TX DMA interrupt : chains the page commands and data transfers of the SH1106 */
+  NVIC_SetPriority(DMA1_Channel5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 4, 0));
+  NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+#endif
   /* USER CODE END SPI2_Init 2 */
 
 }
@@ -23,6 +23,9 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "LSM6DSO.h"
+#include "displayBackend.h"
+#include "powerfail.h"
 #include "systick.h"
 /* USER CODE END Includes */
 
@@ -200,5 +203,51 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles PVD interrupt through EXTI line 16.
+  */
+void PVD_IRQHandler(void)
+{
+  powerfailIRQhandler();
+}
+
+#if defined(LSM6DSO_TAP_CONTROL)
+/**
+  * @brief This function handles EXTI line[9:5] interrupts (LSM6DSO INT2 tap events).
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  lsm6dsoTapIRQhandler();
+}
+#endif
 
+#if defined(LSM6DSO_TILT_ALARM)
+/**
+  * @brief This function handles EXTI line0 interrupt (LSM6DSO INT1 data-ready edges, tilt alarm latency).
+  */
+void EXTI0_IRQHandler(void)
+{
+  lsm6dsoDataReadyIRQhandler(LSM6DSO_PRIMARY);
+}
+
+#if defined(LSM6DSO_DUAL_SENSOR)
+/**
+  * @brief This function handles EXTI line2 interrupt (second LSM6DSO INT1 data-ready edges, tilt alarm latency).
+  */
+void EXTI2_IRQHandler(void)
+{
+  lsm6dsoDataReadyIRQhandler(LSM6DSO_SECONDARY);
+}
+#endif
+#endif
+
+#if defined(DISPLAY_PANEL_SH1106)
+/**
+  * @brief This function handles DMA1 channel5 global interrupt (SPI2 TX, SH1106 page chaining).
+  */
+void DMA1_Channel5_IRQHandler(void)
+{
+  panelDMAIRQhandler();
+}
+#endif
 /* USER CODE END 1 */
@@ -0,0 +1,66 @@
+##############################################################################################
+# brief: Check the link map for libm and heap (malloc, _sbrk, errno) symbols,
+#        and report the memory they occupy
+# usage: cmake -DMAP_FILE=<map file> [-DFAIL_ON_LIBM=ON] -P check_libm.cmake
+# date:  18/10/2026
+##############################################################################################
+if(NOT EXISTS "${MAP_FILE}")
+    message(FATAL_ERROR "Link map ${MAP_FILE} not found")
+endif()
+
+#only keep the memory map (the discarded input sections are listed before it)
+file(READ "${MAP_FILE}" mapContent)
+string(FIND "${mapContent}" "Linker script and memory map" mapStart)
+if(mapStart LESS 0)
+    message(FATAL_ERROR "${MAP_FILE} does not hold a memory map")
+endif()
+string(SUBSTRING "${mapContent}" ${mapStart} -1 memoryMap)
+
+#list the input sections coming from libm, or from the newlib heap and errno objects
+string(REGEX MATCHALL
+    "\n \\.[a-z]+[^ \n]*[ \t\n]+0x[0-9a-f]+[ \t]+0x[0-9a-f]+[ \t]+[^\n]*(libm\\.a\\(|libc\\.a\\(libc_a-(nano-)?(malloc|mallocr|freer|sbrkr|errno))[^\n]*"
+    offendingSections "${memoryMap}")
+
+#list the heap symbols defined by the application itself (e.g. _sbrk in sysmem.c)
+string(REGEX MATCHALL "\n[ \t]+0x[0-9a-f]+[ \t]+(_sbrk|malloc|_malloc_r|free|_free_r|__errno)\n" offendingSymbols
+    "${memoryMap}")
+
+#sum the flash and RAM occupied by the sections
+set(flashBytes 0)
+set(ramBytes 0)
+set(offendingObjects "")
+foreach(section IN LISTS offendingSections)
+    string(REGEX MATCH "^\n \\.([a-z]+)" sectionType "${section}")
+    set(sectionType "${CMAKE_MATCH_1}")
+    string(REGEX MATCH "0x[0-9a-f]+[ \t]+(0x[0-9a-f]+)[ \t]+([^\n]*)$" sectionSize "${section}")
+    math(EXPR sectionSize "${CMAKE_MATCH_1}")
+    list(APPEND offendingObjects "${CMAKE_MATCH_2}")
+
+    if(sectionType STREQUAL "bss")
+        math(EXPR ramBytes "${ramBytes} + ${sectionSize}")
+    elseif(sectionType STREQUAL "data")
+        math(EXPR ramBytes "${ramBytes} + ${sectionSize}")
+        math(EXPR flashBytes "${flashBytes} + ${sectionSize}")
+    else()
+        math(EXPR flashBytes "${flashBytes} + ${sectionSize}")
+    endif()
+endforeach()
+
+foreach(symbol IN LISTS offendingSymbols)
+    string(REGEX MATCH "(_sbrk|malloc|_malloc_r|free|_free_r|__errno)" symbolName "${symbol}")
+    list(APPEND offendingObjects "${symbolName}")
+endforeach()
+
+list(REMOVE_DUPLICATES offendingObjects)
+list(LENGTH offendingObjects nbOffending)
+if(nbOffending EQUAL 0)
+    message(STATUS "No libm or heap symbol linked")
+    return()
+endif()
+
+string(REPLACE ";" "\n    " offendingList "${offendingObjects}")
+if(FAIL_ON_LIBM)
+    message(FATAL_ERROR "libm or heap symbols linked (${flashBytes} bytes of flash, ${ramBytes} bytes of RAM) :\n    ${offendingList}")
+endif()
+
+message(STATUS "libm and heap use ${flashBytes} bytes of flash and ${ramBytes} bytes of RAM (saved with LEANY_NO_LIBM)")
@@ -0,0 +1,334 @@
+/**
+ * @file blitBenchmark.c
+ * @brief Host benchmark of each blit primitive against a byte-by-byte reference
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  Each primitive draws a typical screen operation (full background, widget area, sprite at any row, ...)
+ *  in a frame buffer, and a naive reference (one byte or one pixel at a time) draws the same in another one.
+ *  Both frame buffers must match, then both are timed over many iterations and the time per call is printed.
+ *  The host timings only compare the implementations : the target cycles are measured by the display profiling.
+ *  The background transfers run without DMA channel, so their CPU path is timed.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "blit.h"
+
+enum {
+    NB_ITERATIONS = 20000U,  ///< Number of calls timed for each primitive and its reference
+    SPRITE_WIDTH  = 24U,     ///< Number of columns of the sprite drawn
+    SPRITE_PAGES  = 3U,      ///< Number of pages of the sprite drawn
+    SPRITE_ROW    = 13U,     ///< Pixel row at which the sprite is drawn when not page-aligned
+    SPRITE_COLUMN = 50U,     ///< Column at which the sprite is drawn
+    PAGE_HEIGHT   = 8U,      ///< Number of pixel rows in a page
+    FRAME_SIZE    = (WIDGET_NB_PAGES * WIDGET_SCREEN_WIDTH),  ///< Number of bytes in a frame buffer
+    NS_PER_SECOND = 1000000000U,                               ///< Number of nanoseconds in a second
+};
+
+/**
+ * @brief Function drawing in a frame buffer
+ */
+typedef void (*drawFunction_t)(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+
+/**
+ * @brief Structure describing a benchmark case
+ */
+typedef struct {
+    const char*    name;       ///< Name of the case
+    drawFunction_t blit;       ///< Drawing done with the blit primitive
+    drawFunction_t reference;  ///< Same drawing done by the reference
+} benchmarkCase_t;
+
+static void   drawFill(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceFill(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawClear(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceClear(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawCopy(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceCopy(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawMaskedAligned(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceMaskedAligned(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawMaskedShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceMaskedShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawOpaqueShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceOpaqueShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawCopyAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceCopyAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   drawFillAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceFillAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+static void   referenceSprite(uint8_t frame[][WIDGET_SCREEN_WIDTH], const blitSprite_t* sprite, uint8_t row);
+static double timeFunction(drawFunction_t function, uint8_t frame[][WIDGET_SCREEN_WIDTH]);
+
+static const widgetRectangle_t SCREEN = {0, WIDGET_NB_PAGES, 0, WIDGET_SCREEN_WIDTH};  ///< Whole screen area
+static const widgetRectangle_t WIDGET = {2, 3, 37, 54};                               ///< Typical widget area
+
+static uint8_t      background[FRAME_SIZE] __attribute__((aligned(4)));  ///< Screen background copied
+static uint8_t      spriteBitmap[SPRITE_PAGES * SPRITE_WIDTH];           ///< Sprite pixels
+static uint8_t      spriteMask[SPRITE_PAGES * SPRITE_WIDTH];             ///< Sprite mask
+static blitSprite_t maskedSprite = {spriteBitmap, spriteMask, SPRITE_WIDTH, SPRITE_PAGES};  ///< Sprite with a mask
+static blitSprite_t opaqueSprite = {spriteBitmap, (void*)0, SPRITE_WIDTH, SPRITE_PAGES};    ///< Sprite without mask
+static uint8_t blitFrame[WIDGET_NB_PAGES][WIDGET_SCREEN_WIDTH] __attribute__((aligned(4)));  ///< Drawn by blit
+static uint8_t referenceFrame[WIDGET_NB_PAGES][WIDGET_SCREEN_WIDTH] __attribute__((aligned(4)));  ///< Drawn by ref.
+
+/**
+ * @brief Cases benchmarked, one per primitive and drawing situation
+ */
+static const benchmarkCase_t cases[] = {
+    {"blitFill (screen)",            drawFill,          referenceFill         },
+    {"blitClear (widget)",           drawClear,         referenceClear        },
+    {"blitCopy (screen)",            drawCopy,          referenceCopy         },
+    {"blitMasked (page-aligned)",    drawMaskedAligned, referenceMaskedAligned},
+    {"blitMasked (shifted)",         drawMaskedShifted, referenceMaskedShifted},
+    {"blitMasked (shifted, opaque)", drawOpaqueShifted, referenceOpaqueShifted},
+    {"blitCopyAsync (CPU)",          drawCopyAsync,     referenceCopyAsync    },
+    {"blitFillAsync (CPU)",          drawFillAsync,     referenceFillAsync    },
+};
+
+/**
+ * @brief Check each primitive against its reference, then time both
+ *
+ * @return 0 if all the primitives drew the same as their reference, 1 otherwise
+ */
+int main(void) {
+    uint32_t nbFailures = 0;
+
+    for(uint16_t i = 0; i < (uint16_t)FRAME_SIZE; i++) {
+        background[i] = (uint8_t)((i * 37U) ^ (i >> 3U));
+    }
+    for(uint16_t i = 0; i < (uint16_t)(SPRITE_PAGES * SPRITE_WIDTH); i++) {
+        spriteBitmap[i] = (uint8_t)(i * 11U);
+        spriteMask[i]   = (uint8_t)~(i * 5U);
+    }
+    blitInitialise((void*)0, 0);
+
+    printf("%-30s %12s %12s %8s\n", "primitive", "blit [ns]", "ref. [ns]", "speedup");
+    for(uint8_t i = 0; i < (uint8_t)(sizeof(cases) / sizeof(cases[0])); i++) {
+        memcpy(blitFrame, background, FRAME_SIZE);
+        memcpy(referenceFrame, background, FRAME_SIZE);
+        cases[i].blit(blitFrame);
+        cases[i].reference(referenceFrame);
+        if(memcmp(blitFrame, referenceFrame, FRAME_SIZE)) {
+            printf("FAILED : %s differs from the reference\n", cases[i].name);
+            nbFailures++;
+            continue;
+        }
+
+        const double blit_ns      = timeFunction(cases[i].blit, blitFrame);
+        const double reference_ns = timeFunction(cases[i].reference, referenceFrame);
+        printf("%-30s %12.1f %12.1f %7.1fx\n", cases[i].name, blit_ns, reference_ns, reference_ns / blit_ns);
+    }
+
+    return (nbFailures ? 1 : 0);
+}
+
+/**
+ * @brief Time a drawing function
+ *
+ * @param function Function to time
+ * @param[out] frame Frame buffer in which draw
+ * @return Average time of a call in [ns]
+ */
+static double timeFunction(drawFunction_t function, uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    struct timespec start;
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t i = 0; i < (uint32_t)NB_ITERATIONS; i++) {
+        function(frame);
+        __asm__ volatile("" : : "r"(frame) : "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const double elapsed_ns = ((double)(end.tv_sec - start.tv_sec) * NS_PER_SECOND)
+                            + (double)(end.tv_nsec - start.tv_nsec);
+    return (elapsed_ns / NB_ITERATIONS);
+}
+
+/**
+ * @brief Draw a sprite one pixel at a time
+ *
+ * @param[out] frame Frame buffer
+ * @param[in] sprite Sprite to draw
+ * @param row Pixel row of the top of the sprite
+ */
+static void referenceSprite(uint8_t frame[][WIDGET_SCREEN_WIDTH], const blitSprite_t* sprite, uint8_t row) {
+    for(uint8_t column = 0; column < sprite->width; column++) {
+        for(uint8_t pixel = 0; pixel < (uint8_t)(sprite->nbPages * PAGE_HEIGHT); pixel++) {
+            const uint16_t index   = (uint16_t)(((pixel / PAGE_HEIGHT) * sprite->width) + column);
+            const uint8_t  bit     = (uint8_t)(1U << (pixel % PAGE_HEIGHT));
+            const uint8_t  y       = (uint8_t)(row + pixel);
+            const uint8_t  visible = (sprite->mask ? (sprite->mask[index] & bit) : bit);
+
+            if(!visible || (y >= (uint8_t)(WIDGET_NB_PAGES * PAGE_HEIGHT))) {
+                continue;
+            }
+
+            uint8_t* output = &frame[y / PAGE_HEIGHT][SPRITE_COLUMN + column];
+            if(sprite->bitmap[index] & bit) {
+                *output |= (uint8_t)(1U << (y % PAGE_HEIGHT));
+            } else {
+                *output &= (uint8_t)~(1U << (y % PAGE_HEIGHT));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fill the whole screen with blitFill()
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawFill(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitFill(frame, &SCREEN, 0x55U);
+}
+
+/**
+ * @brief Fill the whole screen one byte at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceFill(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    for(uint8_t page = 0; page < (uint8_t)WIDGET_NB_PAGES; page++) {
+        for(uint8_t column = 0; column < (uint8_t)WIDGET_SCREEN_WIDTH; column++) {
+            frame[page][column] = 0x55U;
+        }
+    }
+}
+
+/**
+ * @brief Erase a widget area with blitClear()
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawClear(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitClear(frame, &WIDGET);
+}
+
+/**
+ * @brief Erase a widget area one byte at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceClear(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    for(uint8_t page = 0; page < WIDGET.nbPages; page++) {
+        for(uint8_t column = 0; column < WIDGET.width; column++) {
+            frame[WIDGET.page + page][WIDGET.column + column] = 0x00U;
+        }
+    }
+}
+
+/**
+ * @brief Copy the background on the whole screen with blitCopy()
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawCopy(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitCopy(frame, &SCREEN, background);
+}
+
+/**
+ * @brief Copy the background on the whole screen one byte at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceCopy(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    for(uint8_t page = 0; page < (uint8_t)WIDGET_NB_PAGES; page++) {
+        for(uint8_t column = 0; column < (uint8_t)WIDGET_SCREEN_WIDTH; column++) {
+            frame[page][column] = background[(page * WIDGET_SCREEN_WIDTH) + column];
+        }
+    }
+}
+
+/**
+ * @brief Draw the masked sprite on a page boundary with blitMasked()
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawMaskedAligned(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitMasked(frame, &maskedSprite, SPRITE_COLUMN, PAGE_HEIGHT);
+}
+
+/**
+ * @brief Draw the masked sprite on a page boundary one pixel at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceMaskedAligned(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    referenceSprite(frame, &maskedSprite, PAGE_HEIGHT);
+}
+
+/**
+ * @brief Draw the masked sprite across pages with blitMasked()
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawMaskedShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitMasked(frame, &maskedSprite, SPRITE_COLUMN, SPRITE_ROW);
+}
+
+/**
+ * @brief Draw the masked sprite across pages one pixel at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceMaskedShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    referenceSprite(frame, &maskedSprite, SPRITE_ROW);
+}
+
+/**
+ * @brief Draw the sprite without mask across pages with blitMasked()
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawOpaqueShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitMasked(frame, &opaqueSprite, SPRITE_COLUMN, SPRITE_ROW);
+}
+
+/**
+ * @brief Draw the sprite without mask across pages one pixel at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceOpaqueShifted(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    referenceSprite(frame, &opaqueSprite, SPRITE_ROW);
+}
+
+/**
+ * @brief Copy the background on the whole screen with blitCopyAsync(), and wait for it
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawCopyAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitCopyAsync(frame, background, FRAME_SIZE);
+    while(blitIsBusy()) {}
+}
+
+/**
+ * @brief Copy the background on the whole screen one byte at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceCopyAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    referenceCopy(frame);
+}
+
+/**
+ * @brief Fill the whole screen with blitFillAsync(), and wait for it
+ *
+ * @param[out] frame Frame buffer
+ */
+static void drawFillAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    blitFillAsync(frame, 0x55U, FRAME_SIZE);
+    while(blitIsBusy()) {}
+}
+
+/**
+ * @brief Fill the whole screen one byte at a time
+ *
+ * @param[out] frame Frame buffer
+ */
+static void referenceFillAsync(uint8_t frame[][WIDGET_SCREEN_WIDTH]) {
+    referenceFill(frame);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file blitTest.c
+ * @brief Host test of the blit background transfers, including the CPU fallback on a DMA transfer error
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The blit module runs against the mock DMA1 channel 1. The test plays the DMA part :
+ *  either it copies the words and flags the transfer complete (channel left enabled, as in normal mode),
+ *  or it flags a transfer error and disables the channel, as the hardware does.
+ *  In the latter case, blitIsBusy() must notice the error and do the transfer with the CPU.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blit.h"
+#include "stm32f103xb.h"
+#include "stm32f1xx_ll_dma.h"
+
+enum {
+    BUFFER_SIZE    = 512U,   ///< Size of the buffers transferred (large enough to go through the DMA)
+    SMALL_SIZE     = 16U,    ///< Size of a transfer done by the CPU (too small for the DMA)
+    WORD_SIZE      = 4U,     ///< Number of bytes in a word
+    ERROR_PROGRESS = 64U,    ///< Number of bytes written by the DMA before the transfer error
+    FILL_PATTERN   = 0xA5U,  ///< Byte used by the fills
+    STALE_PATTERN  = 0x3CU,  ///< Byte initially held by the destination
+};
+
+static void completeDma(void);
+static void failDma(void);
+static void check(uint8_t condition, const char* message);
+
+static uint8_t  source[BUFFER_SIZE] __attribute__((aligned(4)));       ///< Source of the copies
+static uint8_t  destination[BUFFER_SIZE] __attribute__((aligned(4)));  ///< Destination of the transfers
+static uint8_t  expected[BUFFER_SIZE];                                 ///< Destination expected
+static uint32_t nbFailures = 0;                                        ///< Number of checks failed
+
+/**
+ * @brief Run the background transfers through the DMA, with and without transfer error
+ *
+ * @return 0 if all the checks passed, 1 otherwise
+ */
+int main(void) {
+    for(uint16_t i = 0; i < (uint16_t)BUFFER_SIZE; i++) {
+        source[i] = (uint8_t)(i * 7U);
+    }
+
+    mockResetPeripherals();
+    blitInitialise(DMA1, LL_DMA_CHANNEL_1);
+
+    //DMA copy completed
+    memset(destination, STALE_PATTERN, sizeof(destination));
+    blitCopyAsync(destination, source, BUFFER_SIZE);
+    mockDmaLatchFlags();
+    check(blitIsBusy(), "copy in progress");
+    check(LL_DMA_IsEnabledChannel(DMA1, LL_DMA_CHANNEL_1), "copy started by DMA");
+    completeDma();
+    check(!blitIsBusy(), "copy done");
+    check(!LL_DMA_IsEnabledChannel(DMA1, LL_DMA_CHANNEL_1), "channel disabled after the copy");
+    check(!memcmp(destination, source, BUFFER_SIZE), "copy by DMA");
+
+    //DMA copy failed : done again by the CPU
+    memset(destination, STALE_PATTERN, sizeof(destination));
+    blitCopyAsync(destination, source, BUFFER_SIZE);
+    mockDmaLatchFlags();
+    failDma();
+    check(!blitIsBusy(), "failed copy not busy");
+    check(!memcmp(destination, source, BUFFER_SIZE), "failed copy done by the CPU");
+    check(READ_REG(DMA1->IFCR) & DMA_IFCR_CGIF1, "failed copy flags cleared");
+    check(!blitIsBusy(), "failed copy not done twice");
+
+    //DMA fill failed : done again by the CPU
+    memset(destination, STALE_PATTERN, sizeof(destination));
+    memset(expected, FILL_PATTERN, sizeof(expected));
+    blitFillAsync(destination, FILL_PATTERN, BUFFER_SIZE);
+    mockDmaLatchFlags();
+    check(blitIsBusy(), "fill in progress");
+    failDma();
+    check(!blitIsBusy(), "failed fill not busy");
+    check(!memcmp(destination, expected, BUFFER_SIZE), "failed fill done by the CPU");
+
+    //DMA copy after an error
+    memset(destination, STALE_PATTERN, sizeof(destination));
+    blitCopyAsync(destination, source, BUFFER_SIZE);
+    mockDmaLatchFlags();
+    check(blitIsBusy(), "copy after an error in progress");
+    completeDma();
+    check(!blitIsBusy(), "copy after an error done");
+    check(!memcmp(destination, source, BUFFER_SIZE), "copy after an error by DMA");
+
+    //small transfer done by the CPU before returning
+    memset(destination, STALE_PATTERN, sizeof(destination));
+    blitCopyAsync(destination, source, SMALL_SIZE);
+    check(!blitIsBusy(), "small copy not busy");
+    check(!memcmp(destination, source, SMALL_SIZE), "small copy done by the CPU");
+
+    printf("blit : %u checks failed\n", nbFailures);
+    return (nbFailures ? 1 : 0);
+}
+
+/**
+ * @brief Record the result of a check
+ *
+ * @param condition Result of the check (0 if failed)
+ * @param message Description of the check
+ */
+static void check(uint8_t condition, const char* message) {
+    if(!condition) {
+        printf("FAILED : %s\n", message);
+        nbFailures++;
+    }
+}
+
+/**
+ * @brief Transfer all the words configured on the channel 1, and flag the transfer complete
+ */
+static void completeDma(void) {
+    uint32_t*       output    = (uint32_t*)(uintptr_t)DMA1_Channel1->CMAR;
+    const uint32_t* input     = (const uint32_t*)(uintptr_t)DMA1_Channel1->CPAR;
+    const uint8_t   increment = (READ_BIT(DMA1_Channel1->CCR, DMA_CCR_PINC) != 0U);
+
+    for(uint32_t i = 0; i < DMA1_Channel1->CNDTR; i++) {
+        output[i] = (increment ? input[i] : *input);
+    }
+
+    WRITE_REG(DMA1_Channel1->CNDTR, 0);
+    SET_BIT(DMA1->ISR, DMA_ISR_GIF1 | DMA_ISR_HTIF1 | DMA_ISR_TCIF1);
+}
+
+/**
+ * @brief Write part of the words with garbage, then flag a transfer error (which disables the channel)
+ */
+static void failDma(void) {
+    uint8_t* output = (uint8_t*)(uintptr_t)DMA1_Channel1->CMAR;
+
+    memset(output, 0xFF, ERROR_PROGRESS);
+    WRITE_REG(DMA1_Channel1->CNDTR, DMA1_Channel1->CNDTR - (ERROR_PROGRESS / WORD_SIZE));
+    SET_BIT(DMA1->ISR, DMA_ISR_GIF1 | DMA_ISR_TEIF1);
+    CLEAR_BIT(DMA1_Channel1->CCR, DMA_CCR_EN);
+}
@@ -0,0 +1,520 @@
+/**
+ * @file lsm6dsoBusTest.c
+ * @brief Host test of two LSM6DSO devices sharing the SPI bus and the DMA
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The real LSM6DSO module (state machines, bus layer, pipeline) runs against two device models
+ *  behind the mock SPI and DMA, on the chip selects and data-ready pins of main.h.
+ *  Each model holds a register file and produces its samples at the configured ODR with its own clock drift.
+ *  Its data-ready signal stays latched until the outputs are read, and a sample produced while the previous one
+ *  is still unread is counted as dropped.
+ *  Both devices are brought up (boot, bus calibration, self-test, configuration), then both run at 416Hz
+ *  while a main loop also spends time on other tasks : no sample may be dropped on either device.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include "LSM6DSO.h"
+#include "LSM6DSO_registers.h"
+#include "errorstack.h"
+#include "main.h"
+#include "stm32f103xb.h"
+#include "stm32f1xx_ll_dma.h"
+#include "stm32f1xx_ll_spi.h"
+#include "systick.h"
+
+enum {
+    CYCLES_PER_US        = 72U,       ///< CPU cycles in a microsecond (72MHz)
+    CYCLES_PER_MS        = 72000U,    ///< CPU cycles in a millisecond
+    SPI_BYTE_OVERHEAD    = 20U,       ///< CPU cycles spent around each byte exchanged by polling
+    NB_REGISTERS         = 0x80U,     ///< Number of registers in the device model
+    TIMESTAMP_LSB_US     = 25U,       ///< Duration of a timestamp LSB in [us]
+    TEMPERATURE_ODR_HZ   = 52U,       ///< Temperature output data rate
+    MEASUREMENT_ODR_HZ   = 416U,      ///< Accelerometer and gyroscope output data rate while measuring
+    LOOP_US              = 100U,      ///< Time spent by the main loop on the other tasks at each iteration
+    FRAME_PERIOD_MS      = 50U,       ///< Period of the longer main loop iterations (screen rendering)
+    FRAME_US             = 1500U,     ///< Time spent rendering a frame
+    BRING_UP_TIMEOUT_MS  = 3000U,     ///< Maximum time for both devices to start measuring
+    WINDOW_MS            = 2000U,     ///< Duration of the measuring window checked
+    MAX_RATE_ERROR_PERMIL = 10U,      ///< Maximum error on the number of samples processed, in per mille
+    SPI_IDLE_LEVEL       = 0xFFU,     ///< Byte received when no device drives MISO (pulled up)
+};
+
+#define ODR_SHIFT            4U      ///< Shift of the ODR field in CTRL1_XL and CTRL2_G
+#define FS_SHIFT             2U      ///< Shift of the full scale field in CTRL1_XL and CTRL2_G
+#define FS_MASK              0x03U   ///< Mask of the full scale field (once shifted)
+#define AXL_SELFTEST_MASK    0x03U   ///< Mask of the accelerometer self-test field in CTRL5_C
+#define GYR_SELFTEST_MASK    0x0CU   ///< Mask of the gyroscope self-test field in CTRL5_C
+#define INT1_DRDY_XL         0x01U   ///< Accelerometer data-ready routed on INT1
+#define INT1_DRDY_G          0x02U   ///< Gyroscope data-ready routed on INT1
+#define INT_ACTIVE_LOW       0x20U   ///< Interrupts active low (CTRL3_C)
+#define CTRL3_C_DEFAULT      0x04U   ///< CTRL3_C reset value (address auto-increment)
+#define GRAVITY_MG           1000.0  ///< Gravity measured by the accelerometer in [mG]
+#define AXL_SELFTEST_MG      400.0   ///< Accelerometer output change with the self-test stimulus in [mG]
+#define GYR_SELFTEST_DPS     300.0   ///< Gyroscope output change with the self-test stimulus in [dps]
+
+/**
+ * @brief Structure holding the state of a device model
+ */
+typedef struct {
+    GPIO_TypeDef* csPort;                   ///< Chip select GPIO port
+    uint32_t      csPin;                    ///< Chip select GPIO pin
+    GPIO_TypeDef* intPort;                  ///< INT1 GPIO port
+    uint32_t      intPin;                   ///< INT1 GPIO pin
+    double        clockRatio;               ///< Ratio between the device clock and the CPU clock (drift)
+    uint8_t       registers[NB_REGISTERS];  ///< Registers values
+    double        nextAccelerometer;        ///< CPU cycle at which the next accelerometer sample is produced
+    double        nextGyroscope;            ///< CPU cycle at which the next gyroscope sample is produced
+    double        nextTemperature;          ///< CPU cycle at which the next temperature sample is produced
+    uint8_t       addressed;                ///< Flag indicating the address byte of the transaction is received
+    uint8_t       reading;                  ///< Flag indicating the transaction is a read
+    uint8_t       address;                  ///< Current register address of the transaction
+    uint32_t      accelerometerSamples;     ///< Number of accelerometer samples produced
+    uint32_t      accelerometerDropped;     ///< Number of accelerometer samples overwritten before being read
+    uint32_t      gyroscopeDropped;         ///< Number of gyroscope samples overwritten before being read
+} deviceModel_t;
+
+static void     advanceTime(uint64_t cycles);
+static void     resetModel(deviceModel_t* model);
+static void     produceSamples(deviceModel_t* model);
+static void     updateInterrupt(const deviceModel_t* model);
+static uint8_t  exchangeByte(deviceModel_t* model, uint8_t txData);
+static uint8_t  readRegister(deviceModel_t* model, uint8_t address);
+static void     writeRegister(deviceModel_t* model, uint8_t address, uint8_t value);
+static double   getSamplePeriod(const deviceModel_t* model, uint8_t odrRegister);
+static void     writeOutput(deviceModel_t* model, uint8_t firstRegister, double value, double sensitivity);
+static uint32_t getByteCycles(void);
+static void     processDma(uint64_t enableCycle);
+static void     check(uint8_t condition, const char* message);
+
+static deviceModel_t models[NB_LSM6DSO] = {
+    [LSM6DSO_PRIMARY] = {.csPort     = LSM6DSO_CS_GPIO_Port,
+                         .csPin      = LSM6DSO_CS_Pin,
+                         .intPort    = LSM6DSO_INT1_GPIO_Port,
+                         .intPin     = LSM6DSO_INT1_Pin,
+                         .clockRatio = 1.000150},
+    [LSM6DSO_SECONDARY] = {.csPort     = LSM6DSO2_CS_GPIO_Port,
+                           .csPin      = LSM6DSO2_CS_Pin,
+                           .intPort    = LSM6DSO2_INT1_GPIO_Port,
+                           .intPin     = LSM6DSO2_INT1_Pin,
+                           .clockRatio = 0.999750},
+};
+static deviceModel_t* selected     = (void*)0;  ///< Device model currently selected on the SPI
+static uint64_t       simCycles    = 0;         ///< CPU cycles elapsed since the start of the simulation
+static uint8_t        dmaBusy      = 0;         ///< Flag indicating a DMA burst is being clocked out
+static uint64_t       dmaDoneCycle = 0;         ///< CPU cycle at which the DMA burst in progress is done
+static uint32_t       nbFailures   = 0;         ///< Number of checks failed
+
+/**
+ * @brief Bring both devices up, then check no sample is dropped while they both run at 416Hz
+ *
+ * @return 0 if all the checks passed, 1 otherwise
+ */
+int main(void) {
+    uint32_t samplesBefore[NB_LSM6DSO];
+    uint32_t producedBefore[NB_LSM6DSO];
+    uint32_t droppedBefore[NB_LSM6DSO];
+    uint32_t nbErrors = 0;
+
+    mockResetPeripherals();
+    initialiseMicroseconds();
+    WRITE_REG(SPI1->CR1, LL_SPI_BAUDRATEPRESCALER_DIV8);
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        SET_BIT(models[device].csPort->ODR, mockGpioPinMask(models[device].csPin));
+        resetModel(&models[device]);
+    }
+    check(!isError(lsm6dsoInitialise(SPI1, DMA1, LL_DMA_CHANNEL_2, LL_DMA_CHANNEL_3)), "initialisation");
+
+    //run the main loop until both devices process samples
+    uint8_t measuring = 0;
+    while(!measuring && (simCycles < (uint64_t)BRING_UP_TIMEOUT_MS * CYCLES_PER_MS)) {
+        nbErrors += isError(lsm6dsoUpdate());
+        advanceTime((uint64_t)LOOP_US * CYCLES_PER_US);
+
+        measuring = 1;
+        for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+            measuring &= (lsm6dsoGetTelemetry(device)->samplesProcessed > 0);
+        }
+    }
+    check(measuring, "both devices measuring");
+    check(!nbErrors, "no error while bringing the devices up");
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        check(lsm6dsoGetSelfTestResult(device) == (uint8_t)SELFTEST_PASSED, "self-test passed");
+        samplesBefore[device]  = lsm6dsoGetTelemetry(device)->samplesProcessed;
+        producedBefore[device] = models[device].accelerometerSamples;
+        droppedBefore[device]  = models[device].accelerometerDropped + models[device].gyroscopeDropped;
+    }
+
+    //run both devices at 416Hz, the main loop rendering a frame from time to time
+    const uint64_t windowEnd = simCycles + ((uint64_t)WINDOW_MS * CYCLES_PER_MS);
+    uint64_t       nextFrame = simCycles;
+    while(simCycles < windowEnd) {
+        nbErrors += isError(lsm6dsoUpdate());
+        advanceTime((uint64_t)LOOP_US * CYCLES_PER_US);
+
+        if(simCycles >= nextFrame) {
+            advanceTime((uint64_t)FRAME_US * CYCLES_PER_US);
+            nextFrame += (uint64_t)FRAME_PERIOD_MS * CYCLES_PER_MS;
+        }
+    }
+    check(!nbErrors, "no error while measuring");
+
+    //every sample produced must have been read and processed
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        const deviceModel_t* model     = &models[device];
+        const uint32_t       processed = lsm6dsoGetTelemetry(device)->samplesProcessed - samplesBefore[device];
+        const uint32_t       produced  = model->accelerometerSamples - producedBefore[device];
+        const uint32_t       dropped   = model->accelerometerDropped + model->gyroscopeDropped - droppedBefore[device];
+        const uint32_t       expected  = (uint32_t)MEASUREMENT_ODR_HZ * WINDOW_MS / 1000U;
+        const uint32_t       error     = (processed > expected ? processed - expected : expected - processed);
+
+        printf("device %u : %u samples produced, %u processed, %u dropped\n", device, produced, processed, dropped);
+        check(!dropped, "no sample dropped");
+        check((processed + 1U) >= produced, "all samples processed");
+        check((error * 1000U) <= (expected * MAX_RATE_ERROR_PERMIL), "416Hz processed");
+    }
+
+    return (nbFailures ? 1 : 0);
+}
+
+/**
+ * @brief Record the result of a check
+ *
+ * @param condition Result of the check (0 if failed)
+ * @param message Description of the check
+ */
+static void check(uint8_t condition, const char* message) {
+    if(!condition) {
+        printf("FAILED : %s\n", message);
+        nbFailures++;
+    }
+}
+
+/**
+ * @brief Advance the simulated time, producing the samples and running the DMA
+ *
+ * @param cycles Number of CPU cycles to advance
+ */
+static void advanceTime(uint64_t cycles) {
+    const uint64_t startCycle = simCycles;
+
+    simCycles += cycles;
+    WRITE_REG(DWT->CYCCNT, (uint32_t)simCycles);
+    sysTick_ms = (systick_t)(simCycles / CYCLES_PER_MS);
+
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        produceSamples(&models[device]);
+    }
+    processDma(startCycle);
+}
+
+/**
+ * @brief Reset a device model to its power-on state
+ *
+ * @param model Device model to reset
+ */
+static void resetModel(deviceModel_t* model) {
+    for(uint16_t i = 0; i < (uint16_t)NB_REGISTERS; i++) {
+        model->registers[i] = 0;
+    }
+    model->registers[WHO_AM_I] = LSM6_WHOAMI;
+    model->registers[CTRL3_C]  = CTRL3_C_DEFAULT;
+    model->nextAccelerometer   = 0.0;
+    model->nextGyroscope       = 0.0;
+    model->nextTemperature     = 0.0;
+    updateInterrupt(model);
+}
+
+/**
+ * @brief Get the period between two samples of a sensor, from its ODR register and the device clock
+ *
+ * @param model Device model
+ * @param odrRegister Register holding the ODR of the sensor (CTRL1_XL or CTRL2_G)
+ * @return Period in CPU cycles (0 if the sensor is powered down)
+ */
+static double getSamplePeriod(const deviceModel_t* model, uint8_t odrRegister) {
+    static const double ODR_HZ[] = {0.0, 12.5, 26.0, 52.0, 104.0, 208.0, 416.0, 833.0, 1666.0, 3332.0, 6667.0};
+    const uint8_t       odr      = (uint8_t)(model->registers[odrRegister] >> ODR_SHIFT);
+
+    if(!odr || (odr >= (sizeof(ODR_HZ) / sizeof(ODR_HZ[0])))) {
+        return (0.0);
+    }
+    return ((double)CYCLES_PER_US * 1.0e6 / (ODR_HZ[odr] * model->clockRatio));
+}
+
+/**
+ * @brief Write a 16-bits output in the registers of a device model
+ *
+ * @param model Device model
+ * @param firstRegister Register holding the LSB of the output
+ * @param value Physical value to write
+ * @param sensitivity Sensitivity of the sensor (physical value per LSB)
+ */
+static void writeOutput(deviceModel_t* model, uint8_t firstRegister, double value, double sensitivity) {
+    const int16_t value_LSB = (int16_t)(value / sensitivity);
+
+    model->registers[firstRegister]      = (uint8_t)((uint16_t)value_LSB & 0xFFU);
+    model->registers[firstRegister + 1U] = (uint8_t)((uint16_t)value_LSB >> 8U);
+}
+
+/**
+ * @brief Produce the samples due on a device model
+ * @details
+ *  The device lies flat (gravity on Z, no rotation), the self-test stimulus shifting all the axis.
+ *  A sample produced while its data-ready flag is still set overwrites an unread one (dropped).
+ *
+ * @param model Device model
+ */
+static void produceSamples(deviceModel_t* model) {
+    static const double AXL_SENSITIVITY_MG[] = {0.061, 0.488, 0.122, 0.244};
+    static const double GYR_SENSITIVITY_DPS[] = {0.00875, 0.0175, 0.035, 0.070};
+    const double        now                   = (double)simCycles;
+    const double        accelerometerPeriod   = getSamplePeriod(model, CTRL1_XL);
+    const double        gyroscopePeriod       = getSamplePeriod(model, CTRL2_G);
+    uint8_t*            status                = &model->registers[STATUS_REG];
+
+    while((accelerometerPeriod > 0.0) && (model->nextAccelerometer <= now)) {
+        const uint8_t selfTest   = model->registers[CTRL5_C] & AXL_SELFTEST_MASK;
+        const double  stimulus   = (selfTest == AXL_SELFTEST_POSITIVE)   ? AXL_SELFTEST_MG
+                                 : (selfTest == AXL_SELFTEST_NEGATIVE) ? -AXL_SELFTEST_MG
+                                                                         : 0.0;
+        const double sensitivity = AXL_SENSITIVITY_MG[(model->registers[CTRL1_XL] >> FS_SHIFT) & FS_MASK];
+
+        writeOutput(model, OUTX_L_A, stimulus, sensitivity);
+        writeOutput(model, OUTY_L_A, stimulus, sensitivity);
+        writeOutput(model, OUTZ_L_A, GRAVITY_MG + stimulus, sensitivity);
+        model->accelerometerDropped += ((*status & LSM6_AXL_DATA_AVAIL) ? 1U : 0U);
+        model->accelerometerSamples++;
+        *status |= LSM6_AXL_DATA_AVAIL;
+        model->nextAccelerometer += accelerometerPeriod;
+    }
+
+    while((gyroscopePeriod > 0.0) && (model->nextGyroscope <= now)) {
+        const uint8_t selfTest   = model->registers[CTRL5_C] & GYR_SELFTEST_MASK;
+        const double  stimulus   = (selfTest == GYR_SELFTEST_POSITIVE)   ? GYR_SELFTEST_DPS
+                                 : (selfTest == GYR_SELFTEST_NEGATIVE) ? -GYR_SELFTEST_DPS
+                                                                         : 0.0;
+        const double sensitivity = (model->registers[CTRL2_G] & GYR_FS_125_DPS)
+                                     ? (GYR_SENSITIVITY_DPS[0] / 2.0)
+                                     : GYR_SENSITIVITY_DPS[(model->registers[CTRL2_G] >> FS_SHIFT) & FS_MASK];
+
+        writeOutput(model, OUTX_L_G, stimulus, sensitivity);
+        writeOutput(model, OUTY_L_G, stimulus, sensitivity);
+        writeOutput(model, OUTZ_L_G, stimulus, sensitivity);
+        model->gyroscopeDropped += ((*status & LSM6_GYR_DATA_AVAIL) ? 1U : 0U);
+        *status |= LSM6_GYR_DATA_AVAIL;
+        model->nextGyroscope += gyroscopePeriod;
+    }
+
+    if((accelerometerPeriod > 0.0) || (gyroscopePeriod > 0.0)) {
+        while(model->nextTemperature <= now) {
+            *status |= LSM6_TMP_DATA_AVAIL;
+            model->nextTemperature += (double)CYCLES_PER_US * 1.0e6 / (TEMPERATURE_ODR_HZ * model->clockRatio);
+        }
+    }
+
+    updateInterrupt(model);
+}
+
+/**
+ * @brief Update the level of the INT1 pin of a device model (data-ready latched until the outputs are read)
+ *
+ * @param model Device model
+ */
+static void updateInterrupt(const deviceModel_t* model) {
+    const uint8_t int1Control = model->registers[INT1_CTRL];
+    const uint8_t status      = model->registers[STATUS_REG];
+    uint8_t       level = ((int1Control & INT1_DRDY_XL) && (status & LSM6_AXL_DATA_AVAIL))
+                 || ((int1Control & INT1_DRDY_G) && (status & LSM6_GYR_DATA_AVAIL));
+
+    if(model->registers[CTRL3_C] & INT_ACTIVE_LOW) {
+        level = !level;
+    }
+
+    if(level) {
+        SET_BIT(model->intPort->IDR, mockGpioPinMask(model->intPin));
+    } else {
+        CLEAR_BIT(model->intPort->IDR, mockGpioPinMask(model->intPin));
+    }
+}
+
+/**
+ * @brief Read a register of a device model, clearing the data-ready flag of the outputs read
+ *
+ * @param model Device model
+ * @param address Register address
+ * @return Register value
+ */
+static uint8_t readRegister(deviceModel_t* model, uint8_t address) {
+    if(address == TIMESTAMP0) {
+        const double   deviceCycles = (double)simCycles * model->clockRatio;
+        const uint32_t timestamp    = (uint32_t)(deviceCycles / (TIMESTAMP_LSB_US * CYCLES_PER_US));
+        model->registers[TIMESTAMP0] = (uint8_t)timestamp;
+        model->registers[TIMESTAMP1] = (uint8_t)(timestamp >> 8U);
+        model->registers[TIMESTAMP2] = (uint8_t)(timestamp >> 16U);
+        model->registers[TIMESTAMP3] = (uint8_t)(timestamp >> 24U);
+    }
+
+    if((address >= OUT_TEMP_L) && (address <= OUT_TEMP_H)) {
+        model->registers[STATUS_REG] &= (uint8_t)~LSM6_TMP_DATA_AVAIL;
+    } else if((address >= OUTX_L_G) && (address <= OUTZ_H_G)) {
+        model->registers[STATUS_REG] &= (uint8_t)~LSM6_GYR_DATA_AVAIL;
+    } else if((address >= OUTX_L_A) && (address <= OUTZ_H_A)) {
+        model->registers[STATUS_REG] &= (uint8_t)~LSM6_AXL_DATA_AVAIL;
+    }
+
+    return (model->registers[address]);
+}
+
+/**
+ * @brief Write a register of a device model
+ * @note The software reset restores all the registers (and self-clears), and a new ODR restarts the sampling
+ *
+ * @param model Device model
+ * @param address Register address
+ * @param value Value written
+ */
+static void writeRegister(deviceModel_t* model, uint8_t address, uint8_t value) {
+    if((address == WHO_AM_I) || ((address >= ALL_INT_SRC) && (address <= TIMESTAMP3))) {
+        return;
+    }
+
+    if((address == CTRL3_C) && (value & LSM6_SOFTWARE_RESET)) {
+        resetModel(model);
+        return;
+    }
+
+    model->registers[address] = value;
+    if(address == CTRL1_XL) {
+        model->nextAccelerometer = (double)simCycles + getSamplePeriod(model, CTRL1_XL);
+    } else if(address == CTRL2_G) {
+        model->nextGyroscope = (double)simCycles + getSamplePeriod(model, CTRL2_G);
+    }
+}
+
+/**
+ * @brief Exchange a byte with a device model (address byte first, then data bytes with auto-increment)
+ *
+ * @param model Device model selected (NULL if none)
+ * @param txData Byte sent by the MCU
+ * @return Byte received by the MCU
+ */
+static uint8_t exchangeByte(deviceModel_t* model, uint8_t txData) {
+    uint8_t rxData = 0;
+
+    if(!model) {
+        return (SPI_IDLE_LEVEL);
+    }
+
+    if(!model->addressed) {
+        model->addressed = 1;
+        model->reading   = ((txData & LSM6_READ) != 0U);
+        model->address   = txData & (uint8_t)~LSM6_READ;
+        return (0);
+    }
+
+    if(model->reading) {
+        rxData = readRegister(model, model->address);
+    } else {
+        writeRegister(model, model->address, txData);
+    }
+
+    if(model->registers[CTRL3_C] & LSM6_AUTO_INCREMENT) {
+        model->address = (model->address + 1U) & (NB_REGISTERS - 1U);
+    }
+    updateInterrupt(model);
+    return (rxData);
+}
+
+/**
+ * @brief Get the number of CPU cycles needed to clock a byte at the current SPI speed
+ *
+ * @return Number of CPU cycles (APB2 clocked as the CPU)
+ */
+static uint32_t getByteCycles(void) {
+    const uint32_t prescaler = (READ_REG(SPI1->CR1) & SPI_CR1_BR) >> SPI_CR1_BR_Pos;
+    return (8U << (prescaler + 1U));
+}
+
+/**
+ * @brief Run the DMA burst : clock all the bytes once both channels are enabled, and flag the completion
+ * @note The interrupt flags cleared by the module through IFCR are applied first
+ *
+ * @param enableCycle CPU cycle at which channels enabled since the previous call started (start of the time step)
+ */
+static void processDma(uint64_t enableCycle) {
+    DMA_Channel_TypeDef* rxChannel = DMA1_Channel2;
+    DMA_Channel_TypeDef* txChannel = DMA1_Channel3;
+
+    mockDmaLatchFlags();
+
+    if(!READ_BIT(rxChannel->CCR, DMA_CCR_EN)) {
+        dmaBusy = 0;
+        return;
+    }
+
+    if(!dmaBusy && rxChannel->CNDTR && READ_BIT(txChannel->CCR, DMA_CCR_EN)
+       && READ_BIT(SPI1->CR2, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN)) {
+        uint8_t*       buffer = (uint8_t*)(uintptr_t)rxChannel->CMAR;
+        const uint8_t* filler = (const uint8_t*)(uintptr_t)txChannel->CMAR;
+
+        for(uint32_t i = 0; i < rxChannel->CNDTR; i++) {
+            buffer[i] = exchangeByte(selected, *filler);
+        }
+
+        dmaDoneCycle = enableCycle + ((uint64_t)rxChannel->CNDTR * getByteCycles());
+        dmaBusy      = 1;
+        WRITE_REG(rxChannel->CNDTR, 0);
+        WRITE_REG(txChannel->CNDTR, 0);
+    }
+
+    if(dmaBusy && (simCycles >= dmaDoneCycle)) {
+        dmaBusy = 0;
+        SET_BIT(DMA1->ISR, DMA_ISR_GIF2 | DMA_ISR_TCIF2 | DMA_ISR_HTIF2 | DMA_ISR_GIF3 | DMA_ISR_TCIF3 | DMA_ISR_HTIF3);
+    }
+}
+
+/**
+ * @brief Select the device model of which the chip select is low when the SPI gets enabled
+ *
+ * @param SPIx SPI enabled
+ */
+void mockSpiEnabled(SPI_TypeDef* SPIx) {
+    (void)SPIx;
+    mockGpioLatch(GPIOA);
+    mockGpioLatch(GPIOB);
+
+    selected = (void*)0;
+    for(uint8_t device = 0; device < (uint8_t)NB_LSM6DSO; device++) {
+        if(!READ_BIT(models[device].csPort->ODR, mockGpioPinMask(models[device].csPin))) {
+            check(!selected, "a single device selected");
+            selected            = &models[device];
+            selected->addressed = 0;
+        }
+    }
+}
+
+/**
+ * @brief Deselect the device model when the SPI gets disabled
+ *
+ * @param SPIx SPI disabled
+ */
+void mockSpiDisabled(SPI_TypeDef* SPIx) {
+    (void)SPIx;
+    selected = (void*)0;
+}
+
+/**
+ * @brief Exchange a byte by polling with the device model selected, the CPU waiting for the transfer
+ *
+ * @param SPIx SPI used
+ * @param TxData Byte sent
+ * @return Byte received
+ */
+uint8_t mockSpiExchange(SPI_TypeDef* SPIx, uint8_t TxData) {
+    (void)SPIx;
+    const uint8_t rxData = exchangeByte(selected, TxData);
+    advanceTime(getByteCycles() + SPI_BYTE_OVERHEAD);
+    return (rxData);
+}
@@ -0,0 +1,173 @@
+/**
+ * @file mockperipherals.c
+ * @brief Implement the host versions of the STM32F103 peripherals used by the host tests
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The real CMSIS and LL headers are used, but the peripherals pointers are redirected to structures in RAM
+ *  (see mockperipherals.h), which the tests read and write to emulate the hardware around the modules tested.
+ *  The tests are linked without position independent code, so that the 32-bits addresses
+ *  written by the modules in the DMA registers are still valid pointers on a 64-bits host.
+ *  The storage region (_sstorage and _estorage in the linker script) is defined by the tests CMakeLists.txt.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "stm32f103xb.h"
+
+enum {
+    MOCK_CORE_CLOCK_HZ  = 72000000U,  ///< System clock frequency configured by main.c
+    MOCK_ERASED_BYTE    = 0xFFU,      ///< Value of an erased flash byte
+    MOCK_GPIO_PINS_MASK = 0xFFFFU,    ///< Mask of the 16 pins of a port in the GPIO data registers
+    MOCK_DMA_CHANNELS   = 7U,         ///< Number of DMA1 channels
+    MOCK_DMA_FLAGS_MASK = 0x0FU,      ///< Mask of all the flags of DMA channel 1 (GIF, TCIF, HTIF and TEIF)
+    MOCK_DMA_FLAGS_BITS = 4U,         ///< Number of flags bits per DMA channel
+};
+
+uint32_t      SystemCoreClock   = MOCK_CORE_CLOCK_HZ;                                ///< System clock frequency
+const uint8_t AHBPrescTable[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};  ///< AHB prescalers shifts
+const uint8_t APBPrescTable[8]  = {0, 0, 0, 0, 1, 2, 3, 4};                          ///< APB prescalers shifts
+
+GPIO_TypeDef   mockGPIOA;                                                                ///< GPIO A registers
+GPIO_TypeDef   mockGPIOB;                                                                ///< GPIO B registers
+GPIO_TypeDef   mockGPIOC;                                                                ///< GPIO C registers
+SPI_TypeDef    mockSPI1;                                                                 ///< SPI 1 registers
+SPI_TypeDef    mockSPI2;                                                                 ///< SPI 2 registers
+uint32_t       mockDMA1[MOCK_DMA_REGISTERS_SIZE / sizeof(uint32_t)];                    ///< DMA 1 registers
+RCC_TypeDef    mockRCC;                                                                  ///< RCC registers
+PWR_TypeDef    mockPWR;                                                                  ///< PWR registers
+BKP_TypeDef    mockBKP;                                                                  ///< Backup registers
+AFIO_TypeDef   mockAFIO;                                                                 ///< AFIO registers
+EXTI_TypeDef   mockEXTI;                                                                 ///< EXTI registers
+FLASH_TypeDef  mockFLASH;                                                                ///< Flash registers
+IWDG_TypeDef   mockIWDG;                                                                 ///< Watchdog registers
+DWT_Type       mockDWT;                                                                  ///< DWT registers
+CoreDebug_Type mockCoreDebug;                                                            ///< Core debug registers
+ITM_Type       mockITM;                                                                  ///< ITM registers
+uint8_t        mockStorage[MOCK_STORAGE_SIZE] __attribute__((aligned(4)));  ///< Storage flash pages
+
+void (*mockFlashAccessHook)(void) = (void*)0;  ///< Hook called before each access to the flash registers
+uint32_t mockPrimask              = 0;         ///< Interrupts masked by PRIMASK
+uint64_t mockIrqEnabled           = 0;         ///< Interrupts enabled in the NVIC (one bit per IRQ number)
+uint32_t mockSystemResets         = 0;         ///< Number of system resets requested
+
+/**
+ * @brief Reset all the peripherals registers and the storage to their reset values
+ */
+void mockResetPeripherals(void) {
+    memset(&mockGPIOA, 0, sizeof(mockGPIOA));
+    memset(&mockGPIOB, 0, sizeof(mockGPIOB));
+    memset(&mockGPIOC, 0, sizeof(mockGPIOC));
+    memset(&mockSPI1, 0, sizeof(mockSPI1));
+    memset(&mockSPI2, 0, sizeof(mockSPI2));
+    memset(mockDMA1, 0, sizeof(mockDMA1));
+    memset(&mockRCC, 0, sizeof(mockRCC));
+    memset(&mockPWR, 0, sizeof(mockPWR));
+    memset(&mockBKP, 0, sizeof(mockBKP));
+    memset(&mockAFIO, 0, sizeof(mockAFIO));
+    memset(&mockEXTI, 0, sizeof(mockEXTI));
+    memset(&mockFLASH, 0, sizeof(mockFLASH));
+    memset(&mockIWDG, 0, sizeof(mockIWDG));
+    memset(&mockDWT, 0, sizeof(mockDWT));
+    memset(&mockCoreDebug, 0, sizeof(mockCoreDebug));
+    memset(&mockITM, 0, sizeof(mockITM));
+    memset(mockStorage, MOCK_ERASED_BYTE, sizeof(mockStorage));
+
+    mockSPI1.SR         = SPI_SR_TXE;
+    mockSPI2.SR         = SPI_SR_TXE;
+    mockFLASH.CR        = FLASH_CR_LOCK;
+    mockFlashAccessHook = (void*)0;
+    mockPrimask         = 0;
+    mockIrqEnabled      = 0;
+    mockSystemResets    = 0;
+}
+
+/**
+ * @brief Apply the set/reset registers written since the last call to the output data register of a port
+ * @note The set requests are applied first, the latest request on a pin being its reset when both are pending
+ *
+ * @param port GPIO port to update
+ */
+void mockGpioLatch(GPIO_TypeDef* port) {
+    port->ODR |= (port->BSRR & MOCK_GPIO_PINS_MASK);
+    port->ODR &= ~((port->BSRR >> GPIO_BSRR_BR0_Pos) | port->BRR);
+    port->BSRR = 0;
+    port->BRR  = 0;
+}
+
+/**
+ * @brief Apply the flags clear requests written in the DMA1 IFCR since the last call to its ISR
+ * @note Clearing the global flag of a channel clears all its flags
+ */
+void mockDmaLatchFlags(void) {
+    uint32_t cleared = DMA1->IFCR;
+
+    for(uint8_t channel = 0; channel < (uint8_t)MOCK_DMA_CHANNELS; channel++) {
+        const uint8_t shift = (uint8_t)(channel * MOCK_DMA_FLAGS_BITS);
+        if(cleared & (DMA_IFCR_CGIF1 << shift)) {
+            cleared |= (MOCK_DMA_FLAGS_MASK << shift);
+        }
+    }
+
+    DMA1->ISR &= ~cleared;
+    DMA1->IFCR = 0;
+}
+
+/**
+ * @brief Get the mask of a pin in the GPIO data registers
+ *
+ * @param pin Pin in the LL format (LL_GPIO_PIN_x)
+ * @return Mask of the pin in the IDR/ODR registers
+ */
+uint32_t mockGpioPinMask(uint32_t pin) {
+    return ((pin >> MOCK_GPIO_PIN_SHIFT) & MOCK_GPIO_PINS_MASK);
+}
+
+/**
+ * @brief Get the flash registers, after calling the access hook if any
+ *
+ * @return Flash registers
+ */
+FLASH_TypeDef* mockFlashAccess(void) {
+    if(mockFlashAccessHook) {
+        mockFlashAccessHook();
+    }
+    return (&mockFLASH);
+}
+
+void __enable_irq(void) {
+    mockPrimask = 0;
+}
+
+void __disable_irq(void) {
+    mockPrimask = 1;
+}
+
+uint32_t __get_PRIMASK(void) {
+    return (mockPrimask);
+}
+
+void __set_PRIMASK(uint32_t priMask) {
+    mockPrimask = priMask;
+}
+
+void mockNvicEnableIRQ(IRQn_Type IRQn) {
+    mockIrqEnabled |= (1ULL << (uint32_t)IRQn);
+}
+
+void mockNvicDisableIRQ(IRQn_Type IRQn) {
+    mockIrqEnabled &= ~(1ULL << (uint32_t)IRQn);
+}
+
+void mockNvicSetPriority(IRQn_Type IRQn, uint32_t priority) {
+    (void)IRQn;
+    (void)priority;
+}
+
+uint32_t mockNvicGetPriorityGrouping(void) {
+    return (0);
+}
+
+void mockNvicSystemReset(void) {
+    mockSystemResets++;
+}
@@ -0,0 +1,11 @@
+#ifndef MOCKINTRINSICS_H_INCLUDED
+#define MOCKINTRINSICS_H_INCLUDED
+
+//rename the Cortex-M intrinsics while the CMSIS headers define them (their assembly does not exist on the host),
+//	mockperipherals.h then declares host versions under the original names
+#define __enable_irq  cmsisEnableIrq
+#define __disable_irq cmsisDisableIrq
+#define __get_PRIMASK cmsisGetPrimask
+#define __set_PRIMASK cmsisSetPrimask
+
+#endif
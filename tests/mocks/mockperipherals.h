@@ -0,0 +1,119 @@
+#ifndef MOCKPERIPHERALS_H_INCLUDED
+#define MOCKPERIPHERALS_H_INCLUDED
+#include <stdint.h>
+
+//only included by the device header wrappers (stm32f1xx.h and stm32f103xb.h), once the real headers are parsed
+
+enum {
+    MOCK_DMA_REGISTERS_SIZE = 0xA0U,  ///< Size of the DMA1 registers block, channels included (see reference manual)
+    MOCK_GPIO_PIN_SHIFT     = 8U,     ///< Shift of the pin mask in the LL_GPIO_PIN_x values
+    MOCK_STORAGE_SIZE       = 2048U,  ///< Size of the flash storage region (see the linker script)
+};
+
+//host versions of the Cortex-M intrinsics renamed by mockintrinsics.h
+#undef __enable_irq
+#undef __disable_irq
+#undef __get_PRIMASK
+#undef __set_PRIMASK
+void     __enable_irq(void);
+void     __disable_irq(void);
+uint32_t __get_PRIMASK(void);
+void     __set_PRIMASK(uint32_t priMask);
+
+//NVIC functions recorded instead of accessing the core registers
+#undef NVIC_EnableIRQ
+#undef NVIC_DisableIRQ
+#undef NVIC_SetPriority
+#undef NVIC_GetPriorityGrouping
+#undef NVIC_SystemReset
+#define NVIC_EnableIRQ           mockNvicEnableIRQ
+#define NVIC_DisableIRQ          mockNvicDisableIRQ
+#define NVIC_SetPriority         mockNvicSetPriority
+#define NVIC_GetPriorityGrouping mockNvicGetPriorityGrouping
+#define NVIC_SystemReset         mockNvicSystemReset
+void     mockNvicEnableIRQ(IRQn_Type IRQn);
+void     mockNvicDisableIRQ(IRQn_Type IRQn);
+void     mockNvicSetPriority(IRQn_Type IRQn, uint32_t priority);
+uint32_t mockNvicGetPriorityGrouping(void);
+void     mockNvicSystemReset(void);
+
+//peripherals registers, mapped in RAM
+extern GPIO_TypeDef   mockGPIOA;
+extern GPIO_TypeDef   mockGPIOB;
+extern GPIO_TypeDef   mockGPIOC;
+extern SPI_TypeDef    mockSPI1;
+extern SPI_TypeDef    mockSPI2;
+extern uint32_t       mockDMA1[MOCK_DMA_REGISTERS_SIZE / sizeof(uint32_t)];
+extern RCC_TypeDef    mockRCC;
+extern PWR_TypeDef    mockPWR;
+extern BKP_TypeDef    mockBKP;
+extern AFIO_TypeDef   mockAFIO;
+extern EXTI_TypeDef   mockEXTI;
+extern FLASH_TypeDef  mockFLASH;
+extern IWDG_TypeDef   mockIWDG;
+extern DWT_Type       mockDWT;
+extern CoreDebug_Type mockCoreDebug;
+extern ITM_Type       mockITM;
+extern uint8_t        mockStorage[MOCK_STORAGE_SIZE];
+
+//hook called before each access to the flash registers (e.g. to inject an interrupt), NULL if none
+extern void (*mockFlashAccessHook)(void);
+FLASH_TypeDef* mockFlashAccess(void);
+
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef SPI1
+#undef SPI2
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef RCC
+#undef PWR
+#undef BKP
+#undef AFIO
+#undef EXTI
+#undef FLASH
+#undef IWDG
+#undef DWT
+#undef CoreDebug
+#undef ITM
+#define GPIOA         (&mockGPIOA)
+#define GPIOB         (&mockGPIOB)
+#define GPIOC         (&mockGPIOC)
+#define SPI1          (&mockSPI1)
+#define SPI2          (&mockSPI2)
+#define DMA1          ((DMA_TypeDef*)mockDMA1)
+#define DMA1_Channel1 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel1_BASE - DMA1_BASE)))
+#define DMA1_Channel2 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel2_BASE - DMA1_BASE)))
+#define DMA1_Channel3 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel3_BASE - DMA1_BASE)))
+#define DMA1_Channel4 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel4_BASE - DMA1_BASE)))
+#define DMA1_Channel5 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel5_BASE - DMA1_BASE)))
+#define DMA1_Channel6 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel6_BASE - DMA1_BASE)))
+#define DMA1_Channel7 ((DMA_Channel_TypeDef*)((uint8_t*)mockDMA1 + (DMA1_Channel7_BASE - DMA1_BASE)))
+#define RCC           (&mockRCC)
+#define PWR           (&mockPWR)
+#define BKP           (&mockBKP)
+#define AFIO          (&mockAFIO)
+#define EXTI          (&mockEXTI)
+#define FLASH         (mockFlashAccess())
+#define IWDG          (&mockIWDG)
+#define DWT           (&mockDWT)
+#define CoreDebug     (&mockCoreDebug)
+#define ITM           (&mockITM)
+
+extern uint32_t mockPrimask;
+extern uint64_t mockIrqEnabled;
+extern uint32_t mockSystemResets;
+
+void     mockResetPeripherals(void);
+void     mockGpioLatch(GPIO_TypeDef* port);
+uint32_t mockGpioPinMask(uint32_t pin);
+void     mockDmaLatchFlags(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef MOCK_STM32F103XB_H_INCLUDED
+#define MOCK_STM32F103XB_H_INCLUDED
+#include "mockintrinsics.h"
+#include_next "stm32f103xb.h"
+#include "mockperipherals.h"
+#endif
@@ -0,0 +1,6 @@
+#ifndef MOCK_STM32F1XX_H_INCLUDED
+#define MOCK_STM32F1XX_H_INCLUDED
+#include "mockintrinsics.h"
+#include_next "stm32f1xx.h"
+#include "mockperipherals.h"
+#endif
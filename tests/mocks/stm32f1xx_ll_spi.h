@@ -0,0 +1,40 @@
+#ifndef MOCK_STM32F1XX_LL_SPI_H_INCLUDED
+#define MOCK_STM32F1XX_LL_SPI_H_INCLUDED
+
+//rename the LL functions which move data or (de)select the device, to replace them with the host versions below
+#define LL_SPI_Enable        cmsisLL_SPI_Enable
+#define LL_SPI_Disable       cmsisLL_SPI_Disable
+#define LL_SPI_TransmitData8 cmsisLL_SPI_TransmitData8
+#define LL_SPI_ReceiveData8  cmsisLL_SPI_ReceiveData8
+#include_next "stm32f1xx_ll_spi.h"
+#undef LL_SPI_Enable
+#undef LL_SPI_Disable
+#undef LL_SPI_TransmitData8
+#undef LL_SPI_ReceiveData8
+
+//hooks implemented by the test driving the SPI (device models)
+void    mockSpiEnabled(SPI_TypeDef* SPIx);
+void    mockSpiDisabled(SPI_TypeDef* SPIx);
+uint8_t mockSpiExchange(SPI_TypeDef* SPIx, uint8_t TxData);
+
+static inline void LL_SPI_Enable(SPI_TypeDef* SPIx) {
+    SET_BIT(SPIx->CR1, SPI_CR1_SPE);
+    mockSpiEnabled(SPIx);
+}
+
+static inline void LL_SPI_Disable(SPI_TypeDef* SPIx) {
+    CLEAR_BIT(SPIx->CR1, SPI_CR1_SPE);
+    mockSpiDisabled(SPIx);
+}
+
+static inline void LL_SPI_TransmitData8(SPI_TypeDef* SPIx, uint8_t TxData) {
+    WRITE_REG(SPIx->DR, mockSpiExchange(SPIx, TxData));
+    SET_BIT(SPIx->SR, SPI_SR_RXNE | SPI_SR_TXE);
+}
+
+static inline uint8_t LL_SPI_ReceiveData8(SPI_TypeDef* SPIx) {
+    CLEAR_BIT(SPIx->SR, SPI_SR_RXNE);
+    return ((uint8_t)READ_REG(SPIx->DR));
+}
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * @file storageBrownoutTest.c
+ * @brief Host test of a brown-out interrupting the flash operations of the main loop
+ * @author Gilles Henrard
+ * @date 18/10/2026
+ *
+ * @details
+ *  The main loop erases the mounting page and writes a record in it (as mountingCalibrate() does),
+ *  while the PVD interrupt pre-empts it to write the power-fail record.
+ *  The interrupt is injected before the k-th access to the flash registers, for every k of the main loop operations
+ *  (unless the interrupts are masked, in which case it fires at the first access once they are unmasked).
+ *
+ *  A flash controller model checks each access, as the hardware would :
+ *      - the key sequence must be KEY1 then KEY2, any other value locking the controller until reset
+ *      - a half-word may only be programmed with PG set and the controller unlocked, in an erased location
+ *      - a page may only be erased with PER set and the controller unlocked
+ *  Any other access is counted as a fault, and the half-words wrongly programmed are reverted.
+ *  Both records must be intact once the main loop operations are done, and the controller locked.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "powerfail.h"
+#include "stm32f103xb.h"
+#include "storage.h"
+#include "systick.h"
+
+enum {
+    MAIN_RECORD_SIZE = 64U,     ///< Number of bytes of the record written by the main loop
+    ERASED_HALFWORD  = 0xFFFFU, ///< Value of an erased half-word
+    OLD_DATA         = 0x5AU,   ///< Byte held by the mounting page before being erased
+    MAX_ACCESSES     = 10000U,  ///< Maximum number of flash registers accesses expected from the main loop
+};
+
+static void    flashModel(void);
+static void    checkProgramming(void);
+static void    checkErase(void);
+static uint8_t runMainLoopOperations(uint32_t injection);
+static void    check(uint8_t condition, const char* message);
+
+static uint8_t          shadow[MOCK_STORAGE_SIZE];          ///< Flash content as programmed by valid operations
+static uint8_t          mainRecord[MAIN_RECORD_SIZE];       ///< Record written by the main loop
+static powerfailState_t savedState;                         ///< State written by the power-fail interrupt
+static uint8_t          keyStep       = 0;                  ///< Number of valid unlock keys written in a row
+static uint8_t          keyLockout    = 0;                  ///< Flag indicating a wrong key sequence locked the flash
+static uint32_t         nbFaults      = 0;                  ///< Number of invalid flash accesses
+static uint32_t         nbAccesses    = 0;                  ///< Number of flash registers accesses
+static uint32_t         injectionStep = 0;                  ///< Access before which inject the interrupt (0 : never)
+static uint8_t          interrupted   = 0;                  ///< Flag indicating the interrupt has been injected
+static uint8_t          inModel       = 0;                  ///< Flag indicating the model is running (no re-entry)
+static uint32_t         nbFailures    = 0;                  ///< Number of checks failed
+
+/**
+ * @brief Run the main loop operations with the interrupt injected at each flash registers access
+ *
+ * @return 0 if all the checks passed, 1 otherwise
+ */
+int main(void) {
+    for(uint8_t i = 0; i < (uint8_t)MAIN_RECORD_SIZE; i++) {
+        mainRecord[i] = (uint8_t)(i * 3U);
+    }
+    savedState = (powerfailState_t){
+        .zeroing_rad = {0.125F, -0.25F},
+        .lastError   = 0x12345678U,
+        .relative    = 1,
+    };
+
+    //count the flash registers accesses of the main loop operations, without interrupt
+    check(runMainLoopOperations(0), "main loop operations without interrupt");
+    const uint32_t nbSteps = nbAccesses;
+    check((nbSteps > 0) && (nbSteps < (uint32_t)MAX_ACCESSES), "flash registers accessed");
+
+    //inject the interrupt before each access
+    uint32_t nbInjected = 0;
+    for(uint32_t step = 1; step <= nbSteps; step++) {
+        const uint32_t failuresBefore = nbFailures;
+
+        check(runMainLoopOperations(step), "main loop operations");
+        check(interrupted, "interrupt injected");
+        nbInjected += interrupted;
+
+        if(nbFailures != failuresBefore) {
+            printf("  with the interrupt injected before access %u/%u\n", step, nbSteps);
+        }
+    }
+
+    printf("storage : interrupt injected at %u accesses, %u checks failed\n", nbInjected, nbFailures);
+    return (nbFailures ? 1 : 0);
+}
+
+/**
+ * @brief Record the result of a check
+ *
+ * @param condition Result of the check (0 if failed)
+ * @param message Description of the check
+ */
+static void check(uint8_t condition, const char* message) {
+    if(!condition) {
+        printf("FAILED : %s\n", message);
+        nbFailures++;
+    }
+}
+
+/**
+ * @brief Boot, then erase the mounting page and write the main loop record in it
+ *
+ * @param injection Access before which inject the PVD interrupt (0 : never)
+ * @retval 0 At least one check failed
+ * @retval 1 All the checks passed
+ */
+static uint8_t runMainLoopOperations(uint32_t injection) {
+    const uint32_t   failuresBefore = nbFailures;
+    const uint8_t*   mountingPage   = storageGetPage(STORAGE_MOUNTING);
+    powerfailState_t restored;
+
+    //boot with a blank power-fail page and an old mounting record
+    mockResetPeripherals();
+    initialiseMicroseconds();
+    memset(&mockStorage[STORAGE_MOUNTING * STORAGE_PAGE_SIZE], OLD_DATA, STORAGE_PAGE_SIZE);
+    memcpy(shadow, mockStorage, sizeof(shadow));
+    keyStep             = 0;
+    keyLockout          = 0;
+    nbFaults            = 0;
+    nbAccesses          = 0;
+    injectionStep       = 0;
+    interrupted         = 0;
+    mockFlashAccessHook = flashModel;
+
+    check(!isError(powerfailInitialise(DMA1, &restored)), "power-fail initialisation");
+    powerfailSetState(&savedState);
+
+    //run the main loop operations, the interrupt being injected during them (or right after if masked until the end)
+    nbAccesses    = 0;
+    injectionStep = injection;
+    check(!isError(storageErasePage(STORAGE_MOUNTING)), "main loop erase");
+    check(!isError(storageWrite(STORAGE_MOUNTING, 0, mainRecord, MAIN_RECORD_SIZE)), "main loop write");
+    flashModel();
+    injectionStep = 0;
+
+    //check the flash controller state and both records
+    check(!nbFaults, "no invalid flash access");
+    check(!keyLockout, "no wrong key sequence");
+    check(READ_BIT(mockFLASH.CR, FLASH_CR_LOCK | FLASH_CR_PG | FLASH_CR_PER) == FLASH_CR_LOCK, "flash locked");
+    check(!memcmp(mountingPage, mainRecord, MAIN_RECORD_SIZE), "main loop record written");
+    uint8_t erased = 1;
+    for(uint16_t i = MAIN_RECORD_SIZE; i < (uint16_t)STORAGE_PAGE_SIZE; i++) {
+        erased &= (mountingPage[i] == (uint8_t)ERASED_HALFWORD);
+    }
+    check(erased, "rest of the mounting page erased");
+
+    if(interrupted) {
+        check(!isError(powerfailInitialise(DMA1, &restored)), "power-fail record restored");
+        check(!memcmp(&restored, &savedState, sizeof(restored)), "power-fail state restored");
+    }
+
+    mockFlashAccessHook = (void*)0;
+    return (nbFailures == failuresBefore);
+}
+
+/**
+ * @brief Flash controller model, run before each access to the flash registers
+ * @details
+ *  The accesses made since the previous call (keys, half-words, erase start) are checked,
+ *  then the PVD interrupt is injected if due and the interrupts are not masked.
+ */
+static void flashModel(void) {
+    if(inModel) {
+        return;
+    }
+    inModel = 1;
+
+    //apply the key written since the previous access
+    if(mockFLASH.KEYR) {
+        if((keyStep == 0U) && (mockFLASH.KEYR == FLASH_KEY1)) {
+            keyStep = 1;
+        } else if((keyStep == 1U) && (mockFLASH.KEYR == FLASH_KEY2)) {
+            keyStep = 0;
+            if(!keyLockout) {
+                CLEAR_BIT(mockFLASH.CR, FLASH_CR_LOCK);
+            }
+        } else {
+            keyStep    = 0;
+            keyLockout = 1;
+        }
+        mockFLASH.KEYR = 0;
+    }
+    if(keyLockout) {
+        SET_BIT(mockFLASH.CR, FLASH_CR_LOCK);
+    }
+
+    checkProgramming();
+    checkErase();
+    mockFLASH.SR = 0;
+    nbAccesses++;
+    inModel = 0;
+
+    //inject the PVD interrupt if due, enabled and not masked
+    if(injectionStep && !interrupted && (nbAccesses >= injectionStep) && !mockPrimask
+       && (mockIrqEnabled & (1ULL << PVD_IRQn))) {
+        interrupted = 1;
+        powerfailIRQhandler();
+    }
+}
+
+/**
+ * @brief Check the half-words programmed since the previous access, and revert the invalid ones
+ */
+static void checkProgramming(void) {
+    const uint8_t canProgram = (READ_BIT(mockFLASH.CR, FLASH_CR_PG) && !READ_BIT(mockFLASH.CR, FLASH_CR_LOCK));
+
+    for(uint16_t i = 0; i < (uint16_t)MOCK_STORAGE_SIZE; i += 2U) {
+        if((mockStorage[i] == shadow[i]) && (mockStorage[i + 1U] == shadow[i + 1U])) {
+            continue;
+        }
+
+        const uint8_t wasErased = ((shadow[i] & shadow[i + 1U]) == 0xFFU);
+        if(canProgram && wasErased) {
+            shadow[i]      = mockStorage[i];
+            shadow[i + 1U] = mockStorage[i + 1U];
+        } else {
+            nbFaults++;
+            mockStorage[i]      = shadow[i];
+            mockStorage[i + 1U] = shadow[i + 1U];
+        }
+    }
+}
+
+/**
+ * @brief Erase the page requested since the previous access, if the controller allows it
+ */
+static void checkErase(void) {
+    if(!READ_BIT(mockFLASH.CR, FLASH_CR_STRT)) {
+        return;
+    }
+    CLEAR_BIT(mockFLASH.CR, FLASH_CR_STRT);
+
+    const uintptr_t start = (uintptr_t)mockStorage;
+    const uintptr_t page  = (uintptr_t)mockFLASH.AR;
+    if(!READ_BIT(mockFLASH.CR, FLASH_CR_PER) || READ_BIT(mockFLASH.CR, FLASH_CR_LOCK) || (page < start)
+       || (page >= (start + MOCK_STORAGE_SIZE))) {
+        nbFaults++;
+        return;
+    }
+
+    const uintptr_t offset = (page - start) & ~((uintptr_t)STORAGE_PAGE_SIZE - 1U);
+    memset(&mockStorage[offset], 0xFF, STORAGE_PAGE_SIZE);
+    memset(&shadow[offset], 0xFF, STORAGE_PAGE_SIZE);
+}
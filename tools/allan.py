@@ -0,0 +1,290 @@
+#!/usr/bin/env python3
+"""
+Characterise the LSM6DSO noise with the Allan deviation of a static raw trace, and generate the sensor profile.
+
+The trace holds the raw gyroscope and accelerometer values (LSB) of a device laid still, in the order of the
+output registers (OUTX_G, OUTY_G, OUTZ_G, OUTX_A, OUTY_A, OUTZ_A), either as text (6 integers per line,
+'#' for comments) or as binary records of 6 little-endian int16 (--binary).
+
+The trace is streamed : each axis is handled by its own worker process, which computes the Allan variance
+over octave-spaced cluster times with a cascade of cluster averages. The memory used does not depend on
+the trace length, so multi-hour traces can be processed.
+
+For each axis, the tool reports :
+    - the white noise coefficient (gyroscope angle random walk, accelerometer velocity random walk)
+    - the bias instability (flat bottom of the curve)
+    - the rate random walk (+1/2 slope), if the trace is long enough to show it
+
+The complementary filter time constant is chosen where the angle error of the integrated gyroscope
+meets the angle noise of the accelerometer, and written with the noise figures in LSM6DSO_profile.h.
+
+Usage :
+    allan.py static.csv                                         (report only)
+    allan.py --binary --odr 416 static.bin -o Components/sensor/LSM6DSO_profile.h
+    allan.py --csv curves.csv static.csv                        (Allan deviation curves, for plotting)
+"""
+import argparse
+import math
+import multiprocessing
+import struct
+import sys
+from array import array
+
+AXIS_NAMES = ("gyroscope X", "gyroscope Y", "gyroscope Z", "accelerometer X", "accelerometer Y", "accelerometer Z")
+NB_AXIS = 6
+GYR_RADPS_PER_LSB = 0.000076358155  # 4.375 mdps/LSB at 125 dps (same as convertGyroscope())
+AXL_MG_PER_LSB = 0.061  # 0.061 mG/LSB at 2G (same as convertAccelerometer())
+GRAVITY_MG = 1000.0
+BIAS_INSTABILITY_FACTOR = 0.664  # minimum of the Allan deviation of a flicker noise (IEEE 952)
+CHUNK_RECORDS = 16384
+QUEUE_CHUNKS = 4
+MAX_LEVELS = 40
+MIN_CLUSTERS = 3
+
+
+class AllanCascade:
+    """Non-overlapping Allan variance at cluster sizes 1, 2, 4, ... samples, computed sample by sample"""
+
+    def __init__(self):
+        self.pending = [None] * MAX_LEVELS  # first cluster of a pair waiting for its sibling
+        self.previous = [None] * MAX_LEVELS  # latest cluster average of each level
+        self.squares = [0.0] * MAX_LEVELS  # sum of the squared differences of consecutive clusters
+        self.counts = [0] * MAX_LEVELS  # number of differences summed
+
+    def add(self, value):
+        """Add a sample, and propagate the completed cluster averages up the cascade"""
+        level = 0
+        while level < MAX_LEVELS:
+            previous = self.previous[level]
+            if previous is not None:
+                difference = value - previous
+                self.squares[level] += difference * difference
+                self.counts[level] += 1
+            self.previous[level] = value
+
+            pending = self.pending[level]
+            if pending is None:
+                self.pending[level] = value
+                return
+            self.pending[level] = None
+            value = (pending + value) * 0.5
+            level += 1
+
+    def deviations(self, odr_hz, scale):
+        """Get the (cluster time [s], Allan deviation [unit], number of clusters) of each significant level"""
+        curve = []
+        for level in range(MAX_LEVELS):
+            if self.counts[level] < MIN_CLUSTERS:
+                break
+            variance = self.squares[level] / (2.0 * self.counts[level])
+            curve.append(((1 << level) / odr_hz, math.sqrt(variance) * scale, self.counts[level] + 1))
+        return curve
+
+
+def axis_worker(chunks, results, axis, odr_hz, scale):
+    """Feed the chunks of an axis to its cascade until the end marker, then send the curve back"""
+    cascade = AllanCascade()
+    add = cascade.add
+    while True:
+        chunk = chunks.get()
+        if chunk is None:
+            break
+        for value in chunk:
+            add(float(value))
+    results.put((axis, cascade.deviations(odr_hz, scale)))
+
+
+def read_records(path, binary):
+    """Stream the trace as chunks of records, each being a list of 6 arrays (one per axis)"""
+    stream = sys.stdin.buffer if path == "-" else open(path, "rb")
+    record = struct.Struct(f"<{NB_AXIS}h")
+    with stream:
+        if binary:
+            while True:
+                data = stream.read(record.size * CHUNK_RECORDS)
+                if not data:
+                    return
+                values = array("h", data[:len(data) - (len(data) % record.size)])
+                if sys.byteorder != "little":
+                    values.byteswap()
+                yield [values[axis::NB_AXIS] for axis in range(NB_AXIS)]
+
+        columns = [array("h") for _ in range(NB_AXIS)]
+        for number, line in enumerate(stream, 1):
+            line = line.split(b"#", 1)[0].replace(b",", b" ").split()
+            if not line:
+                continue
+            if len(line) < NB_AXIS:
+                sys.exit(f"{path}:{number} : {NB_AXIS} values expected")
+            for axis in range(NB_AXIS):
+                columns[axis].append(int(line[axis]))
+            if len(columns[0]) >= CHUNK_RECORDS:
+                yield columns
+                columns = [array("h") for _ in range(NB_AXIS)]
+        if len(columns[0]):
+            yield columns
+
+
+def compute_curves(path, binary, odr_hz):
+    """Compute the Allan deviation curves of all the axis in parallel (one worker process per axis)"""
+    results = multiprocessing.Queue()
+    queues = [multiprocessing.Queue(QUEUE_CHUNKS) for _ in range(NB_AXIS)]
+    workers = []
+    for axis in range(NB_AXIS):
+        scale = GYR_RADPS_PER_LSB if axis < 3 else AXL_MG_PER_LSB
+        worker = multiprocessing.Process(target=axis_worker, args=(queues[axis], results, axis, odr_hz, scale),
+                                         daemon=True)
+        worker.start()
+        workers.append(worker)
+
+    nb_records = 0
+    for columns in read_records(path, binary):
+        nb_records += len(columns[0])
+        for axis in range(NB_AXIS):
+            queues[axis].put(columns[axis])
+    for axis in range(NB_AXIS):
+        queues[axis].put(None)
+
+    curves = [None] * NB_AXIS
+    for _ in range(NB_AXIS):
+        axis, curve = results.get()
+        curves[axis] = curve
+    for worker in workers:
+        worker.join()
+    return nb_records, curves
+
+
+def log_slope(first, second):
+    """Get the slope between two points of a curve in a log-log scale"""
+    return math.log(second[1] / first[1]) / math.log(second[0] / first[0])
+
+
+def noise_terms(curve):
+    """Get the white noise, bias instability and rate random walk coefficients of an Allan deviation curve"""
+    if len(curve) < 2:
+        return None
+    bottom = min(range(len(curve)), key=lambda index: curve[index][1])
+    slopes = [log_slope(curve[index], curve[index + 1]) for index in range(len(curve) - 1)]
+
+    #white noise : point of the descending part closest to the -1/2 slope, extrapolated at 1s
+    descending = range(max(bottom, 1))
+    white = min(descending, key=lambda index: abs(slopes[index] + 0.5))
+    white_noise = curve[white][1] * math.sqrt(curve[white][0])
+
+    #rate random walk : point of the ascending part closest to the +1/2 slope (if any), extrapolated at 3s
+    random_walk = None
+    ascending = [index for index in range(bottom, len(slopes)) if slopes[index] > 0.25]
+    if ascending:
+        index = min(ascending, key=lambda index: abs(slopes[index] - 0.5))
+        random_walk = curve[index + 1][1] * math.sqrt(3.0 / curve[index + 1][0])
+
+    return {
+        "white": white_noise,
+        "bias": curve[bottom][1] / BIAS_INSTABILITY_FACTOR,
+        "bias_tau": curve[bottom][0],
+        "random_walk": random_walk,
+    }
+
+
+def filter_time_constant(curves):
+    """
+    Get the cluster time where the gyroscope angle error (sigma * tau) meets the accelerometer angle noise,
+    averaged over the roll and pitch axis, interpolated in a log-log scale
+    """
+    nb_points = min(len(curve) for curve in curves[0:2] + curves[3:5])
+    if nb_points < 2:
+        return None
+
+    def difference(index):
+        gyroscope = sum(curves[axis][index][1] for axis in (0, 1)) * 0.5 * curves[0][index][0]
+        accelerometer = sum(curves[axis][index][1] for axis in (3, 4)) * 0.5 / GRAVITY_MG
+        return math.log(gyroscope / accelerometer)
+
+    for index in range(nb_points - 1):
+        first, second = difference(index), difference(index + 1)
+        if first <= 0.0 < second:
+            ratio = -first / (second - first)
+            return math.exp(math.log(curves[0][index][0]) * (1.0 - ratio) + math.log(curves[0][index + 1][0]) * ratio)
+    return None
+
+
+def print_terms(axis, term):
+    """Print the noise terms of an axis in the units of the datasheets"""
+    walk = term["random_walk"]
+    if axis < 3:
+        print(f"{AXIS_NAMES[axis]:<16} : ARW {math.degrees(term['white']) * 60.0:8.4f} deg/sqrt(h), "
+              f"bias instability {math.degrees(term['bias']) * 3600.0:8.3f} deg/h (at {term['bias_tau']:g}s)"
+              + (f", RRW {math.degrees(walk) * 3600.0 * 60.0:8.3f} deg/h/sqrt(h)" if walk else ""))
+    else:
+        print(f"{AXIS_NAMES[axis]:<16} : VRW {term['white']:8.4f} mG/sqrt(Hz),    "
+              f"bias instability {term['bias']:8.4f} mG    (at {term['bias_tau']:g}s)"
+              + (f", RRW {walk:8.4f} mG*sqrt(Hz)" if walk else ""))
+
+
+def write_profile(path, source, nb_records, odr_hz, terms, time_constant):
+    """Write the sensor profile header used by LSM6DSO.c"""
+    gyroscope = [terms[axis] for axis in range(3)]
+    accelerometer = [terms[axis] for axis in range(3, NB_AXIS)]
+    alpha = (1.0 / odr_hz) / (time_constant + (1.0 / odr_hz))
+
+    def worst(axis_terms, key):
+        return max(term[key] for term in axis_terms)
+
+    definitions = (
+        ("PROFILE_GYR_WHITE_NOISE_RADPS_RTHZ", worst(gyroscope, "white"),
+         "Gyroscope white noise (ARW) in [rad/s/sqrt(Hz)]"),
+        ("PROFILE_GYR_BIAS_INSTABILITY_RADPS", worst(gyroscope, "bias"), "Gyroscope bias instability in [rad/s]"),
+        ("PROFILE_AXL_WHITE_NOISE_MG_RTHZ", worst(accelerometer, "white"),
+         "Accelerometer white noise (VRW) in [mG/sqrt(Hz)]"),
+        ("PROFILE_AXL_BIAS_INSTABILITY_MG", worst(accelerometer, "bias"), "Accelerometer bias instability in [mG]"),
+        ("PROFILE_FILTER_TIME_CONSTANT_S", time_constant, "Complementary filter time constant in [s]"),
+        ("PROFILE_FILTER_ALPHA", alpha, "Accelerometer proportion in the complementary filter"),
+    )
+
+    width = max(len(name) for name, _, _ in definitions)
+    with open(path, "w", encoding="utf-8", newline="\n") as header:
+        header.write("#ifndef LSM6DSO_PROFILE_H_INCLUDED\n#define LSM6DSO_PROFILE_H_INCLUDED\n\n")
+        header.write(f"//generated by tools/allan.py from {source} ({nb_records} samples at {odr_hz:g}Hz, "
+                     f"{nb_records / odr_hz / 3600.0:.2f}h)\n")
+        for name, value, comment in definitions:
+            header.write(f"#define {name:<{width}} {value:.6e}F  ///< {comment}\n")
+        header.write("\n#endif\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("trace", help="static raw trace ('-' for stdin)")
+    parser.add_argument("--binary", action="store_true", help="trace made of 6 little-endian int16 per record")
+    parser.add_argument("--odr", type=float, default=416.0, help="output data rate of the trace in Hz (416)")
+    parser.add_argument("-o", "--output", help="sensor profile header to generate")
+    parser.add_argument("--csv", help="file in which write the Allan deviation curves")
+    arguments = parser.parse_args()
+
+    nb_records, curves = compute_curves(arguments.trace, arguments.binary, arguments.odr)
+    terms = [noise_terms(curve) for curve in curves]
+    if None in terms:
+        sys.exit(f"{arguments.trace} : {nb_records} records, trace too short")
+
+    print(f"{nb_records} records at {arguments.odr:g}Hz ({nb_records / arguments.odr / 3600.0:.2f}h)")
+    for axis, term in enumerate(terms):
+        print_terms(axis, term)
+
+    if arguments.csv:
+        with open(arguments.csv, "w", encoding="utf-8") as output:
+            output.write("tau_s," + ",".join(name.replace(" ", "_") for name in AXIS_NAMES) + "\n")
+            for index in range(min(len(curve) for curve in curves)):
+                values = ",".join(f"{curve[index][1]:.6e}" for curve in curves)
+                output.write(f"{curves[0][index][0]:g},{values}\n")
+
+    time_constant = filter_time_constant(curves)
+    if time_constant is None:
+        sys.exit("gyroscope and accelerometer angle errors do not cross, profile not generated (trace too short ?)")
+    print(f"complementary filter time constant : {time_constant:.3f}s "
+          f"(alpha = {(1.0 / arguments.odr) / (time_constant + (1.0 / arguments.odr)):.5f})")
+
+    if arguments.output:
+        write_profile(arguments.output, arguments.trace, nb_records, arguments.odr, terms, time_constant)
+
+
+if __name__ == "__main__":
+    main()
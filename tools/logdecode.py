@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Decode the deferred log messages sent by Leany through the ITM stimulus port 0 (SWO pin).
+
+The format strings are read from the .logstrings section of the ELF file, the ID of a message
+being the address of its format string in that section (see Components/sysutils/logger.c).
+
+Usage :
+    logdecode.py build/Debug/Leany.elf capture.bin          (SWO capture, ITM packets)
+    logdecode.py --raw build/Debug/Leany.elf capture.bin    (stimulus port 0 words only)
+    logdecode.py build/Debug/Leany.elf -                    (capture read from stdin)
+"""
+import argparse
+import re
+import struct
+import sys
+
+HEADER_MAGIC = 0xA5
+ITM_PORT = 0
+FORMAT_SPEC = re.compile(r"%(%|[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z|j|t)?([diuoxXc]))")
+
+
+def read_format_strings(elf_path):
+    """Get the format strings of the .logstrings section, indexed by their address"""
+    with open(elf_path, "rb") as elf_file:
+        elf = elf_file.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit(f"{elf_path} : not a 32-bits little-endian ELF file")
+
+    section_offset, = struct.unpack_from("<I", elf, 0x20)
+    entry_size, nb_sections, names_index = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        return struct.unpack_from("<IIIIII", elf, section_offset + (index * entry_size))
+
+    names_offset = section(names_index)[4]
+    for index in range(nb_sections):
+        name, _, _, address, offset, size = section(index)
+        name = elf[names_offset + name:elf.index(b"\0", names_offset + name)].decode()
+        if name != ".logstrings":
+            continue
+
+        strings = {}
+        data = elf[offset:offset + size]
+        position = 0
+        while position < len(data):
+            end = data.index(b"\0", position)
+            if end > position:
+                strings[(address + position) & 0xFFFF] = data[position:end].decode(errors="replace")
+            position = end + 1
+        return strings
+
+    sys.exit(f"{elf_path} : no .logstrings section (firmware built without LEANY_LOGGER ?)")
+
+
+def itm_port_bytes(capture):
+    """Extract the payload of the software packets sent on the stimulus port from an ITM stream"""
+    sizes = {1: 1, 2: 2, 3: 4}
+    position = 0
+    while position < len(capture):
+        header = capture[position]
+        position += 1
+
+        #synchronisation packet bytes
+        if header in (0x00, 0x80):
+            continue
+
+        #protocol packets (timestamps, overflow, extension) : skip the continuation bytes
+        if not header & 0x03:
+            while (header & 0x80) and position < len(capture):
+                header = capture[position]
+                position += 1
+            continue
+
+        #source packets : keep the software ones sent on the port used
+        size = sizes[header & 0x03]
+        if not header & 0x04 and (header >> 3) == ITM_PORT:
+            yield from capture[position:position + size]
+        position += size
+
+
+def format_message(format_string, arguments):
+    """Format a message as printf would, the arguments being raw 32-bits words"""
+    iterator = iter(arguments)
+
+    def replace(match):
+        if match.group(1) == "%":
+            return "%"
+        value = next(iterator, 0)
+        conversion = match.group(2)
+        if conversion in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+        elif conversion == "c":
+            return chr(value & 0xFF)
+        specification = re.sub(r"(hh|h|ll|l|z|j|t)", "", match.group(0))
+        return specification.replace("i", "d").replace("u", "d") % value
+
+    return FORMAT_SPEC.sub(replace, format_string)
+
+
+def decode(words, strings):
+    """Decode the messages from the stimulus port words, resynchronising on the headers"""
+    index = 0
+    while index + 1 < len(words):
+        header = words[index]
+        format_id = (header >> 8) & 0xFFFF
+        nb_arguments = (header >> 4) & 0x0F
+        dropped = header & 0x0F
+        if (header >> 24) != HEADER_MAGIC or format_id not in strings or index + 2 + nb_arguments > len(words):
+            index += 1
+            continue
+
+        timestamp_ms = words[index + 1]
+        arguments = words[index + 2:index + 2 + nb_arguments]
+        if dropped:
+            print(f"{'':>12}   ... {dropped}{'+' if dropped == 0x0F else ''} message(s) dropped")
+        print(f"[{timestamp_ms / 1000:10.3f}] {format_message(strings[format_id], arguments)}")
+        index += 2 + nb_arguments
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware ELF file (built with LEANY_LOGGER)")
+    parser.add_argument("capture", help="SWO capture file ('-' for stdin)")
+    parser.add_argument("--raw", action="store_true", help="capture holds the stimulus port words only")
+    arguments = parser.parse_args()
+
+    strings = read_format_strings(arguments.elf)
+    capture = sys.stdin.buffer.read() if arguments.capture == "-" else open(arguments.capture, "rb").read()
+    payload = capture if arguments.raw else bytes(itm_port_bytes(capture))
+    words = list(struct.unpack_from(f"<{len(payload) // 4}I", payload))
+    decode(words, strings)
+
+
+if __name__ == "__main__":
+    main()